@@ -0,0 +1,84 @@
+/* OsmoSMLC precompiled cell location database */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <osmocom/gsm/gsm0808_utils.h>
+
+/* A cell database file is a struct cell_db_header, followed by n_records struct cell_db_record sorted by LAC and CI,
+ * followed by n_records uint32_t indexes into the records, sorted by CI. The file is mapped to memory and searched in
+ * place, so it is written in host byte order. */
+
+#define CELL_DB_MAGIC "OsmoCDB"
+#define CELL_DB_VERSION 2
+#define CELL_DB_BYTE_ORDER 0x01020304
+
+struct cell_db_header {
+	char magic[8];
+	uint32_t version;
+	/* CELL_DB_BYTE_ORDER as written on the compiling host, to reject files of the wrong byte order */
+	uint32_t byte_order;
+	uint32_t n_records;
+	/* Offsets from the start of the file */
+	uint32_t records_ofs;
+	uint32_t ci_index_ofs;
+};
+
+struct cell_db_record {
+	uint16_t lac;
+	uint16_t ci;
+	uint16_t mcc;
+	uint16_t mnc;
+	uint8_t mnc_3_digits;
+	/* CELL_IDENT_WHOLE_GLOBAL or CELL_IDENT_LAC_AND_CI */
+	uint8_t id_discr;
+	uint16_t spare;
+	/* Line number in the source file. Among several partial matches, the one listed first wins. */
+	uint32_t seq;
+	/*! latitude in micro degrees (degrees * 1e6) */
+	int32_t lat;
+	/*! longitude in micro degrees (degrees * 1e6) */
+	int32_t lon;
+	/*! radius of the cell's coverage in meters; 0 if not given */
+	uint32_t radius;
+};
+
+struct cell_db {
+	char *path;
+
+	void *map;
+	size_t map_len;
+
+	const struct cell_db_header *hdr;
+	const struct cell_db_record *records;
+	const uint32_t *ci_index;
+	uint32_t n_records;
+};
+
+int cell_db_open(void *ctx, struct cell_db **db_p, const char *path);
+const struct cell_db_record *cell_db_find(const struct cell_db *db, const struct gsm0808_cell_id *cell_id);
+void cell_db_record_to_cell_id(struct gsm0808_cell_id *cell_id, const struct cell_db_record *rec);
+
+int cell_db_write(const char *path, struct cell_db_record *records, uint32_t n_records, uint32_t *n_written);
@@ -27,12 +27,32 @@
 
 #include <stdint.h>
 #include <osmocom/core/linuxlist.h>
+#include <osmocom/gsm/gsm0808_utils.h>
 #include <osmocom/sigtran/sccp_sap.h>
 
 struct osmo_gad;
 
+/* Lookup indexes kept by struct cell_locations. The exact index finds a cell by its full cell identifier, the others
+ * serve the fuzzy matching of partial cell identifiers, see cell_locations_find(). */
+enum cell_location_idx {
+	CELL_LOCATION_IDX_EXACT,
+	CELL_LOCATION_IDX_LAC_CI,
+	CELL_LOCATION_IDX_LAC,
+	CELL_LOCATION_IDX_CI,
+	_NUM_CELL_LOCATION_IDX
+};
+
 struct cell_location {
 	struct llist_head entry;
+	/* entry in cell_locations->partial, if the cell_id lacks a LAC or CI */
+	struct llist_head partial_entry;
+	struct hlist_node hnode[_NUM_CELL_LOCATION_IDX];
+
+	/* Order of insertion, to pick the same entry among several fuzzy matches that a list walk would pick */
+	uint32_t seq;
+	/* enum cgi_part flags and values of the parts present in cell_id, used for the index keys */
+	uint8_t parts;
+	struct osmo_cell_global_id cgi;
 
 	struct gsm0808_cell_id cell_id;
 
@@ -40,10 +60,33 @@ struct cell_location {
 	int32_t lat;
 	/*! longitude in micro degrees (degrees * 1e6) */
 	int32_t lon;
+	/*! radius of the cell's coverage in meters, for Location Estimates without a TA; 0 if not configured */
+	uint32_t radius;
+};
+
+struct cell_location_hash {
+	struct hlist_head *buckets;
+	unsigned int bits;
 };
 
-int cell_location_from_ta(struct osmo_gad *location_estimate,
-			  const struct gsm0808_cell_id *cell_id,
-			  uint8_t ta);
+/* A set of cell locations, in order of configuration and indexed for fast lookup. */
+struct cell_locations {
+	struct llist_head list;
+	unsigned int count;
+	uint32_t next_seq;
+
+	struct cell_location_hash idx[_NUM_CELL_LOCATION_IDX];
+	/* Cells that are not in all of the LAC and CI indexes; these are candidates for every fuzzy lookup. */
+	struct llist_head partial;
+};
+
+struct cell_locations *cell_locations_alloc(void *ctx);
+struct cell_location *cell_locations_find(const struct cell_locations *cl, const struct gsm0808_cell_id *cell_id);
+struct cell_location *cell_locations_add(struct cell_locations *cl, const struct gsm0808_cell_id *cell_id);
+void cell_locations_del(struct cell_locations *cl, struct cell_location *cell_location);
+
+void cell_location_estimate_from_ta(struct osmo_gad *location_estimate, int32_t lat, int32_t lon, uint8_t ta);
+void cell_location_estimate_from_radius(struct osmo_gad *location_estimate, int32_t lat, int32_t lon,
+					uint32_t radius);
 
 int cell_locations_vty_init();
@@ -0,0 +1,90 @@
+/* OsmoSMLC generations of the cell location table */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <osmocom/core/use_count.h>
+#include <osmocom/gsm/gad.h>
+
+struct cell_locations;
+struct cell_db;
+struct gsm0808_cell_id;
+
+#define CELL_TABLE_USE_CURRENT "current"
+#define CELL_TABLE_USE_SMLC_LOC_REQ "smlc_loc_req"
+
+/* Number of cells copied to a new cell_table per main loop iteration */
+#define CELL_TABLE_BUILD_CHUNK 1000
+
+/* Size of the Location Estimate cache of each cell_table. It is direct-mapped: each cell and TA has one slot, and a
+ * new estimate replaces the one in its slot. */
+#define CELL_TABLE_ESTIMATES_BITS 14
+#define CELL_TABLE_ESTIMATES_SIZE (1 << CELL_TABLE_ESTIMATES_BITS)
+
+/* A Location Estimate for one cell and TA, ready to be copied to a Perform Location Response */
+struct cell_table_estimate {
+	/* Cell index and TA, see cell_table_estimate_key() */
+	uint64_t key;
+	/* Encoded length, 0 for an unused slot */
+	struct osmo_gad_ell_point_unc_circle location;
+	uint8_t len;
+	uint8_t raw[sizeof(struct gad_raw_ell_point_unc_circle)];
+};
+
+/* An immutable snapshot of the configured cell locations and the cell database file. The VTY modifies only
+ * g_smlc->cell_locations; each modification starts building a new cell_table in the background, which replaces
+ * g_smlc->cell_table when complete. Location requests keep a use count on the cell_table they started with, so that
+ * it stays intact until they are done. */
+struct cell_table {
+	uint32_t gen;
+	struct osmo_use_count use_count;
+
+	struct cell_locations *cells;
+	/* NULL if no database file is configured */
+	struct cell_db *db;
+
+	/* Encoded Location Estimates by cell and TA, filled on demand; CELL_TABLE_ESTIMATES_SIZE slots, allocated with
+	 * the first estimate. Since a cell_table never changes, a new generation starts with an empty cache, which takes
+	 * care of invalidating estimates of modified cells. */
+	struct cell_table_estimate *estimates;
+};
+
+#define cell_table_get(cell_table, use) \
+	OSMO_ASSERT(osmo_use_count_get_put(&(cell_table)->use_count, use, 1) == 0)
+#define cell_table_put(cell_table, use) \
+	OSMO_ASSERT(osmo_use_count_get_put(&(cell_table)->use_count, use, -1) == 0)
+
+void cell_table_rebuild(void);
+int cell_table_rebuild_sync(void);
+bool cell_table_rebuild_pending(void);
+
+int cell_table_find(const struct cell_table *cell_table, const struct gsm0808_cell_id *cell_id,
+		    uint32_t *cell_idx, int32_t *lat, int32_t *lon, uint32_t *radius);
+bool cell_table_estimate_cached(struct cell_table *cell_table, uint32_t cell_idx, uint8_t ta,
+				union gad_raw *location_estimate, struct osmo_gad *location);
+void cell_table_estimate_add(struct cell_table *cell_table, uint32_t cell_idx, uint8_t ta,
+			     const union gad_raw *location_estimate, unsigned int len, const struct osmo_gad *location);
+int cell_table_location_estimate(struct cell_table *cell_table, union gad_raw *location_estimate,
+				 struct osmo_gad *location, const struct gsm0808_cell_id *cell_id, uint8_t ta);
@@ -0,0 +1,49 @@
+/* OsmoSMLC SCCP connection ID allocation */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* SCCP connection IDs are 24 bit wide. ID 0 is never handed out. */
+#define CONN_IDS_BITS 24
+#define CONN_IDS_MAX ((1 << CONN_IDS_BITS) - 1)
+
+/* Levels of bitmaps: level 0 has one bit per conn_id, set when in use. Each bit of the next level is set when the
+ * corresponding 64 bit word of the level below is full. The top level is a single word. */
+#define CONN_IDS_LEVELS 4
+
+/* Set of SCCP connection IDs in use, to pick an unused one in constant time. */
+struct conn_ids {
+	uint64_t *used[CONN_IDS_LEVELS];
+	/* Start looking for an unused ID here, so that released IDs are not reused right away */
+	uint32_t next;
+	uint32_t count;
+};
+
+struct conn_ids *conn_ids_alloc(void *ctx);
+int conn_ids_next(struct conn_ids *ids);
+int conn_ids_claim(struct conn_ids *ids, uint32_t conn_id);
+void conn_ids_release(struct conn_ids *ids, uint32_t conn_id);
+bool conn_ids_in_use(const struct conn_ids *ids, uint32_t conn_id);
@@ -2,11 +2,16 @@
 /* SMLC Lb connection implementation */
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
 
 #include <osmocom/core/linuxlist.h>
 #include <osmocom/smlc/smlc_subscr.h>
+#include <osmocom/smlc/smlc_pool.h>
+#include <osmocom/smlc/lb_msgb.h>
 
 struct lb_peer;
+struct sccp_lb_inst;
 struct osmo_fsm_inst;
 struct msgb;
 struct bssmap_le_pdu;
@@ -25,8 +30,19 @@ struct bssmap_le_pdu;
 
 #define SMLC_SUBSCR_USE_LB_CONN "Lb-conn"
 
+/* TA and cell identity from the latest BSSLAP Reset, i.e. after an intra-BSS handover */
+struct lb_conn_handover_ta {
+	bool valid;
+	struct timespec time;
+	uint8_t ta;
+	uint16_t ci;
+};
+
 struct lb_conn {
+	/* entry in lb_peer->lb_conns */
 	struct llist_head entry;
+	/* entry in sccp_lb_inst->lb_conns_by_conn_id */
+	struct hlist_node hnode;
 	struct osmo_use_count use_count;
 
 	struct lb_peer *lb_peer;
@@ -36,8 +52,19 @@ struct lb_conn {
 
 	struct smlc_subscr *smlc_subscr;
 	struct smlc_loc_req *smlc_loc_req;
+	/* Perform Location Requests received while smlc_loc_req is pending, oldest first, see struct
+	 * smlc_loc_req_queued */
+	struct llist_head loc_req_queue;
+	unsigned int loc_req_queue_len;
+	/* Answer later requests from this while it is fresh, see g_smlc->handover_ta_max_age */
+	struct lb_conn_handover_ta handover_ta;
+
+	/* Chunk of g_smlc->lb_conn_pool this lb_conn is allocated in, or NULL */
+	void *pool_chunk;
 };
 
+#define LB_CONN_POOL_CHUNK_SIZE (sizeof(struct lb_conn) + SMLC_POOL_TALLOC_OVERHEAD)
+
 #define lb_conn_get(lb_conn, use) \
 	OSMO_ASSERT(osmo_use_count_get_put(&(lb_conn)->use_count, use, 1) == 0)
 #define lb_conn_put(lb_conn, use) \
@@ -46,6 +73,7 @@ struct lb_conn {
 struct lb_conn *lb_conn_create_incoming(struct lb_peer *lb_peer, uint32_t sccp_conn_id, const char *use_token);
 struct lb_conn *lb_conn_create_outgoing(struct lb_peer *lb_peer, const char *use_token);
 struct lb_conn *lb_conn_find_by_smlc_subscr(struct smlc_subscr *smlc_subscr, const char *use_token);
+struct lb_conn *lb_conn_find_by_sccp_conn_id(struct sccp_lb_inst *sli, uint32_t sccp_conn_id);
 
 void lb_conn_msc_role_gone(struct lb_conn *lb_conn, struct osmo_fsm_inst *msc_role);
 void lb_conn_close(struct lb_conn *lb_conn);
@@ -53,3 +81,4 @@ void lb_conn_discard(struct lb_conn *lb_conn);
 
 int lb_conn_rx(struct lb_conn *lb_conn, struct msgb *msg, bool initial);
 int lb_conn_send_bssmap_le(struct lb_conn *lb_conn, const struct bssmap_le_pdu *bssmap_le);
+int lb_conn_send_tmpl(struct lb_conn *lb_conn, enum lb_msgb_tmpl tmpl);
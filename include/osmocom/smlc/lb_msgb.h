@@ -0,0 +1,64 @@
+/* OsmoSMLC msgb allocation for the Lb interface, and pre-encoded constant messages */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <osmocom/core/msgb.h>
+#include <osmocom/core/utils.h>
+#include <osmocom/sigtran/sccp_sap.h>
+
+#include <osmocom/smlc/smlc_pool.h>
+
+struct bssmap_le_perform_loc_resp;
+
+/* Room in front of a BSSAP-LE message for the osmo_scu_prim that sccp_lb_down_l2_*() push, plus alignment */
+#define LB_MSGB_HEADROOM (sizeof(struct osmo_scu_prim) + 8)
+
+/* BSSAP-LE messages that never change */
+enum lb_msgb_tmpl {
+	LB_MSGB_TMPL_TA_REQUEST,
+	LB_MSGB_TMPL_RESET,
+	LB_MSGB_TMPL_RESET_ACK,
+	_NUM_LB_MSGB_TMPL
+};
+
+extern const struct value_string lb_msgb_tmpl_names[];
+
+/* Longest encoding of any template */
+#define LB_MSGB_TMPL_MAX_LEN 32
+
+/* Longest BSSAP-LE message placed in a pool chunk, longer ones are allocated without the pool */
+#define LB_MSGB_POOL_MAX_LEN 256
+
+/* Messages are freed right after sending, so few are in use at the same time */
+#define LB_MSGB_POOL_DEFAULT_SIZE 8
+#define LB_MSGB_POOL_DEFAULT_HIGH_WATER_MARK 64
+
+#define LB_MSGB_POOL_CHUNK_SIZE \
+	(sizeof(struct msgb) + LB_MSGB_HEADROOM + 8 + LB_MSGB_POOL_MAX_LEN + SMLC_POOL_TALLOC_OVERHEAD)
+
+struct msgb *lb_msgb_alloc(struct smlc_pool *pool, uint16_t len, const char *name);
+void lb_msgb_free(struct smlc_pool *pool, struct msgb *msg);
+struct msgb *lb_msgb_tmpl(struct smlc_pool *pool, enum lb_msgb_tmpl tmpl);
+struct msgb *lb_msgb_perform_loc_resp(struct smlc_pool *pool, const struct bssmap_le_perform_loc_resp *resp);
@@ -6,10 +6,15 @@
 
 #include <osmocom/smlc/debug.h>
 #include <osmocom/smlc/lb_conn.h>
+#include <osmocom/smlc/smlc_latency.h>
+#include <osmocom/smlc/ta_rtt.h>
+#include <osmocom/smlc/token_bucket.h>
 
 struct vlr_subscr;
 struct lb_conn;
 struct neighbor_ident_entry;
+struct osmo_stat_item_group;
+struct rate_ctr_group;
 
 #define LOG_LB_PEER_CAT(LB_PEER, subsys, loglevel, fmt, args ...) \
 	LOGPFSMSL((LB_PEER)? (LB_PEER)->fi : NULL, subsys, loglevel, fmt, ## args)
@@ -23,15 +28,33 @@ struct lb_peer {
 
 	struct sccp_lb_inst *sli;
 	struct osmo_sccp_addr peer_addr;
+
+	/* All lb_conns with this lb_peer, so that a RESET only needs to visit the conns of this peer */
+	struct llist_head lb_conns;
+
+	/* Location request latencies for this peer, and the latest ones as stat items */
+	struct smlc_latency latency;
+	struct osmo_stat_item_group *statg;
+
+	/* BSSLAP TA round trips with this peer, for the adaptive TA Response timeout */
+	struct ta_rtt ta_rtt;
+
+	/* Rate limits of new connections and of location requests from this peer, see g_smlc->rate_limit_* */
+	struct token_bucket conn_bucket;
+	struct token_bucket loc_req_bucket;
+	struct rate_ctr_group *ctrs;
+};
+
+enum lb_peer_ctr {
+	LB_PEER_CTR_RATE_LIMIT_CONN_REFUSED,
+	LB_PEER_CTR_RATE_LIMIT_LOC_REQ_REJECTED,
 };
 
 #define lb_peer_for_each_lb_conn(LB_CONN, LB_PEER) \
-	llist_for_each_entry(LB_CONN, &(LB_PEER)->sli->lb_conns, entry) \
-		if ((LB_CONN)->lb_peer == (LB_PEER))
+	llist_for_each_entry(LB_CONN, &(LB_PEER)->lb_conns, entry)
 
 #define lb_peer_for_each_lb_conn_safe(LB_CONN, LB_CONN_NEXT, LB_PEER) \
-	llist_for_each_entry_safe(LB_CONN, LB_CONN_NEXT, &(LB_PEER)->sli->lb_conns, entry) \
-		if ((LB_CONN)->lb_peer == (LB_PEER))
+	llist_for_each_entry_safe(LB_CONN, LB_CONN_NEXT, &(LB_PEER)->lb_conns, entry)
 
 enum lb_peer_state {
 	LB_PEER_ST_WAIT_RX_RESET = 0,
@@ -65,3 +88,7 @@ struct lb_peer *lb_peer_find(struct sccp_lb_inst *sli, const struct osmo_sccp_ad
 int lb_peer_up_l2(struct sccp_lb_inst *sli, const struct osmo_sccp_addr *calling_addr, bool co, uint32_t conn_id,
 		  struct msgb *l2);
 void lb_peer_disconnect(struct sccp_lb_inst *sli, uint32_t conn_id);
+
+unsigned long lb_peer_ta_timeout_ms(const struct lb_peer *lbp);
+bool lb_peer_admit_conn(struct lb_peer *lbp);
+bool lb_peer_admit_loc_req(struct lb_peer *lbp);
@@ -5,12 +5,14 @@
 #include <stdint.h>
 
 #include <osmocom/core/tdef.h>
+#include <osmocom/core/hashtable.h>
 #include <osmocom/gsm/gsm_utils.h>
 #include <osmocom/gsm/gsm0808_utils.h>
 #include <osmocom/sigtran/sccp_sap.h>
 
 struct msgb;
 struct sccp_lb_inst;
+struct conn_ids;
 
 #define LOG_SCCP_LB_CO(sli, peer_addr, conn_id, level, fmt, args...) \
 	LOGP(DLB, level, "(Lb-%u%s%s) " fmt, \
@@ -39,20 +41,26 @@ enum reset_msg_type {
 	SCCP_LB_MSG_RESET_ACK,
 };
 
+/* Size of sccp_lb_inst->lb_conns_by_conn_id */
+#define SCCP_LB_CONN_ID_HASH_BITS 16
+
 struct sccp_lb_inst {
 	struct osmo_sccp_instance *sccp;
 	struct osmo_sccp_user *scu;
 	struct osmo_sccp_addr local_sccp_addr;
 
 	struct llist_head lb_peers;
-	struct llist_head lb_conns;
+	/* All lb_conns of all lb_peers by sccp_conn_id, to dispatch incoming connection-oriented messages */
+	DECLARE_HASHTABLE(lb_conns_by_conn_id, SCCP_LB_CONN_ID_HASH_BITS);
+	/* sccp_conn_ids of all lb_conns */
+	struct conn_ids *conn_ids;
 
 	void *user_data;
 };
 
 struct sccp_lb_inst *sccp_lb_init(void *talloc_ctx, struct osmo_sccp_instance *sccp, enum osmo_sccp_ssn ssn,
 				  const char *sccp_user_name);
-int sccp_lb_inst_next_conn_id();
+int sccp_lb_inst_next_conn_id(struct sccp_lb_inst *sli);
 
 int sccp_lb_down_l2_co_initial(struct sccp_lb_inst *sli,
 			       const struct osmo_sccp_addr *called_addr,
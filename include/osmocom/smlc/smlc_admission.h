@@ -0,0 +1,108 @@
+/* OsmoSMLC prioritized admission of location requests */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <osmocom/core/linuxlist.h>
+#include <osmocom/core/timer.h>
+#include <osmocom/core/utils.h>
+
+struct vty;
+struct smlc_admission_entry;
+
+/* Priority of a location request, highest first */
+enum smlc_loc_req_prio {
+	/* LCS Client Type of emergency services */
+	SMLC_LOC_REQ_PRIO_EMERGENCY,
+	/* LCS Priority "highest", or LCS Client Type of lawful intercept */
+	SMLC_LOC_REQ_PRIO_HIGH,
+	SMLC_LOC_REQ_PRIO_NORMAL,
+	_NUM_SMLC_LOC_REQ_PRIO
+};
+
+extern const struct value_string smlc_loc_req_prio_names[];
+
+enum smlc_admission_result {
+	/* Start the request now */
+	SMLC_ADMISSION_START,
+	/* The request waits in the queue; start_cb is called when it may start */
+	SMLC_ADMISSION_QUEUED,
+	/* The queue is too long for the request's priority, reject it */
+	SMLC_ADMISSION_REJECTED,
+};
+
+enum smlc_admission_entry_state {
+	SMLC_ADMISSION_ENTRY_IDLE,
+	SMLC_ADMISSION_ENTRY_QUEUED,
+	SMLC_ADMISSION_ENTRY_ACTIVE,
+};
+
+/* Part of each request that goes through admission */
+struct smlc_admission_entry {
+	/* entry in smlc_admission->queue[prio] */
+	struct llist_head entry;
+	enum smlc_loc_req_prio prio;
+	enum smlc_admission_entry_state state;
+};
+
+typedef void (*smlc_admission_start_cb_t)(struct smlc_admission_entry *e);
+
+struct smlc_admission_prio_stats {
+	/* Requests started right away, started from the queue, and rejected */
+	uint64_t started;
+	uint64_t dequeued;
+	uint64_t rejected;
+};
+
+/* Limits the number of concurrently active location requests. Requests beyond that wait in one FIFO queue per
+ * priority; whenever an active request ends, the oldest request of the highest priority starts. Requests of other
+ * than emergency priority are rejected when the queues hold too many requests already. */
+struct smlc_admission {
+	/* Max number of active requests, 0 for no limit */
+	unsigned int max_active;
+	/* Reject a request when at least this many requests are queued, indexed by its priority. Emergency requests are
+	 * never rejected. */
+	unsigned int max_backlog[_NUM_SMLC_LOC_REQ_PRIO];
+
+	unsigned int active;
+	struct llist_head queue[_NUM_SMLC_LOC_REQ_PRIO];
+	unsigned int queued[_NUM_SMLC_LOC_REQ_PRIO];
+	unsigned int queued_total;
+
+	struct smlc_admission_prio_stats stats[_NUM_SMLC_LOC_REQ_PRIO];
+
+	/* Start queued requests from the main loop, not from within the end of another request */
+	struct osmo_timer_list drain_timer;
+	smlc_admission_start_cb_t start_cb;
+};
+
+#define SMLC_ADMISSION_DEFAULT_MAX_BACKLOG_HIGH 10000
+#define SMLC_ADMISSION_DEFAULT_MAX_BACKLOG_NORMAL 1000
+
+struct smlc_admission *smlc_admission_alloc(void *ctx, smlc_admission_start_cb_t start_cb);
+enum smlc_admission_result smlc_admission_request(struct smlc_admission *adm, struct smlc_admission_entry *e,
+						  enum smlc_loc_req_prio prio);
+void smlc_admission_release(struct smlc_admission *adm, struct smlc_admission_entry *e);
+void smlc_admission_kick(struct smlc_admission *adm);
+void smlc_admission_vty_show(struct vty *vty, const struct smlc_admission *adm);
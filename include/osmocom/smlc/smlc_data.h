@@ -1,6 +1,7 @@
 #pragma once
 
 #include <osmocom/core/linuxlist.h>
+#include <osmocom/core/hashtable.h>
 #include <osmocom/core/logging.h>
 #include <osmocom/core/rate_ctr.h>
 #include <osmocom/core/stat_item.h>
@@ -8,8 +9,46 @@
 
 #include <osmocom/ctrl/control_if.h>
 
+#include <osmocom/smlc/smlc_latency.h>
+#include <osmocom/smlc/token_bucket.h>
+
 struct osmo_sccp_instance;
 struct sccp_lb_inst;
+struct cell_locations;
+struct cell_table;
+struct smlc_pool;
+struct timer_wheel;
+struct smlc_overload;
+struct smlc_workers;
+
+/* Size of g_smlc->subscribers_by_imsi */
+#define SMLC_SUBSCR_HASH_BITS 16
+
+#define SMLC_LAST_LOCATION_DEFAULT_CAPACITY 10000
+
+/* When to answer a Perform Location Request from the cell identity alone, without a BSSLAP TA round trip */
+enum smlc_cell_id_only {
+	SMLC_CELL_ID_ONLY_DISABLED,
+	/* If the LCS QoS asks for a low delay response and the cell's radius satisfies the requested accuracy */
+	SMLC_CELL_ID_ONLY_LOW_DELAY,
+};
+
+/* How long to wait for a BSSLAP TA Response */
+enum smlc_ta_timeout {
+	/* T-12, for all Lb peers */
+	SMLC_TA_TIMEOUT_FIXED,
+	/* Per Lb peer, from its measured TA round trips, see struct ta_rtt */
+	SMLC_TA_TIMEOUT_ADAPTIVE,
+};
+
+#define SMLC_TA_TIMEOUT_DEFAULT_MIN_MS 500
+#define SMLC_TA_TIMEOUT_DEFAULT_MAX_MS 5000
+
+#define SMLC_RATE_LIMIT_DEFAULT_BURST 100
+
+#define SMLC_LOC_REQ_PIPELINE_DEFAULT_DEPTH 4
+
+#define SMLC_POSITIONING_DEFAULT_DEADLINE_MS 1000
 
 struct smlc_state {
 	struct osmo_sccp_instance *sccp_inst;
@@ -18,10 +57,66 @@ struct smlc_state {
 	struct ctrl_handle *ctrl;
 
 	struct rate_ctr_group *ctrs;
+	/* Latest location request latencies, indexed by enum smlc_latency_stage */
 	struct osmo_stat_item_group *statg;
+	/* Location request latencies of all Lb peers */
+	struct smlc_latency latency;
+	/* The same, by priority */
+	struct smlc_latency latency_by_prio[_NUM_SMLC_LOC_REQ_PRIO];
 
 	struct llist_head subscribers;
-	struct llist_head cell_locations;
+	DECLARE_HASHTABLE(subscribers_by_imsi, SMLC_SUBSCR_HASH_BITS);
+	/* Subscribers with a last known location, least recently updated first */
+	struct llist_head last_locations;
+	unsigned int last_locations_count;
+	/* Answer location requests from a subscriber's last known location up to this age in seconds, 0 disables */
+	unsigned int last_location_max_age;
+	/* Remember at most this many last known locations */
+	unsigned int last_location_capacity;
+	/* Answer location requests from the TA of a BSSLAP Reset up to this age in seconds, 0 disables */
+	unsigned int handover_ta_max_age;
+	enum smlc_cell_id_only cell_id_only;
+	/* Radius in meters for cells without a configured radius; 0 means to not answer from the cell identity alone for
+	 * those */
+	uint32_t cell_id_only_default_radius;
+	enum smlc_ta_timeout ta_timeout;
+	/* Bounds of the adaptive TA Response timeout */
+	unsigned long ta_timeout_min_ms;
+	unsigned long ta_timeout_max_ms;
+	/* Queue up to this many Perform Location Requests on an lb_conn behind the pending one */
+	unsigned int loc_req_pipeline_depth;
+	/* Rate limits of each Lb peer */
+	struct token_bucket_cfg rate_limit_conn;
+	struct token_bucket_cfg rate_limit_loc_req;
+	/* Cell locations as configured on the VTY, see cell_table for the ones in use */
+	struct cell_locations *cell_locations;
+	/* Precompiled cell locations, consulted for cells not found in cell_locations */
+	char *cell_db_path;
+	struct cell_table *cell_table;
+
+	/* Memory for lb_conn and for smlc_loc_req with its FSM instance */
+	struct smlc_pool *lb_conn_pool;
+	struct smlc_pool *loc_req_pool;
+	struct smlc_pool *lb_msgb_pool;
+
+	/* Timeouts of location requests */
+	struct timer_wheel *timer_wheel;
+
+	/* Limit of concurrent location requests, and the queue of those waiting to start */
+	struct smlc_admission *admission;
+
+	/* Numbers of live objects, for overload protection */
+	unsigned int lb_conns_count;
+	unsigned int loc_reqs_count;
+	unsigned int subscribers_count;
+	/* Shed load when the main loop lags or the above counts grow too large */
+	struct smlc_overload *overload;
+
+	/* Compute location estimates on this many worker threads, 0 to compute on the main thread */
+	unsigned int positioning_threads;
+	struct smlc_workers *pos_workers;
+	/* Give up on a location estimate not computed within this many milliseconds */
+	unsigned long positioning_deadline_ms;
 };
 
 extern struct smlc_state *g_smlc;
@@ -29,8 +124,11 @@ struct smlc_state *smlc_state_alloc(void *ctx);
 
 extern struct osmo_tdef g_smlc_tdefs[];
 
+extern const struct osmo_stat_item_desc smlc_latency_stat_item_desc[_NUM_SMLC_LATENCY];
+
 int smlc_ctrl_node_lookup(void *data, vector vline, int *node_type,
 			  void **node_data, int *i);
+int smlc_ctrl_cmds_install(struct smlc_state *smlc);
 
 enum smlc_ctrl_node {
 	CTRL_NODE_SMLC = _LAST_CTRL_NODE,
@@ -57,4 +155,35 @@ enum {
 	SMLC_CTR_BSSMAP_LE_TX_UDT_RESET_ACK,
 	SMLC_CTR_BSSMAP_LE_TX_DT1_PERFORM_LOCATION_RESPONSE,
 	SMLC_CTR_BSSMAP_LE_TX_DT1_BSSLAP_TA_REQUEST,
+
+	SMLC_CTR_LOCATION_ESTIMATE_CACHE_HIT,
+	SMLC_CTR_LOCATION_ESTIMATE_CACHE_MISS,
+	SMLC_CTR_LOCATION_REQUEST_FAST_PATH,
+	SMLC_CTR_LAST_LOCATION_HIT,
+	SMLC_CTR_LAST_LOCATION_MISS,
+	SMLC_CTR_LAST_LOCATION_EXPIRED,
+	SMLC_CTR_LAST_LOCATION_QOS_MISMATCH,
+	SMLC_CTR_LOCATION_REQUEST_CELL_ID_ONLY,
+	SMLC_CTR_LOCATION_REQUEST_CELL_ID_ONLY_INACCURATE,
+	SMLC_CTR_LOCATION_REQUEST_QUEUED,
+	SMLC_CTR_LOCATION_REQUEST_CONGESTION,
+	SMLC_CTR_LOCATION_REQUEST_PIPELINED,
+	SMLC_CTR_LOCATION_REQUEST_COALESCED,
+	SMLC_CTR_LOCATION_REQUEST_PIPELINE_FULL,
+	SMLC_CTR_HANDOVER_TA_HIT,
+	SMLC_CTR_HANDOVER_TA_EXPIRED,
+	SMLC_CTR_HANDOVER_TA_OTHER_CELL,
+
+	/* Indexed by enum smlc_overload_state */
+	SMLC_CTR_OVERLOAD_ENTER_NONE,
+	SMLC_CTR_OVERLOAD_ENTER_SKIP_DEBUG_LOG,
+	SMLC_CTR_OVERLOAD_ENTER_REJECT_NORMAL,
+	SMLC_CTR_OVERLOAD_ENTER_REFUSE_CONN,
+	SMLC_CTR_OVERLOAD_LOCATION_REQUEST_REJECTED,
+	SMLC_CTR_OVERLOAD_CONNECTION_REFUSED,
+	SMLC_CTR_BSSAP_LE_TX_TEMPLATE,
+	SMLC_CTR_BSSAP_LE_TX_ENCODED,
+	SMLC_CTR_POSITIONING_POOLED,
+	SMLC_CTR_POSITIONING_EXPIRED,
+	SMLC_CTR_LOCATION_REQUEST_QUEUE_TIMEOUT,
 };
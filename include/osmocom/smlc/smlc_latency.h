@@ -0,0 +1,77 @@
+/* OsmoSMLC location request latency histograms */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include <osmocom/core/utils.h>
+#include <osmocom/smlc/smlc_admission.h>
+
+struct vty;
+struct lb_peer;
+
+/* Bucket n of a histogram counts latencies below 2^(n + SMLC_LATENCY_BUCKET_MIN_BITS) microseconds, that are not
+ * counted in bucket n - 1. The last bucket counts all longer latencies. */
+#define SMLC_LATENCY_BUCKET_MIN_BITS 6
+#define SMLC_LATENCY_BUCKETS 20
+
+enum smlc_latency_stage {
+	/* From Rx Perform Location Request to Tx Perform Location Response */
+	SMLC_LATENCY_TOTAL,
+	/* From Tx BSSLAP TA Request to Rx TA Response or BSSLAP Reset, if the TA was requested */
+	SMLC_LATENCY_TA_ROUND_TRIP,
+	/* Total latency without the TA round trip and the admission queue, i.e. time spent working on the request */
+	SMLC_LATENCY_PROCESSING,
+	/* From Rx Perform Location Request to its start or its queue timeout, if it waited in the admission queue */
+	SMLC_LATENCY_QUEUE,
+	_NUM_SMLC_LATENCY
+};
+
+extern const struct value_string smlc_latency_stage_names[];
+
+struct smlc_latency_hist {
+	uint64_t count;
+	uint64_t sum_us;
+	uint64_t max_us;
+	uint64_t buckets[SMLC_LATENCY_BUCKETS];
+};
+
+struct smlc_latency {
+	struct smlc_latency_hist hist[_NUM_SMLC_LATENCY];
+};
+
+/* CLOCK_MONOTONIC times of the stages of one location request. tx_ta_req and rx_ta remain zero when the TA was not
+ * requested from the BSC, dequeued remains zero when the request did not wait in the admission queue. */
+struct smlc_latency_stamps {
+	struct timespec rx_req;
+	struct timespec dequeued;
+	struct timespec tx_ta_req;
+	struct timespec rx_ta;
+};
+
+void smlc_latency_stamp(struct timespec *ts);
+uint64_t smlc_latency_stamp_diff_us(const struct timespec *later, const struct timespec *earlier);
+void smlc_latency_hist_add(struct smlc_latency_hist *hist, uint64_t us);
+void smlc_latency_record(struct lb_peer *lbp, enum smlc_loc_req_prio prio, const struct smlc_latency_stamps *stamps);
+void smlc_latency_vty_show(struct vty *vty, const struct smlc_latency *latency);
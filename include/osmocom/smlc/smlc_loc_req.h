@@ -24,7 +24,12 @@
  */
 #pragma once
 
+#include <osmocom/core/fsm.h>
 #include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/smlc_pool.h>
+#include <osmocom/smlc/timer_wheel.h>
+#include <osmocom/smlc/smlc_latency.h>
+#include <osmocom/smlc/smlc_admission.h>
 #include <osmocom/gsm/bssmap_le.h>
 
 #define LOG_SMLC_LOC_REQ(LOC_REQ, level, fmt, args...) do { \
@@ -35,15 +40,39 @@
 	} while(0)
 
 struct smlc_ta_req;
+struct smlc_pos_job;
+struct cell_table;
 struct lb_conn;
 struct msgb;
 
 #define LB_CONN_USE_SMLC_LOC_REQ "smlc_loc_req"
 
+/* LCS Priority, 3GPP TS 49.031 10.22, coded as LCS-Priority in 3GPP TS 29.002 */
+#define LCS_PRIORITY_HIGHEST 0
+
+/* LCS QoS Response Time, 3GPP TS 49.031 10.16 */
+#define LCS_QOS_RT_LOW_DELAY 1
+#define LCS_QOS_RT_DELAY_TOLERANT 2
+
+/* What the SMLC uses of a Perform Location Request after receiving it. The decoded struct bssmap_le_perform_loc_req
+ * also holds the BSSLAP APDU union and the IMSI and IMEI, and is several times the size. */
+struct smlc_loc_req_params {
+	struct bssmap_le_location_type location_type;
+	struct gsm0808_cell_id cell_id;
+	bool lcs_qos_present;
+	struct osmo_bssmap_le_lcs_qos lcs_qos;
+	enum smlc_loc_req_prio prio;
+	/* From a BSSLAP TA Layer 3 APDU in the request */
+	bool ta_present;
+	uint8_t ta;
+};
+
 enum smlc_loc_req_fsm_event {
 	SMLC_LOC_REQ_EV_RX_TA_RESPONSE,
 	SMLC_LOC_REQ_EV_RX_BSSLAP_RESET,
 	SMLC_LOC_REQ_EV_RX_LE_PERFORM_LOCATION_ABORT,
+	/* A positioning thread is done with smlc_loc_req->pos_job, data is the job */
+	SMLC_LOC_REQ_EV_POS_RESULT,
 };
 
 struct smlc_loc_req {
@@ -52,14 +81,48 @@ struct smlc_loc_req {
 	struct smlc_subscr *smlc_subscr;
 	struct lb_conn *lb_conn;
 
-	struct bssmap_le_perform_loc_req req;
+	struct smlc_loc_req_params params;
+
+	/* The cell locations as they were when the request started */
+	struct cell_table *cell_table;
 
 	bool ta_present;
 	uint8_t ta;
 
 	struct gsm0808_cell_id latest_cell_id;
+	/* The latest_cell_id within cell_table, see cell_table_find() */
+	uint32_t cell_idx;
+	/* While a positioning thread computes the location estimate */
+	struct smlc_pos_job *pos_job;
 
 	struct lcs_cause_ie lcs_cause;
+
+	/* When this request went through its stages, for the latency histograms */
+	struct smlc_latency_stamps stamps;
+
+	/* Place in g_smlc->admission, while waiting to start or active */
+	struct smlc_admission_entry admission;
+
+	/* The state timeout, on g_smlc->timer_wheel instead of the FSM instance's own osmo_timer */
+	struct timer_wheel_timer timeout;
+
+	/* Chunk of g_smlc->loc_req_pool holding the FSM instance and this struct, or NULL */
+	void *pool_chunk;
 };
 
+/* A Perform Location Request received while another one is pending on the same lb_conn. It is answered along with the
+ * pending one from the same TA, or started when the pending one fails. */
+struct smlc_loc_req_queued {
+	/* entry in lb_conn->loc_req_queue */
+	struct llist_head entry;
+	struct smlc_loc_req_params params;
+	struct smlc_latency_stamps stamps;
+};
+
+/* The FSM instance, this struct, and a few FSM instance id and name strings from osmo_fsm_inst_update_id() */
+#define SMLC_LOC_REQ_POOL_CHUNK_SIZE \
+	(sizeof(struct osmo_fsm_inst) + sizeof(struct smlc_loc_req) + 6 * SMLC_POOL_TALLOC_OVERHEAD + 256)
+
 int smlc_loc_req_rx_bssap_le(struct lb_conn *conn, const struct bssap_le_pdu *bssap_le);
+void smlc_loc_req_admitted(struct smlc_admission_entry *e);
+void smlc_loc_req_positioning_restart(void);
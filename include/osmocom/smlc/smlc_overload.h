@@ -0,0 +1,86 @@
+/* OsmoSMLC overload protection */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <osmocom/core/linuxlist.h>
+#include <osmocom/core/timer.h>
+#include <osmocom/core/utils.h>
+
+struct vty;
+
+/* Graded overload states, each one also sheds what the lower ones do */
+enum smlc_overload_state {
+	SMLC_OVERLOAD_NONE,
+	/* Raise the log level of all log targets to at least INFO */
+	SMLC_OVERLOAD_SKIP_DEBUG_LOG,
+	/* Reject new location requests of normal priority with LCS cause 'congestion' */
+	SMLC_OVERLOAD_REJECT_NORMAL,
+	/* Refuse new SCCP connections at N-CONNECT */
+	SMLC_OVERLOAD_REFUSE_CONN,
+	_NUM_SMLC_OVERLOAD_STATE
+};
+
+extern const struct value_string smlc_overload_state_names[];
+
+enum smlc_overload_metric {
+	/* Smoothed lateness of a periodic timer in ms, i.e. how long the main loop takes to come around */
+	SMLC_OVERLOAD_METRIC_LAG,
+	SMLC_OVERLOAD_METRIC_LB_CONNS,
+	SMLC_OVERLOAD_METRIC_LOC_REQS,
+	SMLC_OVERLOAD_METRIC_SUBSCRIBERS,
+	_NUM_SMLC_OVERLOAD_METRIC
+};
+
+extern const struct value_string smlc_overload_metric_names[];
+
+/* How often to measure the main loop lag and to re-evaluate the overload state */
+#define SMLC_OVERLOAD_PROBE_MS 100
+/* Leave a state only when no metric is above this percentage of its threshold, so that the state does not flap */
+#define SMLC_OVERLOAD_HYSTERESIS_PERCENT 80
+
+struct smlc_overload {
+	enum smlc_overload_state state;
+	/* Enter a state when any metric reaches its threshold, indexed by state and metric; 0 disables a threshold */
+	uint32_t threshold[_NUM_SMLC_OVERLOAD_STATE][_NUM_SMLC_OVERLOAD_METRIC];
+	/* How often each state was entered */
+	uint64_t entered[_NUM_SMLC_OVERLOAD_STATE];
+
+	/* Main loop lag: the latest, smoothed and max measurement */
+	uint32_t lag_us;
+	uint32_t lag_avg_us;
+	uint32_t lag_max_us;
+	struct osmo_timer_list probe_timer;
+	struct timespec probe_due;
+
+	/* Log levels of log targets as they were before SMLC_OVERLOAD_SKIP_DEBUG_LOG */
+	struct llist_head saved_loglevels;
+};
+
+struct smlc_overload *smlc_overload_alloc(void *ctx);
+enum smlc_overload_state smlc_overload_eval(const struct smlc_overload *ov,
+					    const uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC]);
+void smlc_overload_update(struct smlc_overload *ov, const uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC]);
+void smlc_overload_metrics(const struct smlc_overload *ov, uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC]);
+void smlc_overload_vty_show(struct vty *vty, const struct smlc_overload *ov);
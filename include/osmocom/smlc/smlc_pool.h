@@ -0,0 +1,76 @@
+/* OsmoSMLC: preallocated memory for per-transaction objects */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct vty;
+
+#define SMLC_POOL_DEFAULT_SIZE 128
+#define SMLC_POOL_DEFAULT_HIGH_WATER_MARK 2048
+
+/* Room for the talloc header of each object placed in a chunk, generously rounded up */
+#define SMLC_POOL_TALLOC_OVERHEAD 128
+
+/* A stack of talloc pools ("chunks"), each one large enough to hold the objects of one transaction, e.g. an lb_conn, or
+ * an smlc_loc_req with its FSM instance and id strings. Allocating from a chunk does not call malloc(); when all
+ * objects in a chunk are freed, talloc rewinds the chunk and it can be handed out again. */
+struct smlc_pool {
+	const char *name;
+	size_t chunk_size;
+
+	/* Number of chunks to allocate up front */
+	unsigned int size;
+	/* Allocate more chunks on demand up to this many. When more are in use, objects are allocated without the pool.
+	 * Chunks above this number are freed when they become unused. */
+	unsigned int high_water_mark;
+
+	/* Unused chunks, the last one is handed out next */
+	void **free_chunks;
+	unsigned int free_chunks_len;
+	unsigned int free_count;
+	/* Number of chunks allocated, in use or not */
+	unsigned int chunk_count;
+	/* Highest number of chunks in use at the same time */
+	unsigned int peak_in_use;
+
+	/* Objects placed in a chunk */
+	uint64_t pooled;
+	/* Objects allocated without the pool, because high_water_mark chunks were in use */
+	uint64_t unpooled;
+};
+
+struct smlc_pool *smlc_pool_alloc(void *ctx, const char *name, size_t chunk_size, unsigned int size,
+				  unsigned int high_water_mark);
+void smlc_pool_set_size(struct smlc_pool *pool, unsigned int size, unsigned int high_water_mark);
+void *smlc_pool_get(struct smlc_pool *pool);
+void smlc_pool_put(struct smlc_pool *pool, void *chunk);
+
+static inline unsigned int smlc_pool_in_use(const struct smlc_pool *pool)
+{
+	return pool->chunk_count - pool->free_count;
+}
+
+void smlc_pool_vty_show(struct vty *vty, const struct smlc_pool *pool);
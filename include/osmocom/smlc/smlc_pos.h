@@ -0,0 +1,69 @@
+/* OsmoSMLC: positioning, i.e. computing location estimates, inline or on worker threads */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#include <osmocom/gsm/gad.h>
+#include <osmocom/smlc/smlc_workers.h>
+
+struct smlc_pos_job;
+
+/* Jobs in flight per positioning thread */
+#define SMLC_POS_QUEUE_LEN 1024
+
+/* Called on the main thread with the result. The job is freed after. */
+typedef void (*smlc_pos_done_cb_t)(struct smlc_pos_job *job);
+
+/* Everything needed to compute one location estimate, and the result. On a positioning thread, only the input and
+ * output members are used. */
+struct smlc_pos_job {
+	struct smlc_work work;
+
+	/* Input: the serving cell's position and coverage radius in meters (0 if unknown), and the TA */
+	int32_t lat;
+	int32_t lon;
+	uint32_t radius;
+	uint8_t ta;
+	/* A positioning thread getting to the job only after this CLOCK_MONOTONIC time skips it, see rc */
+	struct timespec deadline;
+
+	/* Output: 0 and the location estimate on success, -ETIMEDOUT if the deadline passed, or another negative error */
+	int rc;
+	struct osmo_gad location;
+	union gad_raw location_estimate;
+	unsigned int location_estimate_len;
+
+	/* Only used on the main thread */
+	smlc_pos_done_cb_t done_cb;
+	/* The requester. Set to NULL to drop the result, e.g. when the requester is gone. */
+	void *priv;
+};
+
+struct smlc_pos_job *smlc_pos_job_alloc(void *ctx, smlc_pos_done_cb_t done_cb, void *priv);
+int smlc_pos_compute(struct smlc_pos_job *job);
+int smlc_pos_submit(struct smlc_workers *workers, unsigned int shard, struct smlc_pos_job *job,
+		    unsigned long deadline_ms);
+void smlc_pos_run(struct smlc_work *work);
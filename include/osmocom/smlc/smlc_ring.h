@@ -0,0 +1,49 @@
+/* OsmoSMLC: lock-free single producer, single consumer ring of pointers */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* A bounded queue between exactly two threads: one only pushes, the other only pops. Neither blocks or takes a lock.
+ * The producer publishes a slot by advancing head, the consumer frees it by advancing tail. Both counters run freely
+ * and are masked to index the slots. */
+struct smlc_ring {
+	/* Number of slots, a power of two */
+	unsigned int size;
+	void **slots;
+
+	/* Next slot to write, only changed by the producer */
+	atomic_uint head;
+	/* Keep head and tail on separate cache lines, so that the two threads do not keep taking the line from each
+	 * other */
+	char pad[64];
+	/* Next slot to read, only changed by the consumer */
+	atomic_uint tail;
+};
+
+struct smlc_ring *smlc_ring_alloc(void *ctx, unsigned int size);
+bool smlc_ring_push(struct smlc_ring *ring, void *item);
+void *smlc_ring_pop(struct smlc_ring *ring);
+unsigned int smlc_ring_count(struct smlc_ring *ring);
@@ -1,24 +1,59 @@
 #pragma once
 
 #include <osmocom/core/linuxlist.h>
+#include <osmocom/core/hashtable.h>
 #include <osmocom/core/fsm.h>
 #include <osmocom/core/use_count.h>
 #include <osmocom/gsm/gsm48.h>
 #include <osmocom/gsm/gsm0808.h>
+#include <osmocom/gsm/gad.h>
+
+struct smlc_loc_req_params;
+struct lb_conn;
+
+#define SMLC_SUBSCR_USE_LAST_LOCATION "last-location"
+
+/* The location estimate last sent for a subscriber */
+struct smlc_subscr_last_location {
+	/* entry in g_smlc->last_locations */
+	struct llist_head entry;
+	bool valid;
+	/* CLOCK_MONOTONIC */
+	struct timespec time;
+	uint8_t ta;
+	struct osmo_gad location;
+	union gad_raw location_estimate;
+};
 
 struct smlc_subscr {
 	struct llist_head entry;
+	/* entry in g_smlc->subscribers_by_imsi */
+	struct hlist_node hnode;
+	/* The IMSI digits packed as in smlc_subscr_imsi_key() */
+	uint64_t imsi_key;
 	struct osmo_use_count use_count;
 
 	struct osmo_mobile_identity imsi;
+	/* The cell of last_location */
 	struct gsm0808_cell_id cell_id;
+	struct smlc_subscr_last_location last_location;
 
 	struct osmo_fsm_inst *loc_req;
+	/* The lb_conn that has this subscriber as its smlc_subscr, if any */
+	struct lb_conn *lb_conn;
 };
 
 struct smlc_subscr *smlc_subscr_find_or_create(const struct osmo_mobile_identity *imsi, const char *use_token);
 struct smlc_subscr *smlc_subscr_find(const struct osmo_mobile_identity *imsi, const char *use_token);
 
+uint64_t smlc_subscr_imsi_key(const struct osmo_mobile_identity *imsi);
+
+void smlc_subscr_last_location_set(struct smlc_subscr *smlc_subscr, const struct gsm0808_cell_id *cell_id, uint8_t ta,
+				   const struct osmo_gad *location, const union gad_raw *location_estimate);
+const struct smlc_subscr_last_location *smlc_subscr_last_location_get(struct smlc_subscr *smlc_subscr,
+								     const struct smlc_loc_req_params *req);
+void smlc_subscr_last_location_expire(void);
+
 int smlc_subscr_to_str_buf(char *buf, size_t buf_len, const struct smlc_subscr *smlc_subscr);
 char *smlc_subscr_to_str_c(void *ctx, const struct smlc_subscr *smlc_subscr);
 
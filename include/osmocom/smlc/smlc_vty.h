@@ -4,4 +4,7 @@
 
 enum smlc_vty_node {
 	CELLS_NODE = _LAST_OSMOVTY_NODE + 1,
+	SMLC_NODE,
 };
+
+int smlc_vty_init(void);
@@ -0,0 +1,99 @@
+/* OsmoSMLC: pool of worker threads fed through lock-free rings */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include <osmocom/core/linuxlist.h>
+#include <osmocom/core/select.h>
+
+struct vty;
+struct smlc_ring;
+struct smlc_workers;
+struct smlc_work;
+
+/* A worker wakes the main thread at least once per this many completed jobs */
+#define SMLC_WORKERS_BATCH 32
+
+typedef void (*smlc_work_cb_t)(struct smlc_work *work);
+
+/* Embedded in each job handed to a worker thread */
+struct smlc_work {
+	/* Called on a worker thread. Must not touch anything the main thread uses meanwhile: no talloc contexts, FSMs,
+	 * rate counters or use counts. */
+	smlc_work_cb_t run;
+	/* Called on the main thread after run, in the order of submission per shard; may free the job */
+	smlc_work_cb_t done;
+
+	/* entry in smlc_worker->backlog */
+	struct llist_head entry;
+};
+
+struct smlc_worker {
+	struct smlc_workers *workers;
+	unsigned int nr;
+	pthread_t thread;
+	bool started;
+
+	/* Jobs from the main thread to this worker */
+	struct smlc_ring *jobs;
+	/* Completed jobs back to the main thread */
+	struct smlc_ring *done;
+	/* Wakes this worker when jobs are added while it sleeps */
+	int wake_fd;
+	atomic_bool sleeping;
+
+	/* The rest is only used on the main thread */
+	/* Completed jobs taken from the done ring to make room in the jobs ring, see smlc_workers_submit() */
+	struct llist_head backlog;
+	/* Jobs submitted and not yet taken back from the done ring. At most the size of the rings, so that a worker
+	 * never finds its done ring full. */
+	unsigned int in_flight;
+	uint64_t submitted;
+};
+
+/* Run jobs on worker threads. Everything else stays on the main thread; jobs go to the workers and back through
+ * lock-free rings, and an eventfd wakes the main loop. */
+struct smlc_workers {
+	const char *name;
+	unsigned int num_workers;
+	unsigned int queue_len;
+	struct smlc_worker *workers;
+
+	/* Written by the workers when they have completed jobs, read in the main loop */
+	struct osmo_fd done_ofd;
+	atomic_bool stop;
+
+	/* Times smlc_workers_submit() refused a job because the worker was a full ring behind */
+	uint64_t queue_full;
+};
+
+struct smlc_workers *smlc_workers_alloc(void *ctx, const char *name, unsigned int num_workers, unsigned int queue_len);
+void smlc_workers_free(struct smlc_workers *workers);
+int smlc_workers_submit(struct smlc_workers *workers, unsigned int shard, struct smlc_work *work);
+void smlc_workers_poll(struct smlc_workers *workers);
+void smlc_workers_vty_show(struct vty *vty, const struct smlc_workers *workers);
@@ -0,0 +1,46 @@
+/* OsmoSMLC adaptive BSSLAP TA Response timeout */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Smoothed round trip time of BSSLAP TA Request/Response with one Lb peer, from which a timeout for the TA Response
+ * is derived like TCP's retransmission timeout (RFC 6298). */
+struct ta_rtt {
+	/* Number of round trips measured */
+	uint32_t samples;
+	/* Smoothed round trip time and its mean deviation, in microseconds */
+	uint32_t srtt_us;
+	uint32_t rttvar_us;
+	/* Number of TA Response timeouts since the last measured round trip; each one doubles the timeout */
+	uint8_t backoff;
+};
+
+/* Stop doubling the timeout after this many timeouts in a row; the upper bound applies anyway. */
+#define TA_RTT_MAX_BACKOFF 8
+
+void ta_rtt_sample(struct ta_rtt *rtt, uint64_t rtt_us);
+void ta_rtt_timed_out(struct ta_rtt *rtt);
+unsigned long ta_rtt_timeout_ms(const struct ta_rtt *rtt, unsigned long initial_ms, unsigned long min_ms,
+				unsigned long max_ms);
@@ -0,0 +1,77 @@
+/* OsmoSMLC timer wheel for transaction timeouts */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <osmocom/core/linuxlist.h>
+#include <osmocom/core/timer.h>
+
+/* Each level has 64 slots; a slot of level n covers 64^n ticks. Timeouts beyond 64^4 ticks are cut short to that. */
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_MAX_TICKS ((1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+/* Granularity of g_smlc->timer_wheel */
+#define SMLC_TIMER_WHEEL_TICK_MS 100
+
+struct timer_wheel;
+
+struct timer_wheel_timer {
+	/* entry in a slot of the timer_wheel while pending */
+	struct llist_head entry;
+	struct timer_wheel *wheel;
+	/* tick at which the timer expires */
+	uint64_t expires;
+	void (*cb)(void *data);
+	void *data;
+};
+
+/* Many timers of coarse granularity, e.g. one timeout per transaction, on a single osmo_timer. Scheduling and removing
+ * a timer takes constant time, regardless of the number of pending timers. Timers of the same tick expire in one
+ * batch. */
+struct timer_wheel {
+	unsigned int tick_ms;
+	/* CLOCK_MONOTONIC at tick zero */
+	struct timespec epoch;
+	/* The tick that the slots are processed up to */
+	uint64_t now;
+	struct llist_head slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	/* Fires at every tick while timers are pending */
+	struct osmo_timer_list timer;
+	unsigned int count;
+};
+
+struct timer_wheel *timer_wheel_alloc(void *ctx, unsigned int tick_ms);
+
+void timer_wheel_timer_setup(struct timer_wheel_timer *t, void (*cb)(void *data), void *data);
+void timer_wheel_schedule(struct timer_wheel *w, struct timer_wheel_timer *t, unsigned long timeout_ms);
+void timer_wheel_del(struct timer_wheel_timer *t);
+
+static inline bool timer_wheel_pending(const struct timer_wheel_timer *t)
+{
+	return !llist_empty(&t->entry);
+}
@@ -0,0 +1,45 @@
+/* OsmoSMLC token bucket rate limiter */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+struct token_bucket_cfg {
+	/* Tokens added per second, 0 for no limit */
+	uint32_t rate;
+	/* The most tokens the bucket holds, i.e. the longest burst allowed after a quiet period */
+	uint32_t burst;
+};
+
+/* Tokens are kept in thousandths, so that slow rates refill smoothly. A zeroed bucket starts out full. */
+struct token_bucket {
+	bool started;
+	uint64_t millitokens;
+	struct timespec last_refill;
+};
+
+bool token_bucket_take(struct token_bucket *tb, const struct token_bucket_cfg *cfg);
+uint32_t token_bucket_tokens(const struct token_bucket *tb, const struct token_bucket_cfg *cfg);
@@ -0,0 +1,342 @@
+/* OsmoSMLC precompiled cell location database */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/logging.h>
+#include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/cell_db.h>
+
+static int cell_db_destructor(struct cell_db *db)
+{
+	if (db->map)
+		munmap(db->map, db->map_len);
+	return 0;
+}
+
+/* Map the cell database file at path to memory, read-only and shared, so that all processes on a host use the same
+ * pages. On success, return 0 and a talloc allocated struct cell_db in *db_p; talloc_free() it to unmap. */
+int cell_db_open(void *ctx, struct cell_db **db_p, const char *path)
+{
+	struct cell_db *db;
+	const struct cell_db_header *hdr;
+	struct stat st;
+	void *map;
+	uint32_t i;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		LOGP(DSMLC, LOGL_ERROR, "Cannot open cell database %s: %s\n", path, strerror(errno));
+		return -errno;
+	}
+	if (fstat(fd, &st)) {
+		LOGP(DSMLC, LOGL_ERROR, "Cannot stat cell database %s: %s\n", path, strerror(errno));
+		close(fd);
+		return -errno;
+	}
+	if (st.st_size < 0 || (size_t)st.st_size < sizeof(*hdr)) {
+		LOGP(DSMLC, LOGL_ERROR, "Cell database %s: file too short\n", path);
+		close(fd);
+		return -EINVAL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		LOGP(DSMLC, LOGL_ERROR, "Cannot map cell database %s: %s\n", path, strerror(errno));
+		return -errno;
+	}
+
+	db = talloc_zero(ctx, struct cell_db);
+	OSMO_ASSERT(db);
+	db->map = map;
+	db->map_len = st.st_size;
+	talloc_set_destructor(db, cell_db_destructor);
+
+	hdr = map;
+	if (memcmp(hdr->magic, CELL_DB_MAGIC, sizeof(hdr->magic))) {
+		LOGP(DSMLC, LOGL_ERROR, "%s is not a cell database file\n", path);
+		goto invalid;
+	}
+	if (hdr->byte_order != CELL_DB_BYTE_ORDER) {
+		LOGP(DSMLC, LOGL_ERROR, "Cell database %s was compiled on a host of different byte order\n", path);
+		goto invalid;
+	}
+	if (hdr->version != CELL_DB_VERSION) {
+		LOGP(DSMLC, LOGL_ERROR, "Cell database %s has version %u, expected version %u; recompile it with"
+		     " osmo-smlc-cells-compile\n", path, hdr->version, CELL_DB_VERSION);
+		goto invalid;
+	}
+	if (hdr->records_ofs % sizeof(uint32_t) || hdr->ci_index_ofs % sizeof(uint32_t)
+	    || (uint64_t)hdr->records_ofs + (uint64_t)hdr->n_records * sizeof(struct cell_db_record) > db->map_len
+	    || (uint64_t)hdr->ci_index_ofs + (uint64_t)hdr->n_records * sizeof(uint32_t) > db->map_len) {
+		LOGP(DSMLC, LOGL_ERROR, "Cell database %s: file is truncated or corrupt\n", path);
+		goto invalid;
+	}
+
+	db->hdr = hdr;
+	db->n_records = hdr->n_records;
+	db->records = (const void *)((const uint8_t *)map + hdr->records_ofs);
+	db->ci_index = (const void *)((const uint8_t *)map + hdr->ci_index_ofs);
+
+	/* Lookups index db->records by these without further checks */
+	for (i = 0; i < db->n_records; i++) {
+		if (db->ci_index[i] >= db->n_records) {
+			LOGP(DSMLC, LOGL_ERROR, "Cell database %s: CI index entry %u points past the %u records\n",
+			     path, i, db->n_records);
+			goto invalid;
+		}
+	}
+
+	db->path = talloc_strdup(db, path);
+
+	LOGP(DSMLC, LOGL_NOTICE, "Loaded %u cell locations from %s\n", db->n_records, path);
+	*db_p = db;
+	return 0;
+
+invalid:
+	talloc_free(db);
+	return -EINVAL;
+}
+
+void cell_db_record_to_cell_id(struct gsm0808_cell_id *cell_id, const struct cell_db_record *rec)
+{
+	struct osmo_cell_global_id cgi = {
+		.lai = {
+			.plmn = {
+				.mcc = rec->mcc,
+				.mnc = rec->mnc,
+				.mnc_3_digits = rec->mnc_3_digits,
+			},
+			.lac = rec->lac,
+		},
+		.cell_identity = rec->ci,
+	};
+	gsm0808_cell_id_from_cgi(cell_id, rec->id_discr, &cgi);
+}
+
+static uint32_t rec_lac_ci(const struct cell_db_record *rec)
+{
+	return ((uint32_t)rec->lac << 16) | rec->ci;
+}
+
+/* Return the index of the first record with a LAC-CI >= lac_ci */
+static uint32_t lower_bound_lac_ci(const struct cell_db *db, uint64_t lac_ci)
+{
+	uint32_t lo = 0;
+	uint32_t hi = db->n_records;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (rec_lac_ci(&db->records[mid]) < lac_ci)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* Return the position in ci_index of the first record with a CI >= ci */
+static uint32_t lower_bound_ci(const struct cell_db *db, uint32_t ci)
+{
+	uint32_t lo = 0;
+	uint32_t hi = db->n_records;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (db->records[db->ci_index[mid]].ci < ci)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* Check one record against cell_id. Return true on an exact match; otherwise remember the partial match listed first
+ * in *fuzzy. */
+static bool cell_db_match(const struct cell_db_record *rec, const struct gsm0808_cell_id *cell_id,
+			  const struct cell_db_record **fuzzy)
+{
+	struct gsm0808_cell_id rec_cell_id;
+
+	cell_db_record_to_cell_id(&rec_cell_id, rec);
+	if (gsm0808_cell_ids_match(&rec_cell_id, cell_id, true))
+		return true;
+	if ((!*fuzzy || rec->seq < (*fuzzy)->seq)
+	    && gsm0808_cell_ids_match(&rec_cell_id, cell_id, false))
+		*fuzzy = rec;
+	return false;
+}
+
+/* Find a cell_id in the database, with the same semantics as cell_locations_find(): an exact match is preferred, then
+ * the first partial match in the order of the source file. */
+const struct cell_db_record *cell_db_find(const struct cell_db *db, const struct gsm0808_cell_id *cell_id)
+{
+	struct osmo_cell_global_id cgi = {};
+	enum cgi_part parts;
+	const struct cell_db_record *fuzzy = NULL;
+	uint32_t i, end;
+
+	parts = gsm0808_cell_id_to_cgi(&cgi, cell_id);
+
+	if (parts & CGI_PART_LAC) {
+		uint64_t lac_ci = (uint64_t)cgi.lai.lac << 16;
+		uint64_t lac_ci_end = lac_ci + 0x10000;
+		if (parts & CGI_PART_CI) {
+			lac_ci |= cgi.cell_identity;
+			lac_ci_end = lac_ci + 1;
+		}
+		end = lower_bound_lac_ci(db, lac_ci_end);
+		for (i = lower_bound_lac_ci(db, lac_ci); i < end; i++) {
+			if (cell_db_match(&db->records[i], cell_id, &fuzzy))
+				return &db->records[i];
+		}
+	} else if (parts & CGI_PART_CI) {
+		end = lower_bound_ci(db, cgi.cell_identity + 1);
+		for (i = lower_bound_ci(db, cgi.cell_identity); i < end; i++) {
+			const struct cell_db_record *rec = &db->records[db->ci_index[i]];
+			if (cell_db_match(rec, cell_id, &fuzzy))
+				return rec;
+		}
+	} else {
+		for (i = 0; i < db->n_records; i++) {
+			if (cell_db_match(&db->records[i], cell_id, &fuzzy))
+				return &db->records[i];
+		}
+	}
+	return fuzzy;
+}
+
+/* The order of records in the file, with exact duplicates adjacent */
+static int rec_cmp(const void *a_, const void *b_)
+{
+	const struct cell_db_record *a = a_;
+	const struct cell_db_record *b = b_;
+	int rc;
+	if ((rc = OSMO_CMP(rec_lac_ci(a), rec_lac_ci(b))))
+		return rc;
+	if ((rc = OSMO_CMP(a->id_discr, b->id_discr)))
+		return rc;
+	if ((rc = OSMO_CMP(a->mcc, b->mcc)))
+		return rc;
+	if ((rc = OSMO_CMP(a->mnc, b->mnc)))
+		return rc;
+	if ((rc = OSMO_CMP(a->mnc_3_digits, b->mnc_3_digits)))
+		return rc;
+	return OSMO_CMP(a->seq, b->seq);
+}
+
+static bool rec_same_cell(const struct cell_db_record *a, const struct cell_db_record *b)
+{
+	return rec_lac_ci(a) == rec_lac_ci(b)
+		&& a->id_discr == b->id_discr
+		&& a->mcc == b->mcc
+		&& a->mnc == b->mnc
+		&& a->mnc_3_digits == b->mnc_3_digits;
+}
+
+static const struct cell_db_record *ci_index_sort_records;
+
+static int ci_index_cmp(const void *a_, const void *b_)
+{
+	const struct cell_db_record *a = &ci_index_sort_records[*(const uint32_t *)a_];
+	const struct cell_db_record *b = &ci_index_sort_records[*(const uint32_t *)b_];
+	int rc;
+	if ((rc = OSMO_CMP(a->ci, b->ci)))
+		return rc;
+	return OSMO_CMP(a->seq, b->seq);
+}
+
+/* Write a cell database file from the records, which are sorted in place. If the same cell is listed more than once,
+ * the last entry's location wins, at the position of the first entry, like repeated 'cells' configuration does.
+ * The file is replaced atomically, so that a running osmo-smlc never maps a half written file. */
+int cell_db_write(const char *path, struct cell_db_record *records, uint32_t n_records, uint32_t *n_written)
+{
+	struct cell_db_header hdr = {
+		.magic = CELL_DB_MAGIC,
+		.version = CELL_DB_VERSION,
+		.byte_order = CELL_DB_BYTE_ORDER,
+	};
+	uint32_t *ci_index;
+	char *tmp_path;
+	uint32_t i, n;
+	FILE *f;
+	int rc = 0;
+
+	qsort(records, n_records, sizeof(*records), rec_cmp);
+
+	/* Drop duplicates */
+	for (i = 0, n = 0; i < n_records; i++) {
+		if (n && rec_same_cell(&records[n - 1], &records[i])) {
+			records[n - 1].lat = records[i].lat;
+			records[n - 1].lon = records[i].lon;
+			records[n - 1].radius = records[i].radius;
+			continue;
+		}
+		records[n++] = records[i];
+	}
+
+	ci_index = talloc_array(NULL, uint32_t, n);
+	OSMO_ASSERT(ci_index);
+	for (i = 0; i < n; i++)
+		ci_index[i] = i;
+	ci_index_sort_records = records;
+	qsort(ci_index, n, sizeof(*ci_index), ci_index_cmp);
+
+	hdr.n_records = n;
+	hdr.records_ofs = sizeof(hdr);
+	hdr.ci_index_ofs = hdr.records_ofs + n * sizeof(*records);
+
+	tmp_path = talloc_asprintf(NULL, "%s.tmp", path);
+	f = fopen(tmp_path, "w");
+	if (!f) {
+		rc = -errno;
+		goto out;
+	}
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1
+	    || fwrite(records, sizeof(*records), n, f) != n
+	    || fwrite(ci_index, sizeof(*ci_index), n, f) != n) {
+		rc = -EIO;
+		fclose(f);
+		unlink(tmp_path);
+		goto out;
+	}
+	if (fclose(f) || rename(tmp_path, path)) {
+		rc = -errno;
+		unlink(tmp_path);
+		goto out;
+	}
+	if (n_written)
+		*n_written = n;
+out:
+	talloc_free(tmp_path);
+	talloc_free(ci_index);
+	return rc;
+}
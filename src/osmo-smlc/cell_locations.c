@@ -28,81 +28,263 @@
 #include <errno.h>
 
 #include <osmocom/core/utils.h>
+#include <osmocom/core/hash.h>
 #include <osmocom/gsm/protocol/gsm_08_08.h>
 #include <osmocom/gsm/gsm0808_utils.h>
 #include <osmocom/gsm/gad.h>
 #include <osmocom/smlc/smlc_data.h>
 #include <osmocom/smlc/smlc_vty.h>
 #include <osmocom/smlc/cell_locations.h>
+#include <osmocom/smlc/cell_db.h>
+#include <osmocom/smlc/cell_table.h>
+
+#define CELL_LOCATIONS_HASH_MIN_BITS 8
 
 static uint32_t ta_to_m(uint8_t ta)
 {
 	return ((uint32_t)ta) * 550;
 }
 
-static struct cell_location *cell_location_find(const struct gsm0808_cell_id *cell_id)
+static bool cell_location_in_idx(const struct cell_location *cell, enum cell_location_idx idx)
 {
-	struct cell_location *cell_location;
-	llist_for_each_entry(cell_location, &g_smlc->cell_locations, entry) {
-		if (gsm0808_cell_ids_match(&cell_location->cell_id, cell_id, true))
-			return cell_location;
+	switch (idx) {
+	case CELL_LOCATION_IDX_EXACT:
+		return true;
+	case CELL_LOCATION_IDX_LAC_CI:
+		return (cell->parts & CGI_PART_LAC) && (cell->parts & CGI_PART_CI);
+	case CELL_LOCATION_IDX_LAC:
+		return cell->parts & CGI_PART_LAC;
+	case CELL_LOCATION_IDX_CI:
+		return cell->parts & CGI_PART_CI;
+	default:
+		OSMO_ASSERT(false);
 	}
-	llist_for_each_entry(cell_location, &g_smlc->cell_locations, entry) {
-		if (gsm0808_cell_ids_match(&cell_location->cell_id, cell_id, false))
-			return cell_location;
+}
+
+/* The key only needs to be identical for matching cell ids, any remaining ambiguity is resolved by
+ * gsm0808_cell_ids_match(). */
+static uint32_t cell_location_key(enum cell_location_idx idx, enum CELL_IDENT id_discr,
+				  const struct osmo_cell_global_id *cgi)
+{
+	switch (idx) {
+	case CELL_LOCATION_IDX_EXACT:
+		return (((uint32_t)cgi->lai.lac << 16) | cgi->cell_identity)
+			^ ((uint32_t)id_discr << 28)
+			^ ((uint32_t)cgi->lai.plmn.mcc << 18)
+			^ ((uint32_t)cgi->lai.plmn.mnc << 8);
+	case CELL_LOCATION_IDX_LAC_CI:
+		return ((uint32_t)cgi->lai.lac << 16) | cgi->cell_identity;
+	case CELL_LOCATION_IDX_LAC:
+		return cgi->lai.lac;
+	case CELL_LOCATION_IDX_CI:
+		return cgi->cell_identity;
+	default:
+		OSMO_ASSERT(false);
 	}
-	return NULL;
 }
 
-int cell_location_from_ta(struct osmo_gad *location_estimate,
-			  const struct gsm0808_cell_id *cell_id,
-			  uint8_t ta)
+static struct hlist_head *cell_location_bucket(const struct cell_locations *cl, enum cell_location_idx idx,
+					       enum CELL_IDENT id_discr, const struct osmo_cell_global_id *cgi)
 {
-	const struct cell_location *cell;
-	cell = cell_location_find(cell_id);
-	if (!cell)
-		return -ENOENT;
+	const struct cell_location_hash *h = &cl->idx[idx];
+	return &h->buckets[hash_32(cell_location_key(idx, id_discr, cgi), h->bits)];
+}
 
+static void cell_location_hash_add(struct cell_locations *cl, struct cell_location *cell)
+{
+	enum cell_location_idx idx;
+	for (idx = 0; idx < _NUM_CELL_LOCATION_IDX; idx++) {
+		if (!cell_location_in_idx(cell, idx))
+			continue;
+		hlist_add_head(&cell->hnode[idx], cell_location_bucket(cl, idx, cell->cell_id.id_discr, &cell->cgi));
+	}
+}
+
+/* Re-distribute all entries over 2^bits buckets per index. */
+static void cell_locations_rehash(struct cell_locations *cl, unsigned int bits)
+{
+	struct cell_location *cell;
+	enum cell_location_idx idx;
+
+	for (idx = 0; idx < _NUM_CELL_LOCATION_IDX; idx++) {
+		struct cell_location_hash *h = &cl->idx[idx];
+		talloc_free(h->buckets);
+		h->bits = bits;
+		h->buckets = talloc_zero_array(cl, struct hlist_head, 1 << bits);
+		OSMO_ASSERT(h->buckets);
+	}
+
+	llist_for_each_entry(cell, &cl->list, entry)
+		cell_location_hash_add(cl, cell);
+}
+
+struct cell_locations *cell_locations_alloc(void *ctx)
+{
+	struct cell_locations *cl = talloc_zero(ctx, struct cell_locations);
+	OSMO_ASSERT(cl);
+	INIT_LLIST_HEAD(&cl->list);
+	INIT_LLIST_HEAD(&cl->partial);
+	cell_locations_rehash(cl, CELL_LOCATIONS_HASH_MIN_BITS);
+	return cl;
+}
+
+/* Among the fuzzy matches in one hash bucket, return the one configured first. */
+static struct cell_location *cell_locations_fuzzy_bucket(struct hlist_head *bucket, enum cell_location_idx idx,
+							 const struct gsm0808_cell_id *cell_id,
+							 struct cell_location *found)
+{
+	struct cell_location *cell;
+	hlist_for_each_entry(cell, bucket, hnode[idx]) {
+		if (found && found->seq < cell->seq)
+			continue;
+		if (gsm0808_cell_ids_match(&cell->cell_id, cell_id, false))
+			found = cell;
+	}
+	return found;
+}
+
+/* Return the cell location matching cell_id. Like walking the list first for an exact match and then for the first
+ * partial match, but taking only O(1) for exact matches and for partial matches of a cell_id that has a LAC or CI. */
+struct cell_location *cell_locations_find(const struct cell_locations *cl, const struct gsm0808_cell_id *cell_id)
+{
+	struct osmo_cell_global_id cgi = {};
+	enum cgi_part parts;
+	enum cell_location_idx idx;
+	struct cell_location *cell;
+	struct cell_location *found = NULL;
+
+	parts = gsm0808_cell_id_to_cgi(&cgi, cell_id);
+
+	hlist_for_each_entry(cell, cell_location_bucket(cl, CELL_LOCATION_IDX_EXACT, cell_id->id_discr, &cgi),
+			     hnode[CELL_LOCATION_IDX_EXACT]) {
+		if (found && found->seq < cell->seq)
+			continue;
+		if (gsm0808_cell_ids_match(&cell->cell_id, cell_id, true))
+			found = cell;
+	}
+	if (found)
+		return found;
+
+	if ((parts & CGI_PART_LAC) && (parts & CGI_PART_CI))
+		idx = CELL_LOCATION_IDX_LAC_CI;
+	else if (parts & CGI_PART_LAC)
+		idx = CELL_LOCATION_IDX_LAC;
+	else if (parts & CGI_PART_CI)
+		idx = CELL_LOCATION_IDX_CI;
+	else {
+		/* Neither LAC nor CI to look up, any cell may match. */
+		llist_for_each_entry(cell, &cl->list, entry) {
+			if (gsm0808_cell_ids_match(&cell->cell_id, cell_id, false))
+				return cell;
+		}
+		return NULL;
+	}
+
+	/* Entries lacking the LAC or CI are not in all indexes, but may still match partially. */
+	llist_for_each_entry(cell, &cl->partial, partial_entry) {
+		if (gsm0808_cell_ids_match(&cell->cell_id, cell_id, false)) {
+			found = cell;
+			break;
+		}
+	}
+
+	return cell_locations_fuzzy_bucket(cell_location_bucket(cl, idx, 0, &cgi), idx, cell_id, found);
+}
+
+struct cell_location *cell_locations_add(struct cell_locations *cl, const struct gsm0808_cell_id *cell_id)
+{
+	struct cell_location *cell = talloc_zero(cl, struct cell_location);
+	OSMO_ASSERT(cell);
+
+	cell->cell_id = *cell_id;
+	cell->parts = gsm0808_cell_id_to_cgi(&cell->cgi, cell_id);
+	cell->seq = cl->next_seq++;
+
+	llist_add_tail(&cell->entry, &cl->list);
+	if (!cell_location_in_idx(cell, CELL_LOCATION_IDX_LAC_CI))
+		llist_add_tail(&cell->partial_entry, &cl->partial);
+	else
+		INIT_LLIST_HEAD(&cell->partial_entry);
+	cl->count++;
+
+	/* Keep the load factor of the indexes below one */
+	if (cl->count > (1 << cl->idx[CELL_LOCATION_IDX_EXACT].bits))
+		cell_locations_rehash(cl, cl->idx[CELL_LOCATION_IDX_EXACT].bits + 1);
+	else
+		cell_location_hash_add(cl, cell);
+	return cell;
+}
+
+void cell_locations_del(struct cell_locations *cl, struct cell_location *cell)
+{
+	enum cell_location_idx idx;
+
+	for (idx = 0; idx < _NUM_CELL_LOCATION_IDX; idx++) {
+		if (cell_location_in_idx(cell, idx))
+			hlist_del(&cell->hnode[idx]);
+	}
+	llist_del(&cell->partial_entry);
+	llist_del(&cell->entry);
+	cl->count--;
+	talloc_free(cell);
+}
+
+/* Compose a location estimate around a cell's position, with the distance indicated by the Timing Advance as
+ * uncertainty radius. */
+void cell_location_estimate_from_ta(struct osmo_gad *location_estimate, int32_t lat, int32_t lon, uint8_t ta)
+{
 	*location_estimate = (struct osmo_gad){
 		.type = GAD_TYPE_ELL_POINT_UNC_CIRCLE,
 		.ell_point_unc_circle = {
-			.lat = cell->lat,
-			.lon = cell->lon,
+			.lat = lat,
+			.lon = lon,
 			.unc = osmo_gad_dec_unc(osmo_gad_enc_unc(ta_to_m(ta) * 1000)),
 		},
 	};
+}
 
-	return 0;
+/* Compose a location estimate around a cell's position, with the cell's radius in meters as uncertainty, for a
+ * response based on the cell identity alone. */
+void cell_location_estimate_from_radius(struct osmo_gad *location_estimate, int32_t lat, int32_t lon,
+					uint32_t radius)
+{
+	*location_estimate = (struct osmo_gad){
+		.type = GAD_TYPE_ELL_POINT_UNC_CIRCLE,
+		.ell_point_unc_circle = {
+			.lat = lat,
+			.lon = lon,
+			.unc = osmo_gad_dec_unc(osmo_gad_enc_unc(radius * 1000)),
+		},
+	};
 }
 
 static struct cell_location *cell_location_find_or_create(const struct gsm0808_cell_id *cell_id)
 {
-	struct cell_location *cell_location = cell_location_find(cell_id);
-	if (!cell_location) {
-		cell_location = talloc_zero(g_smlc, struct cell_location);
-		OSMO_ASSERT(cell_location);
-		cell_location->cell_id = *cell_id;
-		llist_add_tail(&cell_location->entry, &g_smlc->cell_locations);
-	}
+	struct cell_location *cell_location = cell_locations_find(g_smlc->cell_locations, cell_id);
+	if (!cell_location)
+		cell_location = cell_locations_add(g_smlc->cell_locations, cell_id);
 	return cell_location;
 
 }
 
-static const struct cell_location *cell_location_set(const struct gsm0808_cell_id *cell_id, int32_t lat, int32_t lon)
+static const struct cell_location *cell_location_set(const struct gsm0808_cell_id *cell_id, int32_t lat, int32_t lon,
+						     uint32_t radius)
 {
 	struct cell_location *cell_location = cell_location_find_or_create(cell_id);
 	cell_location->lat = lat;
 	cell_location->lon = lon;
+	cell_location->radius = radius;
+	cell_table_rebuild();
 	return 0;
 }
 
 static int cell_location_remove(const struct gsm0808_cell_id *cell_id)
 {
-	struct cell_location *cell_location = cell_location_find(cell_id);
+	struct cell_location *cell_location = cell_locations_find(g_smlc->cell_locations, cell_id);
 	if (!cell_location)
 		return -ENOENT;
-	llist_del(&cell_location->entry);
-	talloc_free(cell_location);
+	cell_locations_del(g_smlc->cell_locations, cell_location);
+	cell_table_rebuild();
 	return 0;
 }
 
@@ -116,6 +298,10 @@ static int cell_location_remove(const struct gsm0808_cell_id *cell_id)
 #define LAT_LON_DOC "Global latitute coordinate\n" "Latitude floating-point number, -90.0 (S) to 90.0 (N)\n" \
 		"Global longitude coordinate\n" "Longitude as floating-point number, -180.0 (W) to 180.0 (E)\n"
 
+#define RADIUS_PARAMS "radius <1-100000>"
+#define RADIUS_DOC "Radius of the cell's coverage, the uncertainty of a Location Estimate from the cell identity alone\n" \
+		"Radius in meters\n"
+
 static int vty_parse_lac_ci(struct vty *vty, struct gsm0808_cell_id *dst, const char **argv)
 {
 	*dst = (struct gsm0808_cell_id){
@@ -154,7 +340,8 @@ static int vty_parse_cgi(struct vty *vty, struct gsm0808_cell_id *dst, const cha
 	return 0;
 }
 
-static int vty_parse_location(struct vty *vty, const struct gsm0808_cell_id *cell_id, const char **argv)
+static int vty_parse_location(struct vty *vty, const struct gsm0808_cell_id *cell_id, const char **argv,
+			      uint32_t radius)
 {
 	const char *lat_str = argv[0];
 	const char *lon_str = argv[1];
@@ -175,7 +362,7 @@ static int vty_parse_location(struct vty *vty, const struct gsm0808_cell_id *cel
 	}
 	lon = val;
 
-	if (cell_location_set(cell_id, lat, lon)) {
+	if (cell_location_set(cell_id, lat, lon, radius)) {
 		vty_out(vty, "%% Failed to add cell location%s", VTY_NEWLINE);
 		return CMD_WARNING;
 	}
@@ -199,7 +386,19 @@ DEFUN(cfg_cells_lac_ci, cfg_cells_lac_ci_cmd,
 	if (vty_parse_lac_ci(vty, &cell_id, argv))
 		return CMD_WARNING;
 
-	return vty_parse_location(vty, &cell_id, argv + 2);
+	return vty_parse_location(vty, &cell_id, argv + 2, 0);
+}
+
+DEFUN(cfg_cells_lac_ci_radius, cfg_cells_lac_ci_radius_cmd,
+      LAC_CI_PARAMS " " LAT_LON_PARAMS " " RADIUS_PARAMS,
+      LAC_CI_DOC LAT_LON_DOC RADIUS_DOC)
+{
+	struct gsm0808_cell_id cell_id;
+
+	if (vty_parse_lac_ci(vty, &cell_id, argv))
+		return CMD_WARNING;
+
+	return vty_parse_location(vty, &cell_id, argv + 2, atoi(argv[4]));
 }
 
 DEFUN(cfg_cells_no_lac_ci, cfg_cells_no_lac_ci_cmd,
@@ -226,7 +425,19 @@ DEFUN(cfg_cells_cgi, cfg_cells_cgi_cmd,
 	if (vty_parse_cgi(vty, &cell_id, argv))
 		return CMD_WARNING;
 
-	return vty_parse_location(vty, &cell_id, argv + 4);
+	return vty_parse_location(vty, &cell_id, argv + 4, 0);
+}
+
+DEFUN(cfg_cells_cgi_radius, cfg_cells_cgi_radius_cmd,
+      CGI_PARAMS " " LAT_LON_PARAMS " " RADIUS_PARAMS,
+      CGI_DOC LAT_LON_DOC RADIUS_DOC)
+{
+	struct gsm0808_cell_id cell_id;
+
+	if (vty_parse_cgi(vty, &cell_id, argv))
+		return CMD_WARNING;
+
+	return vty_parse_location(vty, &cell_id, argv + 4, atoi(argv[6]));
 }
 
 DEFUN(cfg_cells_no_cgi, cfg_cells_no_cgi_cmd,
@@ -244,6 +455,33 @@ DEFUN(cfg_cells_no_cgi, cfg_cells_no_cgi_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFUN(cfg_cells_database, cfg_cells_database_cmd,
+      "database PATH",
+      "Load cell locations from a database file compiled by osmo-smlc-cells-compile\n"
+      "Path of the cell database file\n")
+{
+	struct cell_db *db;
+
+	/* Verify the file right away, it is mapped again by the next cell_table */
+	if (cell_db_open(g_smlc, &db, argv[0])) {
+		vty_out(vty, "%% Cannot load cell database %s, see log output%s", argv[0], VTY_NEWLINE);
+		return CMD_WARNING;
+	}
+	talloc_free(db);
+	osmo_talloc_replace_string(g_smlc, &g_smlc->cell_db_path, argv[0]);
+	cell_table_rebuild();
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_cells_no_database, cfg_cells_no_database_cmd,
+      "no database",
+      NO_STR "Do not use a cell database file\n")
+{
+	TALLOC_FREE(g_smlc->cell_db_path);
+	cell_table_rebuild();
+	return CMD_SUCCESS;
+}
+
 /* The above are omnidirectional cells. If we add configuration sector antennae, it would add arguments to the above,
  * something like this:
  *  cgi 001 01 23 42 lat 23.23 lon 42.42 arc 270 30
@@ -260,12 +498,15 @@ static int config_write_cells(struct vty *vty)
 	struct cell_location *cell;
 	const struct osmo_cell_global_id *cgi;
 
-	if (llist_empty(&g_smlc->cell_locations))
+	if (llist_empty(&g_smlc->cell_locations->list) && !g_smlc->cell_db_path)
 		return 0;
 
 	vty_out(vty, "cells%s", VTY_NEWLINE);
 
-	llist_for_each_entry(cell, &g_smlc->cell_locations, entry) {
+	if (g_smlc->cell_db_path)
+		vty_out(vty, " database %s%s", g_smlc->cell_db_path, VTY_NEWLINE);
+
+	llist_for_each_entry(cell, &g_smlc->cell_locations->list, entry) {
 		switch (cell->cell_id.id_discr) {
 		case CELL_IDENT_LAC_AND_CI:
 			vty_out(vty, " lac-ci %u %u", cell->cell_id.id.lac_and_ci.lac, cell->cell_id.id.lac_and_ci.ci);
@@ -283,10 +524,12 @@ static int config_write_cells(struct vty *vty)
 			break;
 		}
 
-		vty_out(vty, " lat %s lon %s%s",
+		vty_out(vty, " lat %s lon %s",
 			osmo_int_to_float_str_c(OTC_SELECT, cell->lat, 6),
-			osmo_int_to_float_str_c(OTC_SELECT, cell->lon, 6),
-			VTY_NEWLINE);
+			osmo_int_to_float_str_c(OTC_SELECT, cell->lon, 6));
+		if (cell->radius)
+			vty_out(vty, " radius %u", cell->radius);
+		vty_out(vty, "%s", VTY_NEWLINE);
 	}
 
 	return 0;
@@ -296,11 +539,42 @@ DEFUN(ve_show_cells, ve_show_cells_cmd,
       "show cells",
       SHOW_STR "Show configured cell locations\n")
 {
-	if (llist_empty(&g_smlc->cell_locations)) {
+	const struct cell_table *cell_table = g_smlc->cell_table;
+
+	if (llist_empty(&g_smlc->cell_locations->list) && !g_smlc->cell_db_path) {
 		vty_out(vty, "%% No cell locations are configured%s", VTY_NEWLINE);
 		return CMD_SUCCESS;
 	}
 	config_write_cells(vty);
+	if (cell_table && cell_table->db)
+		vty_out(vty, "%% %u cell locations in database %s%s", cell_table->db->n_records,
+			cell_table->db->path, VTY_NEWLINE);
+	return CMD_SUCCESS;
+}
+
+DEFUN(ve_show_cells_table, ve_show_cells_table_cmd,
+      "show cells table",
+      SHOW_STR "Show configured cell locations\n"
+      "Show the generation of the cell table in use for location requests\n")
+{
+	const struct cell_table *cell_table = g_smlc->cell_table;
+
+	if (!cell_table) {
+		vty_out(vty, "%% No cell table%s", VTY_NEWLINE);
+		return CMD_SUCCESS;
+	}
+	vty_out(vty, "Cell table generation %u: %u configured cells, %u cells in database%s%s",
+		cell_table->gen, cell_table->cells->count, cell_table->db ? cell_table->db->n_records : 0,
+		cell_table_rebuild_pending() ? " (rebuild pending)" : "", VTY_NEWLINE);
+	return CMD_SUCCESS;
+}
+
+DEFUN(cells_reload, cells_reload_cmd,
+      "cells reload",
+      "Cell locations\n"
+      "Map the cell database file again and rebuild the cell table, without interrupting location requests\n")
+{
+	cell_table_rebuild();
 	return CMD_SUCCESS;
 }
 
@@ -309,10 +583,16 @@ int cell_locations_vty_init()
 	install_element(CONFIG_NODE, &cfg_cells_cmd);
 	install_node(&cells_node, config_write_cells);
 	install_element(CELLS_NODE, &cfg_cells_lac_ci_cmd);
+	install_element(CELLS_NODE, &cfg_cells_lac_ci_radius_cmd);
 	install_element(CELLS_NODE, &cfg_cells_no_lac_ci_cmd);
 	install_element(CELLS_NODE, &cfg_cells_cgi_cmd);
+	install_element(CELLS_NODE, &cfg_cells_cgi_radius_cmd);
 	install_element(CELLS_NODE, &cfg_cells_no_cgi_cmd);
+	install_element(CELLS_NODE, &cfg_cells_database_cmd);
+	install_element(CELLS_NODE, &cfg_cells_no_database_cmd);
 	install_element_ve(&ve_show_cells_cmd);
+	install_element_ve(&ve_show_cells_table_cmd);
+	install_element(ENABLE_NODE, &cells_reload_cmd);
 
 	return 0;
 }
@@ -0,0 +1,292 @@
+/* OsmoSMLC generations of the cell location table */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/hash.h>
+#include <osmocom/core/timer.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/rate_ctr.h>
+#include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/cell_locations.h>
+#include <osmocom/smlc/cell_db.h>
+#include <osmocom/smlc/cell_table.h>
+
+/* The cell_table being built, and the next configured cell to copy to it */
+static struct {
+	struct cell_table *next;
+	struct llist_head *pos;
+	bool restart;
+	struct osmo_timer_list timer;
+	uint32_t last_gen;
+} build;
+
+static int cell_table_use_cb(struct osmo_use_count_entry *e, int32_t old_use_count, const char *file, int line)
+{
+	struct cell_table *cell_table = e->use_count->talloc_object;
+
+	if (e->count < 0)
+		return -ERANGE;
+
+	if (!osmo_use_count_total(&cell_table->use_count)) {
+		LOGP(DSMLC, LOGL_DEBUG, "Freeing cell table generation %u\n", cell_table->gen);
+		talloc_free(cell_table);
+	}
+	return 0;
+}
+
+static struct cell_table *cell_table_alloc(void)
+{
+	struct cell_table *cell_table = talloc_zero(g_smlc, struct cell_table);
+	OSMO_ASSERT(cell_table);
+	cell_table->use_count = (struct osmo_use_count){
+		.talloc_object = cell_table,
+		.use_cb = cell_table_use_cb,
+	};
+	cell_table->cells = cell_locations_alloc(cell_table);
+	return cell_table;
+}
+
+static void cell_table_build_discard(void)
+{
+	osmo_timer_del(&build.timer);
+	talloc_free(build.next);
+	build.next = NULL;
+	build.pos = NULL;
+	build.restart = false;
+}
+
+/* Start a new cell_table: map the database file anew, so that a replaced file takes effect. */
+static int cell_table_build_start(void)
+{
+	int rc;
+
+	cell_table_build_discard();
+	build.next = cell_table_alloc();
+	build.pos = g_smlc->cell_locations->list.next;
+
+	if (g_smlc->cell_db_path) {
+		rc = cell_db_open(build.next, &build.next->db, g_smlc->cell_db_path);
+		if (rc) {
+			LOGP(DSMLC, LOGL_ERROR, "Cannot rebuild cell table, keeping generation %u\n",
+			     g_smlc->cell_table ? g_smlc->cell_table->gen : 0);
+			cell_table_build_discard();
+			return rc;
+		}
+	}
+	return 0;
+}
+
+/* Copy up to max_cells configured cells to the cell_table being built. Return true when all are copied. */
+static bool cell_table_build_step(unsigned int max_cells)
+{
+	const struct llist_head *end = &g_smlc->cell_locations->list;
+	unsigned int n;
+
+	for (n = 0; n < max_cells && build.pos != end; n++, build.pos = build.pos->next) {
+		const struct cell_location *src = llist_entry(build.pos, struct cell_location, entry);
+		struct cell_location *dst = cell_locations_add(build.next->cells, &src->cell_id);
+		dst->lat = src->lat;
+		dst->lon = src->lon;
+		dst->radius = src->radius;
+	}
+	return build.pos == end;
+}
+
+static void cell_table_publish(void)
+{
+	struct cell_table *old = g_smlc->cell_table;
+	struct cell_table *cell_table = build.next;
+
+	build.next = NULL;
+	build.pos = NULL;
+
+	cell_table->gen = ++build.last_gen;
+	cell_table_get(cell_table, CELL_TABLE_USE_CURRENT);
+	g_smlc->cell_table = cell_table;
+
+	LOGP(DSMLC, LOGL_NOTICE, "Cell table generation %u: %u configured cells, %u cells in database\n",
+	     cell_table->gen, cell_table->cells->count, cell_table->db ? cell_table->db->n_records : 0);
+
+	/* Location requests still using the previous generation keep it alive until they are done */
+	if (old)
+		cell_table_put(old, CELL_TABLE_USE_CURRENT);
+}
+
+static void cell_table_build_timer_cb(void *data)
+{
+	if (build.restart && cell_table_build_start())
+		return;
+	if (!cell_table_build_step(CELL_TABLE_BUILD_CHUNK)) {
+		/* Let the main loop serve pending requests before copying the next chunk */
+		osmo_timer_schedule(&build.timer, 0, 0);
+		return;
+	}
+	cell_table_publish();
+}
+
+/* Build a new cell_table from the current configuration, in chunks of CELL_TABLE_BUILD_CHUNK cells per main loop
+ * iteration, and publish it when complete. Until then, g_smlc->cell_table remains in use. A build in progress is
+ * discarded and starts over, so this can be called on every configuration change. */
+void cell_table_rebuild(void)
+{
+	/* Never continue copying from a list that has been modified */
+	build.pos = NULL;
+	build.restart = true;
+	osmo_timer_setup(&build.timer, cell_table_build_timer_cb, NULL);
+	osmo_timer_schedule(&build.timer, 0, 0);
+}
+
+/* Build and publish a new cell_table from the current configuration right away, e.g. after reading the config file. */
+int cell_table_rebuild_sync(void)
+{
+	int rc = cell_table_build_start();
+	if (rc)
+		return rc;
+	cell_table_build_step(UINT_MAX);
+	cell_table_publish();
+	return 0;
+}
+
+bool cell_table_rebuild_pending(void)
+{
+	return build.restart || build.next;
+}
+
+/* Find the location of a cell, from the configured cells or else the cell database. Return in *cell_idx a number that
+ * identifies the cell within this cell_table, and in *radius the configured coverage radius in meters, or 0. */
+int cell_table_find(const struct cell_table *cell_table, const struct gsm0808_cell_id *cell_id,
+		    uint32_t *cell_idx, int32_t *lat, int32_t *lon, uint32_t *radius)
+{
+	const struct cell_location *cell;
+	const struct cell_db_record *rec;
+
+	if (!cell_table)
+		return -ENOENT;
+
+	cell = cell_locations_find(cell_table->cells, cell_id);
+	if (cell) {
+		/* A cell_table is built without removing cells, so seq counts from zero */
+		*cell_idx = cell->seq;
+		*lat = cell->lat;
+		*lon = cell->lon;
+		*radius = cell->radius;
+		return 0;
+	}
+
+	if (cell_table->db && (rec = cell_db_find(cell_table->db, cell_id))) {
+		*cell_idx = cell_table->cells->next_seq + (rec - cell_table->db->records);
+		*lat = rec->lat;
+		*lon = rec->lon;
+		*radius = rec->radius;
+		return 0;
+	}
+	return -ENOENT;
+}
+
+static uint64_t cell_table_estimate_key(uint32_t cell_idx, uint8_t ta)
+{
+	return ((uint64_t)cell_idx << 8) | ta;
+}
+
+static struct cell_table_estimate *cell_table_estimate_slot(struct cell_table *cell_table, uint64_t key)
+{
+	return &cell_table->estimates[hash_64(key, CELL_TABLE_ESTIMATES_BITS)];
+}
+
+/* Look up a cached Location Estimate for a cell and TA, as returned by cell_table_find() and added by
+ * cell_table_estimate_add(). Return true and the encoded and decoded estimate on a cache hit. */
+bool cell_table_estimate_cached(struct cell_table *cell_table, uint32_t cell_idx, uint8_t ta,
+				union gad_raw *location_estimate, struct osmo_gad *location)
+{
+	struct cell_table_estimate *e;
+	uint64_t key = cell_table_estimate_key(cell_idx, ta);
+
+	if (cell_table->estimates) {
+		e = cell_table_estimate_slot(cell_table, key);
+		if (e->len && e->key == key) {
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_ESTIMATE_CACHE_HIT]);
+			memcpy(location_estimate, e->raw, e->len);
+			*location = (struct osmo_gad){
+				.type = GAD_TYPE_ELL_POINT_UNC_CIRCLE,
+				.ell_point_unc_circle = e->location,
+			};
+			return true;
+		}
+	}
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_ESTIMATE_CACHE_MISS]);
+	return false;
+}
+
+/* Remember a Location Estimate of len encoded bytes for a cell and TA, replacing whichever estimate was in its slot */
+void cell_table_estimate_add(struct cell_table *cell_table, uint32_t cell_idx, uint8_t ta,
+			     const union gad_raw *location_estimate, unsigned int len, const struct osmo_gad *location)
+{
+	struct cell_table_estimate *e;
+
+	if (!len || len > sizeof(e->raw) || location->type != GAD_TYPE_ELL_POINT_UNC_CIRCLE)
+		return;
+
+	if (!cell_table->estimates) {
+		cell_table->estimates = talloc_zero_array(cell_table, struct cell_table_estimate,
+							  CELL_TABLE_ESTIMATES_SIZE);
+		OSMO_ASSERT(cell_table->estimates);
+	}
+
+	e = cell_table_estimate_slot(cell_table, cell_table_estimate_key(cell_idx, ta));
+	e->key = cell_table_estimate_key(cell_idx, ta);
+	e->location = location->ell_point_unc_circle;
+	e->len = len;
+	memcpy(e->raw, location_estimate, len);
+}
+
+/* Compose the encoded Location Estimate for a cell and TA to send in a Perform Location Response, and the decoded
+ * location for logging. Encode only once per cell and TA, later calls copy the cached result.
+ * Return 0 on success, -ENOENT if there is no location for the cell, or another negative error on encoding failure. */
+int cell_table_location_estimate(struct cell_table *cell_table, union gad_raw *location_estimate,
+				 struct osmo_gad *location, const struct gsm0808_cell_id *cell_id, uint8_t ta)
+{
+	uint32_t cell_idx;
+	int32_t lat, lon;
+	uint32_t radius;
+	int rc;
+
+	rc = cell_table_find(cell_table, cell_id, &cell_idx, &lat, &lon, &radius);
+	if (rc)
+		return rc;
+
+	if (cell_table_estimate_cached(cell_table, cell_idx, ta, location_estimate, location))
+		return 0;
+
+	cell_location_estimate_from_ta(location, lat, lon, ta);
+	rc = osmo_gad_enc(location_estimate, location);
+	if (rc <= 0)
+		return rc ? : -EINVAL;
+
+	cell_table_estimate_add(cell_table, cell_idx, ta, location_estimate, rc, location);
+	return 0;
+}
@@ -0,0 +1,277 @@
+/* Compile cell locations to a cell database file for OsmoSMLC */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* Input is either the 'cells' section of an osmo-smlc.cfg, i.e. lines like
+ *   cgi 001 01 23 42 lat 23.23 lon 42.42
+ *   lac-ci 23 42 lat 23.23 lon 42.42 radius 3000
+ * or CSV lines like
+ *   mcc,mnc,lac,ci,lat,lon[,radius]
+ * where an empty MCC and MNC makes a LAC-CI entry. The radius is optional in both.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/gsm/gsm23003.h>
+#include <osmocom/gsm/protocol/gsm_08_08.h>
+#include <osmocom/smlc/cell_db.h>
+
+enum input_format {
+	INPUT_AUTO,
+	INPUT_VTY,
+	INPUT_CSV,
+};
+
+static struct cell_db_record *records;
+static uint32_t n_records;
+static uint32_t records_size;
+
+static void print_help(const char *argv0)
+{
+	printf("Usage: %s [-f vty|csv] INPUT-FILE DB-FILE\n"
+	       "Compile cell locations to a database file, for the 'cells' / 'database' option of osmo-smlc.\n"
+	       "\n"
+	       "  -h --help           This text.\n"
+	       "  -f --format FORMAT  Input format: 'vty' for 'cgi' and 'lac-ci' lines as in the 'cells' config node,\n"
+	       "                      'csv' for 'mcc,mnc,lac,ci,lat,lon[,radius]' lines. Default: 'csv' if INPUT-FILE\n"
+	       "                      ends in '.csv', 'vty' otherwise.\n",
+	       argv0);
+}
+
+static int parse_u16(uint16_t *dst, const char *str)
+{
+	int val;
+	if (osmo_str_to_int(&val, str, 10, 0, 65535))
+		return -EINVAL;
+	*dst = val;
+	return 0;
+}
+
+static int parse_radius(uint32_t *dst, const char *str)
+{
+	int val;
+	/* Same range as 'radius <1-100000>' on the 'cells' node */
+	if (osmo_str_to_int(&val, str, 10, 1, 100000))
+		return -EINVAL;
+	*dst = val;
+	return 0;
+}
+
+static int parse_coord(int32_t *dst, const char *str, int64_t limit)
+{
+	int64_t val;
+	if (osmo_float_str_to_int(&val, str, 6) || val < -limit || val > limit)
+		return -EINVAL;
+	*dst = val;
+	return 0;
+}
+
+static int add_record(const char *mcc, const char *mnc, const char *lac, const char *ci,
+		      const char *lat, const char *lon, const char *radius)
+{
+	struct cell_db_record rec = {
+		.id_discr = CELL_IDENT_LAC_AND_CI,
+		.seq = n_records,
+	};
+	bool mnc_3_digits;
+
+	if (mcc || mnc) {
+		rec.id_discr = CELL_IDENT_WHOLE_GLOBAL;
+		if (!mcc || !mnc || osmo_mcc_from_str(mcc, &rec.mcc)
+		    || osmo_mnc_from_str(mnc, &rec.mnc, &mnc_3_digits))
+			return -EINVAL;
+		rec.mnc_3_digits = mnc_3_digits;
+	}
+	if (parse_u16(&rec.lac, lac) || parse_u16(&rec.ci, ci)
+	    || parse_coord(&rec.lat, lat, 90000000)
+	    || parse_coord(&rec.lon, lon, 180000000)
+	    || (radius && parse_radius(&rec.radius, radius)))
+		return -EINVAL;
+
+	if (n_records == records_size) {
+		records_size = records_size ? records_size * 2 : 1024;
+		records = talloc_realloc(NULL, records, struct cell_db_record, records_size);
+		OSMO_ASSERT(records);
+	}
+	records[n_records++] = rec;
+	return 0;
+}
+
+#define MAX_TOKENS 11
+
+static int tokenize(char *line, char **tok, const char *delim, bool keep_empty)
+{
+	int n = 0;
+	char *t;
+	while ((t = strsep(&line, delim))) {
+		if (!keep_empty && !*t)
+			continue;
+		if (n == MAX_TOKENS)
+			return -1;
+		tok[n++] = t;
+	}
+	return n;
+}
+
+static int parse_vty_line(char *line)
+{
+	char *tok[MAX_TOKENS];
+	char *radius = NULL;
+	int n = tokenize(line, tok, " \t", false);
+
+	if (n == 0 || tok[0][0] == '!' || tok[0][0] == '#' || !strcmp(tok[0], "cells"))
+		return 0;
+
+	/* Strip an optional trailing 'radius N' */
+	if (n >= 2 && !strcmp(tok[n - 2], "radius")) {
+		radius = tok[n - 1];
+		n -= 2;
+	}
+
+	if (n == 9 && !strcmp(tok[0], "cgi") && !strcmp(tok[5], "lat") && !strcmp(tok[7], "lon"))
+		return add_record(tok[1], tok[2], tok[3], tok[4], tok[6], tok[8], radius);
+	if (n == 7 && !strcmp(tok[0], "lac-ci") && !strcmp(tok[3], "lat") && !strcmp(tok[5], "lon"))
+		return add_record(NULL, NULL, tok[1], tok[2], tok[4], tok[6], radius);
+	return -EINVAL;
+}
+
+static char *strip(char *str)
+{
+	char *end;
+	while (*str == ' ' || *str == '\t' || *str == '"')
+		str++;
+	end = str + strlen(str);
+	while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '"'))
+		*(--end) = '\0';
+	return str;
+}
+
+static int parse_csv_line(char *line)
+{
+	char *tok[MAX_TOKENS];
+	int n;
+	int i;
+
+	if (!*line || line[0] == '#')
+		return 0;
+
+	n = tokenize(line, tok, ",", true);
+	if (n != 6 && n != 7)
+		return -EINVAL;
+	for (i = 0; i < n; i++)
+		tok[i] = strip(tok[i]);
+
+	/* Skip a header line */
+	if (n_records == 0 && !strcmp(tok[0], "mcc"))
+		return 0;
+
+	return add_record(*tok[0] ? tok[0] : NULL, *tok[1] ? tok[1] : NULL, tok[2], tok[3], tok[4], tok[5],
+			  (n == 7 && *tok[6]) ? tok[6] : NULL);
+}
+
+int main(int argc, char **argv)
+{
+	enum input_format format = INPUT_AUTO;
+	const char *in_path;
+	const char *out_path;
+	char line[1024];
+	unsigned int line_nr = 0;
+	uint32_t n_written;
+	FILE *in;
+	int rc;
+
+	while (1) {
+		int option_index = 0, c;
+		static struct option long_options[] = {
+			{"help", 0, 0, 'h'},
+			{"format", 1, 0, 'f'},
+			{0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "hf:", long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case 'h':
+			print_help(argv[0]);
+			return 0;
+		case 'f':
+			if (!strcmp(optarg, "vty"))
+				format = INPUT_VTY;
+			else if (!strcmp(optarg, "csv"))
+				format = INPUT_CSV;
+			else {
+				fprintf(stderr, "Unknown input format: %s\n", optarg);
+				return 1;
+			}
+			break;
+		default:
+			print_help(argv[0]);
+			return 1;
+		}
+	}
+
+	if (argc - optind != 2) {
+		print_help(argv[0]);
+		return 1;
+	}
+	in_path = argv[optind];
+	out_path = argv[optind + 1];
+
+	if (format == INPUT_AUTO) {
+		size_t len = strlen(in_path);
+		format = (len > 4 && !strcasecmp(in_path + len - 4, ".csv")) ? INPUT_CSV : INPUT_VTY;
+	}
+
+	in = strcmp(in_path, "-") ? fopen(in_path, "r") : stdin;
+	if (!in) {
+		fprintf(stderr, "Cannot open %s: %s\n", in_path, strerror(errno));
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), in)) {
+		line_nr++;
+		line[strcspn(line, "\r\n")] = '\0';
+		rc = (format == INPUT_CSV) ? parse_csv_line(line) : parse_vty_line(line);
+		if (rc) {
+			fprintf(stderr, "%s:%u: invalid cell location\n", in_path, line_nr);
+			return 1;
+		}
+	}
+	if (in != stdin)
+		fclose(in);
+
+	rc = cell_db_write(out_path, records, n_records, &n_written);
+	if (rc) {
+		fprintf(stderr, "Cannot write %s: %s\n", out_path, strerror(-rc));
+		return 1;
+	}
+	printf("Wrote %u cell locations to %s\n", n_written, out_path);
+	return 0;
+}
@@ -0,0 +1,145 @@
+/* OsmoSMLC SCCP connection ID allocation */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <errno.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/smlc/conn_ids.h>
+
+/* Number of bits on a level: 2^24, 2^18, 2^12, 2^6 */
+#define LEVEL_BITS(level) (1 << (CONN_IDS_BITS - 6 * (level)))
+
+osmo_static_assert(LEVEL_BITS(CONN_IDS_LEVELS - 1) == 64, conn_ids_top_level_is_one_word);
+
+struct conn_ids *conn_ids_alloc(void *ctx)
+{
+	struct conn_ids *ids = talloc_zero(ctx, struct conn_ids);
+	int level;
+	OSMO_ASSERT(ids);
+	for (level = 0; level < CONN_IDS_LEVELS; level++) {
+		ids->used[level] = talloc_zero_array(ids, uint64_t, LEVEL_BITS(level) / 64);
+		OSMO_ASSERT(ids->used[level]);
+	}
+	ids->next = 1;
+	/* Never hand out conn_id 0 */
+	conn_ids_claim(ids, 0);
+	ids->count = 0;
+	return ids;
+}
+
+static bool bit_is_set(const uint64_t *words, uint32_t bit)
+{
+	return words[bit / 64] & (1ULL << (bit % 64));
+}
+
+/* Return the first index >= pos that has a zero bit on the given level, or -1 if there is none. Each level is
+ * visited at most once on the way up and once on the way down. */
+static int64_t find_unused(const struct conn_ids *ids, int level, uint32_t pos)
+{
+	const uint64_t *words = ids->used[level];
+	uint32_t word = pos / 64;
+	uint64_t unused;
+	int64_t next_word;
+
+	if (pos >= LEVEL_BITS(level))
+		return -1;
+
+	unused = ~words[word] & (~0ULL << (pos % 64));
+	if (unused)
+		return (int64_t)word * 64 + __builtin_ctzll(unused);
+
+	if (level == CONN_IDS_LEVELS - 1)
+		return -1;
+
+	/* Find the next word on this level that is not full */
+	next_word = find_unused(ids, level + 1, word + 1);
+	if (next_word < 0)
+		return -1;
+	return next_word * 64 + __builtin_ctzll(~words[next_word]);
+}
+
+/* Mark an unused conn_id as used, and pick the next unused ID starting from the last one handed out, wrapping around
+ * once. Return the conn_id, or -ENOSPC if all IDs are in use. */
+int conn_ids_next(struct conn_ids *ids)
+{
+	int64_t conn_id = find_unused(ids, 0, ids->next);
+	if (conn_id < 0)
+		conn_id = find_unused(ids, 0, 1);
+	if (conn_id < 0)
+		return -ENOSPC;
+	OSMO_ASSERT(conn_ids_claim(ids, conn_id) == 0);
+	ids->next = (conn_id + 1) & CONN_IDS_MAX;
+	return conn_id;
+}
+
+/* Mark a given conn_id as used, e.g. one assigned by the SCCP stack to an incoming connection.
+ * Return -EEXIST if it is already in use. */
+int conn_ids_claim(struct conn_ids *ids, uint32_t conn_id)
+{
+	uint32_t bit = conn_id;
+	int level;
+
+	if (conn_id > CONN_IDS_MAX)
+		return -ERANGE;
+	if (bit_is_set(ids->used[0], conn_id))
+		return -EEXIST;
+
+	for (level = 0; level < CONN_IDS_LEVELS; level++) {
+		uint64_t *word = &ids->used[level][bit / 64];
+		*word |= 1ULL << (bit % 64);
+		/* Only when this word became full, mark it on the level above */
+		if (*word != ~0ULL)
+			break;
+		bit /= 64;
+	}
+	ids->count++;
+	return 0;
+}
+
+void conn_ids_release(struct conn_ids *ids, uint32_t conn_id)
+{
+	uint32_t bit = conn_id;
+	int level;
+
+	if (conn_id > CONN_IDS_MAX || !conn_id || !bit_is_set(ids->used[0], conn_id))
+		return;
+
+	for (level = 0; level < CONN_IDS_LEVELS; level++) {
+		uint64_t *word = &ids->used[level][bit / 64];
+		bool was_full = (*word == ~0ULL);
+		*word &= ~(1ULL << (bit % 64));
+		/* Only when this word was full, it is marked on the level above */
+		if (!was_full)
+			break;
+		bit /= 64;
+	}
+	ids->count--;
+}
+
+bool conn_ids_in_use(const struct conn_ids *ids, uint32_t conn_id)
+{
+	if (conn_id > CONN_IDS_MAX)
+		return false;
+	return bit_is_set(ids->used[0], conn_id);
+}
@@ -30,6 +30,7 @@
 
 #include <osmocom/smlc/debug.h>
 #include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/conn_ids.h>
 #include <osmocom/smlc/sccp_lb_inst.h>
 #include <osmocom/smlc/lb_peer.h>
 #include <osmocom/smlc/lb_conn.h>
@@ -67,20 +68,25 @@ static int lb_conn_use_cb(struct osmo_use_count_entry *e, int32_t old_use_count,
 static struct lb_conn *lb_conn_alloc(struct lb_peer *lb_peer, uint32_t sccp_conn_id, const char *use_token)
 {
 	struct lb_conn *lb_conn;
+	void *pool_chunk = smlc_pool_get(g_smlc->lb_conn_pool);
 
-	lb_conn = talloc(lb_peer, struct lb_conn);
+	lb_conn = talloc(pool_chunk ? : lb_peer, struct lb_conn);
 	OSMO_ASSERT(lb_conn);
 
 	*lb_conn = (struct lb_conn){
 		.lb_peer = lb_peer,
 		.sccp_conn_id = sccp_conn_id,
+		.pool_chunk = pool_chunk,
 		.use_count = {
 			.talloc_object = lb_conn,
 			.use_cb = lb_conn_use_cb,
 		},
 	};
 
-	llist_add(&lb_conn->entry, &lb_peer->sli->lb_conns);
+	INIT_LLIST_HEAD(&lb_conn->loc_req_queue);
+	llist_add(&lb_conn->entry, &lb_peer->lb_conns);
+	hash_add(lb_peer->sli->lb_conns_by_conn_id, &lb_conn->hnode, sccp_conn_id);
+	g_smlc->lb_conns_count++;
 	lb_conn_get(lb_conn, use_token);
 	return lb_conn;
 }
@@ -88,26 +94,39 @@ static struct lb_conn *lb_conn_alloc(struct lb_peer *lb_peer, uint32_t sccp_conn
 struct lb_conn *lb_conn_create_incoming(struct lb_peer *lb_peer, uint32_t sccp_conn_id, const char *use_token)
 {
 	LOG_LB_PEER(lb_peer, LOGL_DEBUG, "Incoming lb_conn id: %u\n", sccp_conn_id);
+	if (conn_ids_claim(lb_peer->sli->conn_ids, sccp_conn_id)) {
+		LOG_LB_PEER(lb_peer, LOGL_ERROR, "Incoming lb_conn id %u is already in use\n", sccp_conn_id);
+		return NULL;
+	}
 	return lb_conn_alloc(lb_peer, sccp_conn_id, use_token);
 }
 
 struct lb_conn *lb_conn_create_outgoing(struct lb_peer *lb_peer, const char *use_token)
 {
-	int new_conn_id = sccp_lb_inst_next_conn_id();
-	if (new_conn_id < 0)
+	int new_conn_id = sccp_lb_inst_next_conn_id(lb_peer->sli);
+	if (new_conn_id < 0) {
+		LOG_LB_PEER(lb_peer, LOGL_ERROR, "No unused SCCP conn_id left\n");
 		return NULL;
+	}
 	LOG_LB_PEER(lb_peer, LOGL_DEBUG, "Outgoing lb_conn id: %u\n", new_conn_id);
 	return lb_conn_alloc(lb_peer, new_conn_id, use_token);
 }
 
 struct lb_conn *lb_conn_find_by_smlc_subscr(struct smlc_subscr *smlc_subscr, const char *use_token)
+{
+	struct lb_conn *lb_conn = smlc_subscr->lb_conn;
+	if (lb_conn)
+		lb_conn_get(lb_conn, use_token);
+	return lb_conn;
+}
+
+/* Return the lb_conn of an SCCP connection, without getting a use count */
+struct lb_conn *lb_conn_find_by_sccp_conn_id(struct sccp_lb_inst *sli, uint32_t sccp_conn_id)
 {
 	struct lb_conn *lb_conn;
-	llist_for_each_entry(lb_conn, &g_smlc->lb->lb_conns, entry) {
-		if (lb_conn->smlc_subscr == smlc_subscr) {
-			lb_conn_get(lb_conn, use_token);
+	hash_for_each_possible(sli->lb_conns_by_conn_id, lb_conn, hnode, sccp_conn_id) {
+		if (lb_conn->sccp_conn_id == sccp_conn_id)
 			return lb_conn;
-		}
 	}
 	return NULL;
 }
@@ -131,6 +150,7 @@ int lb_conn_rx(struct lb_conn *lb_conn, struct msgb *msg, bool initial)
 	struct bssap_le_pdu bssap_le;
 	struct osmo_bssap_le_err *err;
 	if (osmo_bssap_le_dec(&bssap_le, &err, msg, msg)) {
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_DT1_ERR_INVALID_MSG]);
 		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Rx BSSAP-LE with error: %s\n", err->logmsg);
 		return -EINVAL;
 	}
@@ -140,30 +160,78 @@ int lb_conn_rx(struct lb_conn *lb_conn, struct msgb *msg, bool initial)
 
 int lb_conn_send_bssmap_le(struct lb_conn *lb_conn, const struct bssmap_le_pdu *bssmap_le)
 {
-	struct msgb *msg;
+	struct msgb *msg = NULL;
+	bool from_tmpl;
 	int rc;
 	struct bssap_le_pdu bssap_le = {
 		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
 		.bssmap_le = *bssmap_le,
 	};
 
-	msg = osmo_bssap_le_enc(&bssap_le);
+	/* Perform Location Responses dominate the Lb traffic, compose them in the msgb pool where possible */
+	if (bssmap_le->msg_type == BSSMAP_LE_MSGT_PERFORM_LOC_RESP)
+		msg = lb_msgb_perform_loc_resp(g_smlc->lb_msgb_pool, &bssmap_le->perform_loc_resp);
+	from_tmpl = msg;
+	if (!msg)
+		msg = osmo_bssap_le_enc(&bssap_le);
 	if (!msg) {
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_TX_ERR_INVALID_MSG]);
 		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to encode %s\n",
 			    osmo_bssap_le_pdu_to_str_c(OTC_SELECT, &bssap_le));
 		return -EINVAL;
 	}
 	rc = lb_conn_down_l2_co(lb_conn, msg, false);
-	msgb_free(msg);
-	if (rc)
+	lb_msgb_free(g_smlc->lb_msgb_pool, msg);
+	if (rc) {
 		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to send %s\n",
 			    osmo_bssap_le_pdu_to_str_c(OTC_SELECT, &bssap_le));
-	return rc;
+		return rc;
+	}
+	rate_ctr_inc(&g_smlc->ctrs->ctr[from_tmpl ? SMLC_CTR_BSSAP_LE_TX_TEMPLATE : SMLC_CTR_BSSAP_LE_TX_ENCODED]);
+
+	switch (bssmap_le->msg_type) {
+	case BSSMAP_LE_MSGT_PERFORM_LOC_RESP:
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_TX_DT1_PERFORM_LOCATION_RESPONSE]);
+		break;
+	case BSSMAP_LE_MSGT_CONN_ORIENTED_INFO:
+		if (bssmap_le->conn_oriented_info.apdu.msg_type == BSSLAP_MSGT_TA_REQUEST)
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_TX_DT1_BSSLAP_TA_REQUEST]);
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+/* Send a constant message from the lb_msgb template cache, without running the BSSAP-LE encoder. */
+int lb_conn_send_tmpl(struct lb_conn *lb_conn, enum lb_msgb_tmpl tmpl)
+{
+	struct msgb *msg;
+	int rc;
+
+	msg = lb_msgb_tmpl(g_smlc->lb_msgb_pool, tmpl);
+	if (!msg) {
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_TX_ERR_INVALID_MSG]);
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to compose %s\n", get_value_string(lb_msgb_tmpl_names, tmpl));
+		return -EINVAL;
+	}
+	rc = lb_conn_down_l2_co(lb_conn, msg, false);
+	lb_msgb_free(g_smlc->lb_msgb_pool, msg);
+	if (rc) {
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to send %s\n", get_value_string(lb_msgb_tmpl_names, tmpl));
+		return rc;
+	}
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSAP_LE_TX_TEMPLATE]);
+
+	if (tmpl == LB_MSGB_TMPL_TA_REQUEST)
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_TX_DT1_BSSLAP_TA_REQUEST]);
+	return 0;
 }
 
 /* Regularly close the lb_conn */
 void lb_conn_close(struct lb_conn *lb_conn)
 {
+	void *pool_chunk;
 	if (!lb_conn)
 		return;
 	if (lb_conn->closing)
@@ -180,11 +248,19 @@ void lb_conn_close(struct lb_conn *lb_conn)
 	if (lb_conn->smlc_loc_req)
 		osmo_fsm_inst_term(lb_conn->smlc_loc_req->fi, OSMO_FSM_TERM_REGULAR, NULL);
 
-	if (lb_conn->smlc_subscr)
+	if (lb_conn->smlc_subscr) {
+		if (lb_conn->smlc_subscr->lb_conn == lb_conn)
+			lb_conn->smlc_subscr->lb_conn = NULL;
 		smlc_subscr_put(lb_conn->smlc_subscr, SMLC_SUBSCR_USE_LB_CONN);
+	}
 
+	conn_ids_release(g_smlc->lb->conn_ids, lb_conn->sccp_conn_id);
+	hash_del(&lb_conn->hnode);
 	llist_del(&lb_conn->entry);
+	g_smlc->lb_conns_count--;
+	pool_chunk = lb_conn->pool_chunk;
 	talloc_free(lb_conn);
+	smlc_pool_put(g_smlc->lb_conn_pool, pool_chunk);
 }
 
 /* Same as lb_conn_close() but without sending any SCCP messages (e.g. after RESET) */
@@ -0,0 +1,265 @@
+/* OsmoSMLC msgb allocation for the Lb interface, and pre-encoded constant messages */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <osmocom/core/msgb.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/gsm/bssmap_le.h>
+#include <osmocom/gsm/bsslap.h>
+#include <osmocom/gsm/gad.h>
+#include <osmocom/gsm/gsm0808.h>
+
+#include <osmocom/smlc/lb_msgb.h>
+
+const struct value_string lb_msgb_tmpl_names[] = {
+	{ LB_MSGB_TMPL_TA_REQUEST, "BSSLAP TA Request" },
+	{ LB_MSGB_TMPL_RESET, "BSSMAP-LE Reset" },
+	{ LB_MSGB_TMPL_RESET_ACK, "BSSMAP-LE Reset Acknowledge" },
+	{}
+};
+
+static const struct bssap_le_pdu lb_msgb_tmpl_pdus[_NUM_LB_MSGB_TMPL] = {
+	[LB_MSGB_TMPL_TA_REQUEST] = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = {
+			.msg_type = BSSMAP_LE_MSGT_CONN_ORIENTED_INFO,
+			.conn_oriented_info = {
+				.apdu = {
+					.msg_type = BSSLAP_MSGT_TA_REQUEST,
+				},
+			},
+		},
+	},
+	[LB_MSGB_TMPL_RESET] = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = {
+			.msg_type = BSSMAP_LE_MSGT_RESET,
+			.reset = GSM0808_CAUSE_EQUIPMENT_FAILURE,
+		},
+	},
+	[LB_MSGB_TMPL_RESET_ACK] = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = {
+			.msg_type = BSSMAP_LE_MSGT_RESET_ACK,
+		},
+	},
+};
+
+/* Each template is encoded on first use, and only copied from then on */
+static struct {
+	uint16_t len;
+	uint8_t data[LB_MSGB_TMPL_MAX_LEN];
+} lb_msgb_tmpls[_NUM_LB_MSGB_TMPL];
+
+/* A Perform Location Response that carries only a Location Estimate is the BSSAP-LE discriminator and length, the
+ * message type, the IEI and IE length, followed by the raw GAD octets. For each GAD shape, these five octets are taken
+ * from the encoder once, and the estimate is copied in behind them from then on. */
+#define LB_MSGB_LOC_RESP_HDR_LEN 5
+static struct {
+	/* 0: not taken from the encoder yet, 1: usable, -1: leave this shape to the encoder */
+	int8_t state;
+	uint8_t est_len;
+	uint8_t hdr[LB_MSGB_LOC_RESP_HDR_LEN];
+} lb_msgb_loc_resp_est[16];
+
+/* A Perform Location Response that carries only an LCS Cause without diagnostic value is constant for each cause */
+#define LB_MSGB_LOC_RESP_CAUSES 16
+static struct {
+	int8_t state;
+	uint8_t len;
+	uint8_t data[LB_MSGB_TMPL_MAX_LEN];
+} lb_msgb_loc_resp_cause[LB_MSGB_LOC_RESP_CAUSES];
+
+/* Allocate a msgb for a BSSAP-LE message of up to len octets, with headroom for the osmo_scu_prim. The data starts at an
+ * 8 byte boundary, so that msgb_pad_mod8() in sccp_lb_down_l2_*() does not need to pad. The msgb is placed in a chunk of
+ * pool if one is available, so that sending does not call malloc(). Free it with lb_msgb_free(). pool may be NULL. */
+struct msgb *lb_msgb_alloc(struct smlc_pool *pool, uint16_t len, const char *name)
+{
+	void *pool_chunk = NULL;
+	uint16_t size = LB_MSGB_HEADROOM + 8 + len;
+	struct msgb *msg;
+	uintptr_t data;
+
+	if (pool && len <= LB_MSGB_POOL_MAX_LEN)
+		pool_chunk = smlc_pool_get(pool);
+
+	msg = pool_chunk ? msgb_alloc_c(pool_chunk, size, name) : msgb_alloc(size, name);
+	if (!msg) {
+		smlc_pool_put(pool, pool_chunk);
+		return NULL;
+	}
+	data = (uintptr_t)msg->data + LB_MSGB_HEADROOM;
+	msgb_reserve(msg, LB_MSGB_HEADROOM + (8 - data % 8) % 8);
+	return msg;
+}
+
+/* Free a msgb from lb_msgb_alloc(), and hand its chunk back to the pool. Also takes any other msgb, e.g. one returned
+ * by osmo_bssap_le_enc(). */
+void lb_msgb_free(struct smlc_pool *pool, struct msgb *msg)
+{
+	void *parent;
+
+	if (!msg)
+		return;
+	/* A chunk holds only this msgb, and every chunk is a talloc child of the pool itself */
+	parent = pool ? talloc_parent(msg) : NULL;
+	if (parent && talloc_parent(parent) != pool)
+		parent = NULL;
+	msgb_free(msg);
+	smlc_pool_put(pool, parent);
+}
+
+static int lb_msgb_tmpl_encode(enum lb_msgb_tmpl tmpl)
+{
+	struct msgb *msg = osmo_bssap_le_enc(&lb_msgb_tmpl_pdus[tmpl]);
+
+	if (!msg)
+		return -EINVAL;
+	OSMO_ASSERT(msg->len <= sizeof(lb_msgb_tmpls[tmpl].data));
+	memcpy(lb_msgb_tmpls[tmpl].data, msg->data, msg->len);
+	lb_msgb_tmpls[tmpl].len = msg->len;
+	msgb_free(msg);
+	return 0;
+}
+
+/* Return a new msgb holding the encoded template, ready for sccp_lb_down_l2_*(). Free it with lb_msgb_free(). */
+struct msgb *lb_msgb_tmpl(struct smlc_pool *pool, enum lb_msgb_tmpl tmpl)
+{
+	struct msgb *msg;
+
+	OSMO_ASSERT(tmpl < _NUM_LB_MSGB_TMPL);
+	if (!lb_msgb_tmpls[tmpl].len && lb_msgb_tmpl_encode(tmpl))
+		return NULL;
+
+	msg = lb_msgb_alloc(pool, lb_msgb_tmpls[tmpl].len, lb_msgb_tmpl_names[tmpl].str);
+	if (!msg)
+		return NULL;
+	memcpy(msgb_put(msg, lb_msgb_tmpls[tmpl].len), lb_msgb_tmpls[tmpl].data, lb_msgb_tmpls[tmpl].len);
+	return msg;
+}
+
+static struct msgb *lb_msgb_loc_resp_enc(const struct bssmap_le_perform_loc_resp *resp)
+{
+	struct bssap_le_pdu pdu = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = {
+			.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
+			.perform_loc_resp = *resp,
+		},
+	};
+	return osmo_bssap_le_enc(&pdu);
+}
+
+static void lb_msgb_loc_resp_est_learn(const struct bssmap_le_perform_loc_resp *resp)
+{
+	uint8_t type = resp->location_estimate.h.type;
+	struct msgb *msg;
+	int est_len;
+
+	lb_msgb_loc_resp_est[type].state = -1;
+	/* A polygon's length depends on its number of points */
+	if (type == GAD_TYPE_POLYGON)
+		return;
+	msg = lb_msgb_loc_resp_enc(resp);
+	if (!msg)
+		return;
+	/* Only use the header if the encoder wrote the layout described above */
+	est_len = msg->len - LB_MSGB_LOC_RESP_HDR_LEN;
+	if (est_len > 0 && est_len <= sizeof(resp->location_estimate)
+	    && msg->data[1] == msg->len - 2
+	    && msg->data[LB_MSGB_LOC_RESP_HDR_LEN - 1] == est_len
+	    && !memcmp(msg->data + LB_MSGB_LOC_RESP_HDR_LEN, &resp->location_estimate, est_len)) {
+		memcpy(lb_msgb_loc_resp_est[type].hdr, msg->data, LB_MSGB_LOC_RESP_HDR_LEN);
+		lb_msgb_loc_resp_est[type].est_len = est_len;
+		lb_msgb_loc_resp_est[type].state = 1;
+	}
+	msgb_free(msg);
+}
+
+static void lb_msgb_loc_resp_cause_learn(enum lcs_cause cause)
+{
+	const struct bssmap_le_perform_loc_resp resp = {
+		.lcs_cause = {
+			.present = true,
+			.cause_val = cause,
+		},
+	};
+	struct msgb *msg = lb_msgb_loc_resp_enc(&resp);
+
+	lb_msgb_loc_resp_cause[cause].state = -1;
+	if (!msg)
+		return;
+	if (msg->len <= sizeof(lb_msgb_loc_resp_cause[cause].data)) {
+		memcpy(lb_msgb_loc_resp_cause[cause].data, msg->data, msg->len);
+		lb_msgb_loc_resp_cause[cause].len = msg->len;
+		lb_msgb_loc_resp_cause[cause].state = 1;
+	}
+	msgb_free(msg);
+}
+
+/* Return a new msgb holding the BSSAP-LE Perform Location Response for resp, composed from the template cache without
+ * running the encoder. Return NULL if resp has a form that is not cached, e.g. both a Location Estimate and an LCS
+ * Cause; the caller then runs osmo_bssap_le_enc(). Free it with lb_msgb_free(). */
+struct msgb *lb_msgb_perform_loc_resp(struct smlc_pool *pool, const struct bssmap_le_perform_loc_resp *resp)
+{
+	struct msgb *msg;
+
+	if (resp->location_estimate_present && !resp->lcs_cause.present) {
+		uint8_t type = resp->location_estimate.h.type;
+
+		if (!lb_msgb_loc_resp_est[type].state)
+			lb_msgb_loc_resp_est_learn(resp);
+		if (lb_msgb_loc_resp_est[type].state < 0)
+			return NULL;
+
+		msg = lb_msgb_alloc(pool, LB_MSGB_LOC_RESP_HDR_LEN + lb_msgb_loc_resp_est[type].est_len,
+				    "Perform Location Response");
+		if (!msg)
+			return NULL;
+		memcpy(msgb_put(msg, LB_MSGB_LOC_RESP_HDR_LEN), lb_msgb_loc_resp_est[type].hdr, LB_MSGB_LOC_RESP_HDR_LEN);
+		memcpy(msgb_put(msg, lb_msgb_loc_resp_est[type].est_len), &resp->location_estimate,
+		       lb_msgb_loc_resp_est[type].est_len);
+		return msg;
+	}
+
+	if (!resp->location_estimate_present && resp->lcs_cause.present && !resp->lcs_cause.diag_val_present
+	    && resp->lcs_cause.cause_val < LB_MSGB_LOC_RESP_CAUSES) {
+		enum lcs_cause cause = resp->lcs_cause.cause_val;
+
+		if (!lb_msgb_loc_resp_cause[cause].state)
+			lb_msgb_loc_resp_cause_learn(cause);
+		if (lb_msgb_loc_resp_cause[cause].state < 0)
+			return NULL;
+
+		msg = lb_msgb_alloc(pool, lb_msgb_loc_resp_cause[cause].len, "Perform Location Response");
+		if (!msg)
+			return NULL;
+		memcpy(msgb_put(msg, lb_msgb_loc_resp_cause[cause].len), lb_msgb_loc_resp_cause[cause].data,
+		       lb_msgb_loc_resp_cause[cause].len);
+		return msg;
+	}
+
+	return NULL;
+}
@@ -23,12 +23,15 @@
 #include <osmocom/core/linuxlist.h>
 #include <osmocom/core/logging.h>
 #include <osmocom/core/fsm.h>
+#include <osmocom/core/stats.h>
+#include <osmocom/core/stat_item.h>
 #include <osmocom/gsm/bssmap_le.h>
 #include <osmocom/sigtran/sccp_helpers.h>
 
 #include <osmocom/smlc/smlc_data.h>
 #include <osmocom/smlc/sccp_lb_inst.h>
 #include <osmocom/smlc/lb_peer.h>
+#include <osmocom/smlc/lb_msgb.h>
 
 static struct osmo_fsm lb_peer_fsm;
 
@@ -37,8 +40,30 @@ static __attribute__((constructor)) void lb_peer_init()
 	OSMO_ASSERT( osmo_fsm_register(&lb_peer_fsm) == 0);
 }
 
+static const struct rate_ctr_desc lb_peer_ctr_description[] = {
+	[LB_PEER_CTR_RATE_LIMIT_CONN_REFUSED] =	{ "rate_limit:connection_refused", "N-CONNECT refused, the Lb peer exceeds the connection rate limit" },
+	[LB_PEER_CTR_RATE_LIMIT_LOC_REQ_REJECTED] =	{ "rate_limit:location_request_rejected", "Perform Location Request rejected, the Lb peer exceeds the location request rate limit" },
+};
+
+static const struct rate_ctr_group_desc lb_peer_ctrg_desc = {
+	"lb_peer",
+	"Lb peer",
+	OSMO_STATS_CLASS_PEER,
+	ARRAY_SIZE(lb_peer_ctr_description),
+	lb_peer_ctr_description,
+};
+
+static const struct osmo_stat_item_group_desc lb_peer_statg_desc = {
+	"lb_peer",
+	"Lb peer",
+	OSMO_STATS_CLASS_PEER,
+	_NUM_SMLC_LATENCY,
+	smlc_latency_stat_item_desc,
+};
+
 static struct lb_peer *lb_peer_alloc(struct sccp_lb_inst *sli, const struct osmo_sccp_addr *peer_addr)
 {
+	static unsigned int next_group_idx = 0;
 	struct lb_peer *lbp;
 	struct osmo_fsm_inst *fi;
 
@@ -54,8 +79,19 @@ static struct lb_peer *lb_peer_alloc(struct sccp_lb_inst *sli, const struct osmo
 		.sli = sli,
 		.peer_addr = *peer_addr,
 	};
+	INIT_LLIST_HEAD(&lbp->lb_conns);
 	fi->priv = lbp;
 
+	lbp->statg = osmo_stat_item_group_alloc(lbp, &lb_peer_statg_desc, next_group_idx);
+	OSMO_ASSERT(lbp->statg);
+	lbp->ctrs = rate_ctr_group_alloc(lbp, &lb_peer_ctrg_desc, next_group_idx);
+	OSMO_ASSERT(lbp->ctrs);
+	next_group_idx++;
+	if (fi->id) {
+		osmo_stat_item_group_set_name(lbp->statg, fi->id);
+		rate_ctr_group_set_name(lbp->ctrs, fi->id);
+	}
+
 	llist_add(&lbp->entry, &sli->lb_peers);
 
 	return lbp;
@@ -80,6 +116,36 @@ struct lb_peer *lb_peer_find(struct sccp_lb_inst *sli, const struct osmo_sccp_ad
 	return NULL;
 }
 
+/* Return how long to wait for a BSSLAP TA Response from this peer: T-12, or with 'ta-timeout adaptive', derived from
+ * the peer's measured TA round trips. */
+unsigned long lb_peer_ta_timeout_ms(const struct lb_peer *lbp)
+{
+	unsigned long t12_ms = osmo_tdef_get(g_smlc_tdefs, -12, OSMO_TDEF_MS, -1);
+
+	if (g_smlc->ta_timeout != SMLC_TA_TIMEOUT_ADAPTIVE || !lbp)
+		return t12_ms;
+	return ta_rtt_timeout_ms(&lbp->ta_rtt, t12_ms, g_smlc->ta_timeout_min_ms, g_smlc->ta_timeout_max_ms);
+}
+
+/* Take a token for a new connection from this peer. Return false, and count it, if the peer exceeds the rate limit. */
+bool lb_peer_admit_conn(struct lb_peer *lbp)
+{
+	if (token_bucket_take(&lbp->conn_bucket, &g_smlc->rate_limit_conn))
+		return true;
+	rate_ctr_inc(&lbp->ctrs->ctr[LB_PEER_CTR_RATE_LIMIT_CONN_REFUSED]);
+	return false;
+}
+
+/* Take a token for a Perform Location Request from this peer. Return false, and count it, if the peer exceeds the rate
+ * limit. */
+bool lb_peer_admit_loc_req(struct lb_peer *lbp)
+{
+	if (token_bucket_take(&lbp->loc_req_bucket, &g_smlc->rate_limit_loc_req))
+		return true;
+	rate_ctr_inc(&lbp->ctrs->ctr[LB_PEER_CTR_RATE_LIMIT_LOC_REQ_REJECTED]);
+	return false;
+}
+
 static const struct osmo_tdef_state_timeout lb_peer_fsm_timeouts[32] = {
 	[LB_PEER_ST_WAIT_RX_RESET_ACK] = { .T = -13 },
 	[LB_PEER_ST_DISCARDING] = { .T = -14 },
@@ -101,16 +167,10 @@ void lb_peer_discard_all_conns(struct lb_peer *lbp)
 static void lb_peer_rx_reset(struct lb_peer *lbp, struct msgb *msg)
 {
 	struct msgb *resp;
-	struct bssap_le_pdu reset_ack = {
-		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
-		.bssmap_le = {
-			.msg_type = BSSMAP_LE_MSGT_RESET_ACK,
-		},
-	};
 
 	lb_peer_discard_all_conns(lbp);
 
-	resp = osmo_bssap_le_enc(&reset_ack);
+	resp = lb_msgb_tmpl(g_smlc->lb_msgb_pool, LB_MSGB_TMPL_RESET_ACK);
 	if (!resp) {
 		LOG_LB_PEER(lbp, LOGL_ERROR, "Failed to compose RESET ACKNOWLEDGE message\n");
 		lb_peer_state_chg(lbp, LB_PEER_ST_WAIT_RX_RESET);
@@ -120,14 +180,16 @@ static void lb_peer_rx_reset(struct lb_peer *lbp, struct msgb *msg)
 	if (sccp_lb_down_l2_cl(lbp->sli, &lbp->peer_addr, resp)) {
 		LOG_LB_PEER(lbp, LOGL_ERROR, "Failed to send RESET ACKNOWLEDGE message\n");
 		lb_peer_state_chg(lbp, LB_PEER_ST_WAIT_RX_RESET);
-		msgb_free(msg);
+		lb_msgb_free(g_smlc->lb_msgb_pool, resp);
 		return;
 	}
 
 	LOG_LB_PEER(lbp, LOGL_INFO, "Sent RESET ACKNOWLEDGE\n");
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_TX_UDT_RESET_ACK]);
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSAP_LE_TX_TEMPLATE]);
 
 	/* sccp_lb_down_l2_cl() doesn't free msgb */
-	msgb_free(resp);
+	lb_msgb_free(g_smlc->lb_msgb_pool, resp);
 
 	lb_peer_state_chg(lbp, LB_PEER_ST_READY);
 }
@@ -139,20 +201,13 @@ static void lb_peer_rx_reset_ack(struct lb_peer *lbp, struct msgb* msg)
 
 void lb_peer_reset(struct lb_peer *lbp)
 {
-	struct bssap_le_pdu reset = {
-		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
-		.bssmap_le = {
-			.msg_type = BSSMAP_LE_MSGT_RESET,
-			.reset = GSM0808_CAUSE_EQUIPMENT_FAILURE,
-		},
-	};
 	struct msgb *msg;
 	int rc;
 
 	lb_peer_state_chg(lbp, LB_PEER_ST_WAIT_RX_RESET_ACK);
 	lb_peer_discard_all_conns(lbp);
 
-	msg = osmo_bssap_le_enc(&reset);
+	msg = lb_msgb_tmpl(g_smlc->lb_msgb_pool, LB_MSGB_TMPL_RESET);
 	if (!msg) {
 		LOG_LB_PEER(lbp, LOGL_ERROR, "Failed to compose RESET message\n");
 		lb_peer_state_chg(lbp, LB_PEER_ST_WAIT_RX_RESET);
@@ -160,11 +215,14 @@ void lb_peer_reset(struct lb_peer *lbp)
 	}
 
 	rc = sccp_lb_down_l2_cl(lbp->sli, &lbp->peer_addr, msg);
-	msgb_free(msg);
+	lb_msgb_free(g_smlc->lb_msgb_pool, msg);
 	if (rc) {
 		LOG_LB_PEER(lbp, LOGL_ERROR, "Failed to send RESET message\n");
 		lb_peer_state_chg(lbp, LB_PEER_ST_WAIT_RX_RESET);
+		return;
 	}
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_TX_UDT_RESET]);
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSAP_LE_TX_TEMPLATE]);
 }
 
 void lb_peer_allstate_action(struct osmo_fsm_inst *fi, uint32_t event, void *data)
@@ -179,12 +237,15 @@ void lb_peer_allstate_action(struct osmo_fsm_inst *fi, uint32_t event, void *dat
 		msg_type = osmo_bssmap_le_msgt(msgb_l2(msg), msgb_l2len(msg));
 		switch (msg_type) {
 		case BSSMAP_LE_MSGT_RESET:
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_UDT_RESET]);
 			osmo_fsm_inst_dispatch(fi, LB_PEER_EV_RX_RESET, msg);
 			return;
 		case BSSMAP_LE_MSGT_RESET_ACK:
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_UDT_RESET_ACK]);
 			osmo_fsm_inst_dispatch(fi, LB_PEER_EV_RX_RESET_ACK, msg);
 			return;
 		default:
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_UDT_ERR_INVALID_MSG]);
 			LOG_LB_PEER(lbp, LOGL_ERROR, "Unhandled ConnectionLess message received: %s\n",
 				    osmo_bssmap_le_msgt_name(msg_type));
 			return;
@@ -341,6 +402,10 @@ void lb_peer_fsm_cleanup(struct osmo_fsm_inst *fi, enum osmo_fsm_term_cause caus
 	struct lb_peer *lbp = fi->priv;
 	lb_peer_discard_all_conns(lbp);
 	llist_del(&lbp->entry);
+	osmo_stat_item_group_free(lbp->statg);
+	lbp->statg = NULL;
+	rate_ctr_group_free(lbp->ctrs);
+	lbp->ctrs = NULL;
 }
 
 static const struct value_string lb_peer_fsm_event_names[] = {
@@ -441,13 +506,10 @@ int lb_peer_up_l2(struct sccp_lb_inst *sli, const struct osmo_sccp_addr *calling
 	};
 
 	if (co) {
-		struct lb_conn *lb_conn;
-		llist_for_each_entry(lb_conn, &sli->lb_conns, entry) {
-			if (lb_conn->sccp_conn_id == conn_id) {
-				lb_peer = lb_conn->lb_peer;
-				ctx.lb_conn = lb_conn;
-				break;
-			}
+		struct lb_conn *lb_conn = lb_conn_find_by_sccp_conn_id(sli, conn_id);
+		if (lb_conn) {
+			lb_peer = lb_conn->lb_peer;
+			ctx.lb_conn = lb_conn;
 		}
 
 		if (lb_peer && calling_addr) {
@@ -485,11 +547,7 @@ int lb_peer_up_l2(struct sccp_lb_inst *sli, const struct osmo_sccp_addr *calling
 
 void lb_peer_disconnect(struct sccp_lb_inst *sli, uint32_t conn_id)
 {
-	struct lb_conn *lb_conn;
-	llist_for_each_entry(lb_conn, &sli->lb_conns, entry) {
-		if (lb_conn->sccp_conn_id == conn_id) {
-			lb_conn_discard(lb_conn);
-			return;
-		}
-	}
+	struct lb_conn *lb_conn = lb_conn_find_by_sccp_conn_id(sli, conn_id);
+	if (lb_conn)
+		lb_conn_discard(lb_conn);
 }
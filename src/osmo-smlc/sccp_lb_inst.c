@@ -28,40 +28,17 @@
 
 #include <osmocom/smlc/debug.h>
 #include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/conn_ids.h>
 #include <osmocom/smlc/sccp_lb_inst.h>
 #include <osmocom/smlc/lb_peer.h>
+#include <osmocom/smlc/lb_conn.h>
+#include <osmocom/smlc/smlc_overload.h>
 
-/* We need an unused SCCP conn_id across all SCCP users. */
-int sccp_lb_inst_next_conn_id()
+/* We need an unused SCCP conn_id across all SCCP users. IDs of incoming connections are claimed in
+ * lb_conn_create_incoming(), so an ID picked here is not in use by any lb_conn. Return -ENOSPC when all are taken. */
+int sccp_lb_inst_next_conn_id(struct sccp_lb_inst *sli)
 {
-	static uint32_t next_id = 1;
-	int i;
-
-	/* This looks really suboptimal, but in most cases the static next_id should indicate exactly the next unused
-	 * conn_id, and we only iterate all conns once to make super sure that it is not already in use. */
-
-	for (i = 0; i < 0xFFFFFF; i++) {
-		struct lb_peer *lb_peer;
-		uint32_t conn_id = next_id;
-		bool conn_id_already_used = false;
-		next_id = (next_id + 1) & 0xffffff;
-
-		llist_for_each_entry(lb_peer, &g_smlc->lb->lb_peers, entry) {
-			struct lb_conn *conn;
-			lb_peer_for_each_lb_conn(conn, lb_peer) {
-				if (conn_id == conn->sccp_conn_id) {
-					conn_id_already_used = true;
-					break;
-				}
-			}
-			if (conn_id_already_used)
-				break;
-		}
-
-		if (!conn_id_already_used)
-			return conn_id;
-	}
-	return -1;
+	return conn_ids_next(sli->conn_ids);
 }
 
 static int sccp_lb_sap_up(struct osmo_prim_hdr *oph, void *_scu);
@@ -69,14 +46,14 @@ static int sccp_lb_sap_up(struct osmo_prim_hdr *oph, void *_scu);
 struct sccp_lb_inst *sccp_lb_init(void *talloc_ctx, struct osmo_sccp_instance *sccp, enum osmo_sccp_ssn ssn,
 				  const char *sccp_user_name)
 {
-	struct sccp_lb_inst *sli = talloc(talloc_ctx, struct sccp_lb_inst);
+	/* Not initialized from a compound literal, which might place the large conn_id hash table on the stack */
+	struct sccp_lb_inst *sli = talloc_zero(talloc_ctx, struct sccp_lb_inst);
 	OSMO_ASSERT(sli);
-	*sli = (struct sccp_lb_inst){
-		.sccp = sccp,
-	};
+	sli->sccp = sccp;
 
 	INIT_LLIST_HEAD(&sli->lb_peers);
-	INIT_LLIST_HEAD(&sli->lb_conns);
+	hash_init(sli->lb_conns_by_conn_id);
+	sli->conn_ids = conn_ids_alloc(sli);
 
 	osmo_sccp_local_addr_by_instance(&sli->local_sccp_addr, sccp, ssn);
 	sli->scu = osmo_sccp_user_bind(sccp, sccp_user_name, sccp_lb_sap_up, ssn);
@@ -92,6 +69,7 @@ static int sccp_lb_sap_up(struct osmo_prim_hdr *oph, void *_scu)
 	struct osmo_scu_prim *prim = (struct osmo_scu_prim *) oph;
 	struct osmo_sccp_addr *my_addr;
 	struct osmo_sccp_addr *peer_addr;
+	struct lb_peer *lbp;
 	uint32_t conn_id;
 	int rc;
 
@@ -115,6 +93,25 @@ static int sccp_lb_sap_up(struct osmo_prim_hdr *oph, void *_scu)
 				       osmo_sccp_inst_addr_to_str_c(OTC_SELECT, sli->sccp, my_addr),
 				       osmo_sccp_inst_addr_to_str_c(OTC_SELECT, sli->sccp, &sli->local_sccp_addr));
 
+		if (g_smlc->overload->state >= SMLC_OVERLOAD_REFUSE_CONN) {
+			LOG_SCCP_LB_CO(sli, peer_addr, conn_id, LOGL_NOTICE, "Refusing N-CONNECT, overload state %s\n",
+				       get_value_string(smlc_overload_state_names, g_smlc->overload->state));
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_OVERLOAD_CONNECTION_REFUSED]);
+			osmo_sccp_tx_disconn(scu, conn_id, my_addr, SCCP_REFUSAL_END_USER_CONGESTION);
+			rc = 0;
+			break;
+		}
+
+		/* Refuse a connection over the peer's rate limit right away, instead of confirming it only to drop it */
+		lbp = lb_peer_find_or_create(sli, peer_addr);
+		if (lbp && !lb_peer_admit_conn(lbp)) {
+			LOG_SCCP_LB_CO(sli, peer_addr, conn_id, LOGL_NOTICE,
+				       "Refusing N-CONNECT, Lb peer exceeds the connection rate limit\n");
+			osmo_sccp_tx_disconn(scu, conn_id, my_addr, SCCP_REFUSAL_END_USER_CONGESTION);
+			rc = 0;
+			break;
+		}
+
 		/* ensure the local SCCP socket is ACTIVE */
 		osmo_sccp_tx_conn_resp(scu, conn_id, my_addr, NULL, 0);
 
@@ -145,7 +142,7 @@ static int sccp_lb_sap_up(struct osmo_prim_hdr *oph, void *_scu)
 		/* Make sure the lb_conn is dropped. It might seem more optimal to combine the disconnect() into
 		 * up_l2(), but since an up_l2() dispatch might already cause the lb_conn to be discarded for other
 		 * reasons, a separate disconnect() with a separate conn_id lookup is actually necessary. */
-		sccp_lb_disconnect(sli, conn_id, 0);
+		lb_peer_disconnect(sli, conn_id);
 		break;
 
 	case OSMO_PRIM(OSMO_SCU_PRIM_N_UNITDATA, PRIM_OP_INDICATION):
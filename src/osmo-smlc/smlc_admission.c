@@ -0,0 +1,154 @@
+/* OsmoSMLC prioritized admission of location requests */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <inttypes.h>
+
+#include <osmocom/core/talloc.h>
+#include <osmocom/vty/vty.h>
+
+#include <osmocom/smlc/smlc_admission.h>
+
+const struct value_string smlc_loc_req_prio_names[] = {
+	{ SMLC_LOC_REQ_PRIO_EMERGENCY, "emergency" },
+	{ SMLC_LOC_REQ_PRIO_HIGH, "high" },
+	{ SMLC_LOC_REQ_PRIO_NORMAL, "normal" },
+	{}
+};
+
+static bool smlc_admission_may_start(const struct smlc_admission *adm)
+{
+	return !adm->max_active || adm->active + adm->queued_total < adm->max_active;
+}
+
+static void smlc_admission_drain(void *data)
+{
+	struct smlc_admission *adm = data;
+	struct smlc_admission_entry *e;
+	enum smlc_loc_req_prio prio;
+
+	while (adm->queued_total && (!adm->max_active || adm->active < adm->max_active)) {
+		for (prio = 0; prio < _NUM_SMLC_LOC_REQ_PRIO; prio++) {
+			if (!llist_empty(&adm->queue[prio]))
+				break;
+		}
+		OSMO_ASSERT(prio < _NUM_SMLC_LOC_REQ_PRIO);
+
+		e = llist_first_entry(&adm->queue[prio], struct smlc_admission_entry, entry);
+		llist_del(&e->entry);
+		adm->queued[prio]--;
+		adm->queued_total--;
+		adm->active++;
+		adm->stats[prio].dequeued++;
+		e->state = SMLC_ADMISSION_ENTRY_ACTIVE;
+		/* This may well release e again right away, or any other entry */
+		adm->start_cb(e);
+	}
+}
+
+struct smlc_admission *smlc_admission_alloc(void *ctx, smlc_admission_start_cb_t start_cb)
+{
+	struct smlc_admission *adm = talloc_zero(ctx, struct smlc_admission);
+	enum smlc_loc_req_prio prio;
+
+	OSMO_ASSERT(adm);
+	for (prio = 0; prio < _NUM_SMLC_LOC_REQ_PRIO; prio++)
+		INIT_LLIST_HEAD(&adm->queue[prio]);
+	adm->max_backlog[SMLC_LOC_REQ_PRIO_HIGH] = SMLC_ADMISSION_DEFAULT_MAX_BACKLOG_HIGH;
+	adm->max_backlog[SMLC_LOC_REQ_PRIO_NORMAL] = SMLC_ADMISSION_DEFAULT_MAX_BACKLOG_NORMAL;
+	adm->start_cb = start_cb;
+	osmo_timer_setup(&adm->drain_timer, smlc_admission_drain, adm);
+	return adm;
+}
+
+/* Decide whether a new request may start now. On SMLC_ADMISSION_START and SMLC_ADMISSION_QUEUED, the caller must
+ * call smlc_admission_release() when the request ends, whether it ever started or not. */
+enum smlc_admission_result smlc_admission_request(struct smlc_admission *adm, struct smlc_admission_entry *e,
+						  enum smlc_loc_req_prio prio)
+{
+	OSMO_ASSERT(e->state == SMLC_ADMISSION_ENTRY_IDLE);
+	e->prio = prio;
+
+	if (smlc_admission_may_start(adm)) {
+		e->state = SMLC_ADMISSION_ENTRY_ACTIVE;
+		adm->active++;
+		adm->stats[prio].started++;
+		return SMLC_ADMISSION_START;
+	}
+
+	if (prio != SMLC_LOC_REQ_PRIO_EMERGENCY && adm->queued_total >= adm->max_backlog[prio]) {
+		adm->stats[prio].rejected++;
+		return SMLC_ADMISSION_REJECTED;
+	}
+
+	e->state = SMLC_ADMISSION_ENTRY_QUEUED;
+	llist_add_tail(&e->entry, &adm->queue[prio]);
+	adm->queued[prio]++;
+	adm->queued_total++;
+	return SMLC_ADMISSION_QUEUED;
+}
+
+/* A request has ended: remove it from the queue, or let the next queued request start. */
+void smlc_admission_release(struct smlc_admission *adm, struct smlc_admission_entry *e)
+{
+	switch (e->state) {
+	case SMLC_ADMISSION_ENTRY_QUEUED:
+		llist_del(&e->entry);
+		adm->queued[e->prio]--;
+		adm->queued_total--;
+		break;
+	case SMLC_ADMISSION_ENTRY_ACTIVE:
+		adm->active--;
+		smlc_admission_kick(adm);
+		break;
+	default:
+		break;
+	}
+	e->state = SMLC_ADMISSION_ENTRY_IDLE;
+}
+
+/* Start queued requests as far as the limits allow, from the main loop. Also call after raising max_active. */
+void smlc_admission_kick(struct smlc_admission *adm)
+{
+	if (adm->queued_total && !osmo_timer_pending(&adm->drain_timer))
+		osmo_timer_schedule(&adm->drain_timer, 0, 0);
+}
+
+void smlc_admission_vty_show(struct vty *vty, const struct smlc_admission *adm)
+{
+	enum smlc_loc_req_prio prio;
+
+	if (adm->max_active)
+		vty_out(vty, "%u active of max %u, %u queued%s", adm->active, adm->max_active, adm->queued_total,
+			VTY_NEWLINE);
+	else
+		vty_out(vty, "%u active, no limit%s", adm->active, VTY_NEWLINE);
+
+	for (prio = 0; prio < _NUM_SMLC_LOC_REQ_PRIO; prio++) {
+		const struct smlc_admission_prio_stats *stats = &adm->stats[prio];
+		vty_out(vty, " %s: %u queued", get_value_string(smlc_loc_req_prio_names, prio), adm->queued[prio]);
+		if (prio != SMLC_LOC_REQ_PRIO_EMERGENCY)
+			vty_out(vty, " of max-backlog %u", adm->max_backlog[prio]);
+		vty_out(vty, ", %" PRIu64 " started, %" PRIu64 " started from the queue, %" PRIu64 " rejected%s",
+			stats->started, stats->dequeued, stats->rejected, VTY_NEWLINE);
+	}
+}
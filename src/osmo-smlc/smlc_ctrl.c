@@ -1,5 +1,9 @@
+#include <osmocom/ctrl/control_cmd.h>
 #include <osmocom/ctrl/control_if.h>
 
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/smlc_overload.h>
+
 
 /*! \brief control interface lookup function for bsc/bts/msc gsm_data
  * \param[in] data Private data passed to controlif_setup()
@@ -14,4 +18,21 @@ int smlc_ctrl_node_lookup(void *data, vector vline, int *node_type,
 	return 0;
 }
 
+CTRL_CMD_DEFINE_RO(overload_state, "overload-state");
+static int get_overload_state(struct ctrl_cmd *cmd, void *data)
+{
+	cmd->reply = talloc_strdup(cmd, get_value_string(smlc_overload_state_names, g_smlc->overload->state));
+	if (!cmd->reply) {
+		cmd->reply = "OOM";
+		return CTRL_CMD_ERROR;
+	}
+	return CTRL_CMD_REPLY;
+}
+
+int smlc_ctrl_cmds_install(struct smlc_state *smlc)
+{
+	int rc = 0;
 
+	rc |= ctrl_cmd_install(CTRL_NODE_ROOT, &cmd_overload_state);
+	return rc;
+}
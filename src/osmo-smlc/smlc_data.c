@@ -21,6 +21,7 @@
 
 struct osmo_tdef g_smlc_tdefs[] = {
 	{ .T=-12, .default_val=5, .desc="Timeout for BSSLAP TA Response from BSC" },
+	{ .T=-16, .default_val=2, .desc="Timeout for a location request waiting in the admission queue" },
 	{}
 };
 
@@ -44,6 +45,36 @@ static const struct rate_ctr_desc smlc_ctr_description[] = {
 	[SMLC_CTR_BSSMAP_LE_TX_UDT_RESET_ACK] =	{ "bssmap_le:tx_udt_reset_ack", "Transmit UnitData Reset Acknowledge" },
 	[SMLC_CTR_BSSMAP_LE_TX_DT1_PERFORM_LOCATION_RESPONSE] =	{ "bssmap_le:tx_dt1_perform_location_response", "Tx Perform Location Response to BSC" },
 	[SMLC_CTR_BSSMAP_LE_TX_DT1_BSSLAP_TA_REQUEST] =	{ "bssmap_le:tx_dt1_bsslap_ta_request", "Tx BSSLAP TA Request to BSC" },
+
+	[SMLC_CTR_LOCATION_ESTIMATE_CACHE_HIT] =	{ "location_estimate:cache_hit", "Location Estimate taken from cache" },
+	[SMLC_CTR_LOCATION_ESTIMATE_CACHE_MISS] =	{ "location_estimate:cache_miss", "Location Estimate computed and encoded" },
+	[SMLC_CTR_LOCATION_REQUEST_FAST_PATH] =	{ "location_request:fast_path", "Perform Location Request answered right away from the TA it contained" },
+	[SMLC_CTR_LAST_LOCATION_HIT] =	{ "last_location:hit", "Perform Location Request answered from the last known location, saving a BSSLAP TA round trip" },
+	[SMLC_CTR_LAST_LOCATION_MISS] =	{ "last_location:miss", "No last known location for the subscriber" },
+	[SMLC_CTR_LAST_LOCATION_EXPIRED] =	{ "last_location:expired", "Last known location dropped for its age" },
+	[SMLC_CTR_LAST_LOCATION_QOS_MISMATCH] =	{ "last_location:qos_mismatch", "Last known location not used: other cell, delay tolerant or not accurate enough" },
+	[SMLC_CTR_LOCATION_REQUEST_CELL_ID_ONLY] =	{ "location_request:cell_id_only", "Low delay Perform Location Request answered from the cell identity alone, without asking for the TA" },
+	[SMLC_CTR_LOCATION_REQUEST_CELL_ID_ONLY_INACCURATE] =	{ "location_request:cell_id_only_inaccurate", "Low delay Perform Location Request needs the TA, the cell radius exceeds the requested accuracy" },
+	[SMLC_CTR_LOCATION_REQUEST_QUEUED] =	{ "location_request:queued", "Perform Location Request waits in the admission queue, the max number of active requests is reached" },
+	[SMLC_CTR_LOCATION_REQUEST_CONGESTION] =	{ "location_request:congestion", "Perform Location Request rejected, the admission queue exceeds the max backlog for its priority" },
+	[SMLC_CTR_LOCATION_REQUEST_PIPELINED] =	{ "location_request:pipelined", "Perform Location Request queued on its Lb connection behind a pending one" },
+	[SMLC_CTR_LOCATION_REQUEST_COALESCED] =	{ "location_request:coalesced", "Queued Perform Location Request answered from the TA of the pending one" },
+	[SMLC_CTR_LOCATION_REQUEST_PIPELINE_FULL] =	{ "location_request:pipeline_full", "Perform Location Request dropped, too many are pending on its Lb connection" },
+	[SMLC_CTR_HANDOVER_TA_HIT] =	{ "handover_ta:hit", "Perform Location Request answered from the TA of a recent BSSLAP Reset, saving a BSSLAP TA round trip" },
+	[SMLC_CTR_HANDOVER_TA_EXPIRED] =	{ "handover_ta:expired", "TA of a BSSLAP Reset not used for its age" },
+	[SMLC_CTR_HANDOVER_TA_OTHER_CELL] =	{ "handover_ta:other_cell", "TA of a BSSLAP Reset not used, the request indicates another cell" },
+
+	[SMLC_CTR_OVERLOAD_ENTER_NONE] =	{ "overload:enter_none", "Overload state cleared" },
+	[SMLC_CTR_OVERLOAD_ENTER_SKIP_DEBUG_LOG] =	{ "overload:enter_skip_debug_log", "Overload state skip-debug-log entered" },
+	[SMLC_CTR_OVERLOAD_ENTER_REJECT_NORMAL] =	{ "overload:enter_reject_normal", "Overload state reject-normal entered" },
+	[SMLC_CTR_OVERLOAD_ENTER_REFUSE_CONN] =	{ "overload:enter_refuse_connection", "Overload state refuse-connection entered" },
+	[SMLC_CTR_OVERLOAD_LOCATION_REQUEST_REJECTED] =	{ "overload:location_request_rejected", "Perform Location Request of normal priority rejected under overload" },
+	[SMLC_CTR_OVERLOAD_CONNECTION_REFUSED] =	{ "overload:connection_refused", "New SCCP connection refused under overload" },
+	[SMLC_CTR_BSSAP_LE_TX_TEMPLATE] =	{ "bssap_le:tx_template", "BSSAP-LE message sent by copying a pre-encoded template" },
+	[SMLC_CTR_BSSAP_LE_TX_ENCODED] =	{ "bssap_le:tx_encoded", "BSSAP-LE message sent by running the encoder" },
+	[SMLC_CTR_POSITIONING_POOLED] =	{ "positioning:pooled", "Location estimate handed to a positioning thread" },
+	[SMLC_CTR_POSITIONING_EXPIRED] =	{ "positioning:expired", "Location estimate not computed within the positioning deadline" },
+	[SMLC_CTR_LOCATION_REQUEST_QUEUE_TIMEOUT] =	{ "location_request:queue_timeout", "Perform Location Request rejected, it waited in the admission queue for longer than T-16" },
 };
 
 static const struct rate_ctr_group_desc smlc_ctrg_desc = {
@@ -54,12 +85,39 @@ static const struct rate_ctr_group_desc smlc_ctrg_desc = {
 	smlc_ctr_description,
 };
 
+/* The stat items of g_smlc->statg and of each lb_peer->statg */
+const struct osmo_stat_item_desc smlc_latency_stat_item_desc[_NUM_SMLC_LATENCY] = {
+	[SMLC_LATENCY_TOTAL] =	{ "location_request:latency_total", "Time from Rx Perform Location Request to Tx Perform Location Response", "us", 16, 0 },
+	[SMLC_LATENCY_TA_ROUND_TRIP] =	{ "location_request:latency_ta_round_trip", "Time from Tx BSSLAP TA Request to Rx TA Response or BSSLAP Reset", "us", 16, 0 },
+	[SMLC_LATENCY_PROCESSING] =	{ "location_request:latency_processing", "Location request latency without the TA round trip and the admission queue", "us", 16, 0 },
+	[SMLC_LATENCY_QUEUE] =	{ "location_request:latency_queue", "Time a location request waited in the admission queue", "us", 16, 0 },
+};
+
+static const struct osmo_stat_item_group_desc smlc_statg_desc = {
+	"smlc",
+	"serving mobile location center",
+	OSMO_STATS_CLASS_GLOBAL,
+	_NUM_SMLC_LATENCY,
+	smlc_latency_stat_item_desc,
+};
+
 struct smlc_state *smlc_state_alloc(void *ctx)
 {
 	struct smlc_state *smlc = talloc_zero(ctx, struct smlc_state);
 	OSMO_ASSERT(smlc);
+	/* Nothing else sets the timer values from their defaults */
+	osmo_tdefs_reset(g_smlc_tdefs);
 	INIT_LLIST_HEAD(&smlc->subscribers);
-	INIT_LLIST_HEAD(&smlc->cell_locations);
+	hash_init(smlc->subscribers_by_imsi);
+	INIT_LLIST_HEAD(&smlc->last_locations);
+	smlc->last_location_capacity = SMLC_LAST_LOCATION_DEFAULT_CAPACITY;
+	smlc->ta_timeout_min_ms = SMLC_TA_TIMEOUT_DEFAULT_MIN_MS;
+	smlc->ta_timeout_max_ms = SMLC_TA_TIMEOUT_DEFAULT_MAX_MS;
+	smlc->loc_req_pipeline_depth = SMLC_LOC_REQ_PIPELINE_DEFAULT_DEPTH;
+	smlc->positioning_deadline_ms = SMLC_POSITIONING_DEFAULT_DEADLINE_MS;
+	smlc->rate_limit_conn.burst = SMLC_RATE_LIMIT_DEFAULT_BURST;
+	smlc->rate_limit_loc_req.burst = SMLC_RATE_LIMIT_DEFAULT_BURST;
 	smlc->ctrs = rate_ctr_group_alloc(smlc, &smlc_ctrg_desc, 0);
+	smlc->statg = osmo_stat_item_group_alloc(smlc, &smlc_statg_desc, 0);
 	return smlc;
 }
@@ -0,0 +1,141 @@
+/* OsmoSMLC location request latency histograms */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <inttypes.h>
+
+#include <osmocom/core/timer.h>
+#include <osmocom/core/timer_compat.h>
+#include <osmocom/core/stat_item.h>
+#include <osmocom/vty/vty.h>
+
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/smlc_latency.h>
+#include <osmocom/smlc/lb_peer.h>
+
+const struct value_string smlc_latency_stage_names[] = {
+	{ SMLC_LATENCY_TOTAL, "total" },
+	{ SMLC_LATENCY_TA_ROUND_TRIP, "ta-round-trip" },
+	{ SMLC_LATENCY_PROCESSING, "processing" },
+	{ SMLC_LATENCY_QUEUE, "queue" },
+	{}
+};
+
+void smlc_latency_stamp(struct timespec *ts)
+{
+	osmo_clock_gettime(CLOCK_MONOTONIC, ts);
+}
+
+static bool stamp_present(const struct timespec *ts)
+{
+	return ts->tv_sec || ts->tv_nsec;
+}
+
+uint64_t smlc_latency_stamp_diff_us(const struct timespec *later, const struct timespec *earlier)
+{
+	struct timespec diff;
+	timespecsub(later, earlier, &diff);
+	if (diff.tv_sec < 0)
+		return 0;
+	return (uint64_t)diff.tv_sec * 1000000 + diff.tv_nsec / 1000;
+}
+
+void smlc_latency_hist_add(struct smlc_latency_hist *hist, uint64_t us)
+{
+	unsigned int bucket = 0;
+
+	while (bucket < SMLC_LATENCY_BUCKETS - 1 && us >= (1ULL << (bucket + SMLC_LATENCY_BUCKET_MIN_BITS)))
+		bucket++;
+	hist->buckets[bucket]++;
+	hist->count++;
+	hist->sum_us += us;
+	hist->max_us = OSMO_MAX(hist->max_us, us);
+}
+
+static void smlc_latency_add(struct smlc_latency *latency, struct osmo_stat_item_group *statg,
+			     enum smlc_latency_stage stage, uint64_t us)
+{
+	smlc_latency_hist_add(&latency->hist[stage], us);
+	if (statg)
+		osmo_stat_item_set(osmo_stat_item_group_get_item(statg, stage), us);
+}
+
+/* Add the latencies of a location request to the global, the Lb peer's and the priority's histograms and to the stat
+ * items, with the Tx of the Perform Location Response happening now. */
+void smlc_latency_record(struct lb_peer *lbp, enum smlc_loc_req_prio prio, const struct smlc_latency_stamps *stamps)
+{
+	uint64_t us[_NUM_SMLC_LATENCY];
+	bool ta_round_trip = stamp_present(&stamps->tx_ta_req) && stamp_present(&stamps->rx_ta);
+	bool queued = stamp_present(&stamps->dequeued);
+	struct timespec tx_resp;
+	enum smlc_latency_stage stage;
+
+	smlc_latency_stamp(&tx_resp);
+	us[SMLC_LATENCY_TOTAL] = smlc_latency_stamp_diff_us(&tx_resp, &stamps->rx_req);
+	us[SMLC_LATENCY_TA_ROUND_TRIP] = ta_round_trip ? smlc_latency_stamp_diff_us(&stamps->rx_ta, &stamps->tx_ta_req) : 0;
+	us[SMLC_LATENCY_QUEUE] = queued ? smlc_latency_stamp_diff_us(&stamps->dequeued, &stamps->rx_req) : 0;
+	us[SMLC_LATENCY_PROCESSING] = us[SMLC_LATENCY_TOTAL] - OSMO_MIN(us[SMLC_LATENCY_TOTAL],
+									us[SMLC_LATENCY_TA_ROUND_TRIP]
+									+ us[SMLC_LATENCY_QUEUE]);
+
+	for (stage = 0; stage < _NUM_SMLC_LATENCY; stage++) {
+		if (stage == SMLC_LATENCY_TA_ROUND_TRIP && !ta_round_trip)
+			continue;
+		if (stage == SMLC_LATENCY_QUEUE && !queued)
+			continue;
+		smlc_latency_add(&g_smlc->latency, g_smlc->statg, stage, us[stage]);
+		smlc_latency_add(&g_smlc->latency_by_prio[prio], NULL, stage, us[stage]);
+		if (lbp)
+			smlc_latency_add(&lbp->latency, lbp->statg, stage, us[stage]);
+	}
+}
+
+void smlc_latency_vty_show(struct vty *vty, const struct smlc_latency *latency)
+{
+	enum smlc_latency_stage stage;
+	unsigned int bucket;
+
+	for (stage = 0; stage < _NUM_SMLC_LATENCY; stage++) {
+		const struct smlc_latency_hist *hist = &latency->hist[stage];
+
+		if (!hist->count) {
+			vty_out(vty, " %s: no requests%s", get_value_string(smlc_latency_stage_names, stage), VTY_NEWLINE);
+			continue;
+		}
+		vty_out(vty, " %s: %" PRIu64 " requests, avg %" PRIu64 " us, max %" PRIu64 " us%s",
+			get_value_string(smlc_latency_stage_names, stage), hist->count, hist->sum_us / hist->count,
+			hist->max_us, VTY_NEWLINE);
+
+		for (bucket = 0; bucket < SMLC_LATENCY_BUCKETS; bucket++) {
+			if (!hist->buckets[bucket])
+				continue;
+			if (bucket < SMLC_LATENCY_BUCKETS - 1)
+				vty_out(vty, "  < %llu us: %" PRIu64 "%s",
+					1ULL << (bucket + SMLC_LATENCY_BUCKET_MIN_BITS), hist->buckets[bucket],
+					VTY_NEWLINE);
+			else
+				vty_out(vty, "  >= %llu us: %" PRIu64 "%s",
+					1ULL << (bucket - 1 + SMLC_LATENCY_BUCKET_MIN_BITS), hist->buckets[bucket],
+					VTY_NEWLINE);
+		}
+	}
+}
@@ -27,10 +27,15 @@
 #include <osmocom/smlc/smlc_loc_req.h>
 #include <osmocom/smlc/smlc_subscr.h>
 #include <osmocom/smlc/lb_conn.h>
+#include <osmocom/smlc/lb_peer.h>
 #include <osmocom/smlc/cell_locations.h>
+#include <osmocom/smlc/cell_table.h>
+#include <osmocom/smlc/smlc_overload.h>
+#include <osmocom/smlc/smlc_pos.h>
 
 #include <osmocom/core/fsm.h>
 #include <osmocom/core/tdef.h>
+#include <osmocom/core/timer_compat.h>
 #include <osmocom/core/utils.h>
 #include <osmocom/gsm/bsslap.h>
 #include <osmocom/gsm/bssmap_le.h>
@@ -40,6 +45,7 @@ enum smlc_loc_req_fsm_state {
 	SMLC_LOC_REQ_ST_INIT,
 	SMLC_LOC_REQ_ST_WAIT_TA,
 	SMLC_LOC_REQ_ST_GOT_TA,
+	SMLC_LOC_REQ_ST_COMPUTING,
 	SMLC_LOC_REQ_ST_FAILED,
 };
 
@@ -47,6 +53,7 @@ static const struct value_string smlc_loc_req_fsm_event_names[] = {
 	OSMO_VALUE_STRING(SMLC_LOC_REQ_EV_RX_TA_RESPONSE),
 	OSMO_VALUE_STRING(SMLC_LOC_REQ_EV_RX_BSSLAP_RESET),
 	OSMO_VALUE_STRING(SMLC_LOC_REQ_EV_RX_LE_PERFORM_LOCATION_ABORT),
+	OSMO_VALUE_STRING(SMLC_LOC_REQ_EV_POS_RESULT),
 	{}
 };
 
@@ -54,16 +61,32 @@ static struct osmo_fsm smlc_loc_req_fsm;
 
 static const struct osmo_tdef_state_timeout smlc_loc_req_fsm_timeouts[32] = {
 	[SMLC_LOC_REQ_ST_WAIT_TA] = { .T = -12 },
+	[SMLC_LOC_REQ_ST_COMPUTING] = { .T = -15 },
 };
 
-/* Transition to a state, using the T timer defined in smlc_loc_req_fsm_timeouts.
- * The actual timeout value is in turn obtained from network->T_defs.
- * Assumes local variable fi exists. */
-#define smlc_loc_req_fsm_state_chg(FI, STATE) \
-	osmo_tdef_fsm_inst_state_chg(FI, STATE, \
-				     smlc_loc_req_fsm_timeouts, \
-				     g_smlc_tdefs, \
-				     5)
+/* Transition to a state, using the T timer defined in smlc_loc_req_fsm_timeouts. The actual timeout value is in turn
+ * obtained from g_smlc_tdefs, for the TA Response from the Lb peer's adaptive timeout, or for the positioning from
+ * 'positioning deadline'. Tens of thousands of concurrent requests each arming an osmo_timer would weigh on the
+ * timer tree, so the timeout runs on g_smlc->timer_wheel; the FSM instance only records the T number. Start the timeout
+ * before the state change, so that a state change from the onenter function takes precedence. */
+static int smlc_loc_req_fsm_state_chg(struct osmo_fsm_inst *fi, uint32_t state)
+{
+	struct smlc_loc_req *smlc_loc_req = fi->priv;
+	int T = smlc_loc_req_fsm_timeouts[state].T;
+	unsigned long timeout_ms;
+
+	if (T) {
+		if (state == SMLC_LOC_REQ_ST_WAIT_TA)
+			timeout_ms = lb_peer_ta_timeout_ms(smlc_loc_req->lb_conn->lb_peer);
+		else if (state == SMLC_LOC_REQ_ST_COMPUTING)
+			timeout_ms = g_smlc->positioning_deadline_ms;
+		else
+			timeout_ms = osmo_tdef_get(g_smlc_tdefs, T, OSMO_TDEF_MS, -1);
+		timer_wheel_schedule(g_smlc->timer_wheel, &smlc_loc_req->timeout, timeout_ms);
+	} else
+		timer_wheel_del(&smlc_loc_req->timeout);
+	return osmo_fsm_inst_state_chg(fi, state, 0, T);
+}
 
 #define smlc_loc_req_fail(cause, fmt, args...) do { \
 		LOG_SMLC_LOC_REQ(smlc_loc_req, LOGL_ERROR, "Perform Location Request failed in state %s: " fmt "\n", \
@@ -75,11 +98,41 @@ static const struct osmo_tdef_state_timeout smlc_loc_req_fsm_timeouts[32] = {
 		smlc_loc_req_fsm_state_chg(smlc_loc_req->fi, SMLC_LOC_REQ_ST_FAILED); \
 	} while(0)
 
+static void smlc_loc_req_timeout_cb(void *data)
+{
+	struct smlc_loc_req *smlc_loc_req = data;
+	struct lb_peer *lbp = smlc_loc_req->lb_conn->lb_peer;
+
+	if (smlc_loc_req->fi->state == SMLC_LOC_REQ_ST_WAIT_TA && lbp)
+		ta_rtt_timed_out(&lbp->ta_rtt);
+	if (smlc_loc_req->fi->state == SMLC_LOC_REQ_ST_COMPUTING)
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_POSITIONING_EXPIRED]);
+	if (smlc_loc_req->fi->state == SMLC_LOC_REQ_ST_INIT) {
+		smlc_latency_stamp(&smlc_loc_req->stamps.dequeued);
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_QUEUE_TIMEOUT]);
+		smlc_loc_req_fail(LCS_CAUSE_CONGESTION, "Waited in the admission queue for longer than T%d",
+				  smlc_loc_req->fi->T);
+		return;
+	}
+	smlc_loc_req_fail(LCS_CAUSE_SYSTEM_FAILURE, "Timeout of T%d", smlc_loc_req->fi->T);
+}
+
+/* The FSM instance is freed from OTC_SELECT after termination, and this struct is freed along with it. Return the pool
+ * chunk then. The FSM instance is still being freed, but nothing else is allocated from the chunk before that is
+ * done. */
+static int smlc_loc_req_talloc_destructor(struct smlc_loc_req *smlc_loc_req)
+{
+	smlc_pool_put(g_smlc->loc_req_pool, smlc_loc_req->pool_chunk);
+	return 0;
+}
+
 static struct smlc_loc_req *smlc_loc_req_alloc(void *ctx)
 {
 	struct smlc_loc_req *smlc_loc_req;
+	void *pool_chunk = smlc_pool_get(g_smlc->loc_req_pool);
 
-	struct osmo_fsm_inst *fi = osmo_fsm_inst_alloc(&smlc_loc_req_fsm, ctx, NULL, LOGL_DEBUG, "no-id");
+	struct osmo_fsm_inst *fi = osmo_fsm_inst_alloc(&smlc_loc_req_fsm, pool_chunk ? : ctx, NULL, LOGL_DEBUG,
+						       "no-id");
 	OSMO_ASSERT(fi);
 
 	smlc_loc_req = talloc(fi, struct smlc_loc_req);
@@ -87,61 +140,340 @@ static struct smlc_loc_req *smlc_loc_req_alloc(void *ctx)
 	fi->priv = smlc_loc_req;
 	*smlc_loc_req = (struct smlc_loc_req){
 		.fi = fi,
+		.pool_chunk = pool_chunk,
 	};
+	if (pool_chunk)
+		talloc_set_destructor(smlc_loc_req, smlc_loc_req_talloc_destructor);
+	g_smlc->loc_reqs_count++;
 
 	return smlc_loc_req;
 }
 
-static int smlc_loc_req_start(struct lb_conn *lb_conn, const struct bssmap_le_perform_loc_req *loc_req_pdu)
+/* If the Perform Location Request already contains the TA and the cell location is known, respond right away, without
+ * allocating an smlc_loc_req and its FSM. Return true if the request was handled. */
+static bool smlc_loc_req_fast_path(struct lb_conn *lb_conn, const struct smlc_loc_req_params *params)
 {
-	struct smlc_loc_req *smlc_loc_req;
+	struct bssmap_le_pdu bssmap_le;
+	struct osmo_gad location;
+	uint8_t ta;
 
-	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_DT1_PERFORM_LOCATION_REQUEST]);
+	if (!params->ta_present)
+		return false;
+	if (!g_smlc->cell_table)
+		return false;
+	ta = params->ta;
 
-	if (lb_conn->smlc_loc_req) {
-		/* Another request is already pending. If we send Perform Location Abort, the peer doesn't know which
-		 * request we would mean. Just drop this on the floor. */
-		LOG_SMLC_LOC_REQ(lb_conn->smlc_loc_req, LOGL_ERROR,
-				"Ignoring Perform Location Request, another request is still pending\n");
-		return -EAGAIN;
+	bssmap_le = (struct bssmap_le_pdu){
+		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
+		.perform_loc_resp = {
+			.location_estimate_present = true,
+		},
+	};
+
+	/* On any error, let the smlc_loc_req FSM take care of reporting the failure */
+	if (cell_table_location_estimate(g_smlc->cell_table, &bssmap_le.perform_loc_resp.location_estimate,
+					 &location, &params->cell_id, ta))
+		return false;
+
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_FAST_PATH]);
+	LOG_LB_CONN(lb_conn, LOGL_INFO, "Rx Perform Location Request with TA, returning location estimate to BSC:"
+		    " %s TA=%u --> %s\n",
+		    gsm0808_cell_id_name_c(OTC_SELECT, &params->cell_id), ta,
+		    osmo_gad_to_str_c(OTC_SELECT, &location));
+
+	if (lb_conn_send_bssmap_le(lb_conn, &bssmap_le)) {
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to encode/send BSSMAP-LE Perform Location Response\n");
+		return true;
 	}
+	if (lb_conn->smlc_subscr)
+		smlc_subscr_last_location_set(lb_conn->smlc_subscr, &params->cell_id, ta, &location,
+					      &bssmap_le.perform_loc_resp.location_estimate);
+	return true;
+}
 
-	if (loc_req_pdu->imsi.type == GSM_MI_TYPE_IMSI
-	    && (!lb_conn->smlc_subscr
-		|| osmo_mobile_identity_cmp(&loc_req_pdu->imsi, &lb_conn->smlc_subscr->imsi))) {
+/* Remember the TA and cell identity of a BSSLAP Reset on lb_conn, for later requests */
+static void smlc_loc_req_handover_ta_set(struct lb_conn *lb_conn, const struct bsslap_reset *reset)
+{
+	if (!g_smlc->handover_ta_max_age)
+		return;
+	lb_conn->handover_ta = (struct lb_conn_handover_ta){
+		.valid = true,
+		.ta = reset->ta,
+		.ci = reset->cell_id,
+	};
+	osmo_clock_gettime(CLOCK_MONOTONIC, &lb_conn->handover_ta.time);
+}
 
-		struct smlc_subscr *smlc_subscr;
-		struct lb_conn *other_conn;
-		smlc_subscr = smlc_subscr_find_or_create(&loc_req_pdu->imsi, __func__);
-		OSMO_ASSERT(smlc_subscr);
+/* If a BSSLAP Reset on this lb_conn recently told the TA in the cell that the request indicates, respond from that,
+ * without asking the BSC for the TA. Return true if the request was handled. */
+static bool smlc_loc_req_from_handover_ta(struct lb_conn *lb_conn, const struct smlc_loc_req_params *params)
+{
+	struct lb_conn_handover_ta *ho = &lb_conn->handover_ta;
+	struct osmo_cell_global_id cgi = {};
+	struct bssmap_le_pdu bssmap_le;
+	struct osmo_gad location;
+	struct timespec now;
+	struct timespec age;
+
+	if (!ho->valid || !g_smlc->cell_table)
+		return false;
+
+	osmo_clock_gettime(CLOCK_MONOTONIC, &now);
+	timespecsub(&now, &ho->time, &age);
+	if (age.tv_sec >= g_smlc->handover_ta_max_age) {
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_HANDOVER_TA_EXPIRED]);
+		ho->valid = false;
+		return false;
+	}
 
-		if (lb_conn->smlc_subscr && lb_conn->smlc_subscr != smlc_subscr) {
-			LOG_LB_CONN(lb_conn, LOGL_ERROR,
-				    "IMSI mismatch: lb_conn has %s, Rx Perform Location Request has %s\n",
-				    smlc_subscr_to_str_c(OTC_SELECT, lb_conn->smlc_subscr),
-				    smlc_subscr_to_str_c(OTC_SELECT, smlc_subscr));
-			smlc_subscr_put(smlc_subscr, __func__);
-			return -EINVAL;
-		}
+	/* The BSSLAP Reset only has the CI. If the request indicates another cell, the MS has moved on since. */
+	if (!(gsm0808_cell_id_to_cgi(&cgi, &params->cell_id) & CGI_PART_CI) || cgi.cell_identity != ho->ci) {
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_HANDOVER_TA_OTHER_CELL]);
+		return false;
+	}
 
-		/* Find another conn before setting this conn's subscriber */
-		other_conn = lb_conn_find_by_smlc_subscr(lb_conn->smlc_subscr, __func__);
+	bssmap_le = (struct bssmap_le_pdu){
+		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
+		.perform_loc_resp = {
+			.location_estimate_present = true,
+		},
+	};
 
-		/* Set the subscriber before logging about it, so that it shows as log context */
-		if (!lb_conn->smlc_subscr) {
-			lb_conn->smlc_subscr = smlc_subscr;
-			smlc_subscr_get(lb_conn->smlc_subscr, SMLC_SUBSCR_USE_LB_CONN);
-		}
+	/* On any error, let the smlc_loc_req FSM take care of reporting the failure */
+	if (cell_table_location_estimate(g_smlc->cell_table, &bssmap_le.perform_loc_resp.location_estimate,
+					 &location, &params->cell_id, ho->ta))
+		return false;
+
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_HANDOVER_TA_HIT]);
+	LOG_LB_CONN(lb_conn, LOGL_INFO, "Rx Perform Location Request, returning location from BSSLAP Reset %lu s ago:"
+		    " %s TA=%u --> %s\n", (unsigned long)age.tv_sec,
+		    gsm0808_cell_id_name_c(OTC_SELECT, &params->cell_id), ho->ta,
+		    osmo_gad_to_str_c(OTC_SELECT, &location));
+
+	if (lb_conn_send_bssmap_le(lb_conn, &bssmap_le)) {
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to encode/send BSSMAP-LE Perform Location Response\n");
+		return true;
+	}
+	if (lb_conn->smlc_subscr)
+		smlc_subscr_last_location_set(lb_conn->smlc_subscr, &params->cell_id, ho->ta, &location,
+					      &bssmap_le.perform_loc_resp.location_estimate);
+	return true;
+}
+
+/* If the subscriber's last known location is recent and accurate enough for this request, respond with it, without
+ * asking the BSC for the TA. Return true if the request was handled. */
+static bool smlc_loc_req_from_last_location(struct lb_conn *lb_conn, const struct smlc_loc_req_params *params)
+{
+	const struct smlc_subscr_last_location *last;
+	struct bssmap_le_pdu bssmap_le;
+
+	if (!lb_conn->smlc_subscr)
+		return false;
+	last = smlc_subscr_last_location_get(lb_conn->smlc_subscr, params);
+	if (!last)
+		return false;
+
+	bssmap_le = (struct bssmap_le_pdu){
+		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
+		.perform_loc_resp = {
+			.location_estimate_present = true,
+			.location_estimate = last->location_estimate,
+		},
+	};
+
+	LOG_LB_CONN(lb_conn, LOGL_INFO, "Rx Perform Location Request, returning last known location to BSC:"
+		    " %s TA=%u --> %s\n",
+		    gsm0808_cell_id_name_c(OTC_SELECT, &lb_conn->smlc_subscr->cell_id), last->ta,
+		    osmo_gad_to_str_c(OTC_SELECT, &last->location));
+
+	if (lb_conn_send_bssmap_le(lb_conn, &bssmap_le))
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to encode/send BSSMAP-LE Perform Location Response\n");
+	return true;
+}
+
+/* If the requester asked for a low delay response, and the radius of the indicated cell satisfies the requested
+ * horizontal accuracy, respond with a Location Estimate from the cell identity alone, without asking the BSC for the TA.
+ * Return true if the request was handled. */
+static bool smlc_loc_req_cell_id_only(struct lb_conn *lb_conn, const struct smlc_loc_req_params *params)
+{
+	struct bssmap_le_pdu bssmap_le;
+	struct osmo_gad location;
+	uint32_t cell_idx;
+	int32_t lat, lon;
+	uint32_t radius;
+	int rc;
+
+	if (g_smlc->cell_id_only != SMLC_CELL_ID_ONLY_LOW_DELAY)
+		return false;
+	if (!params->lcs_qos_present || params->lcs_qos.rt != LCS_QOS_RT_LOW_DELAY)
+		return false;
+	/* On unknown cells, let the smlc_loc_req FSM take care of reporting the failure */
+	if (cell_table_find(g_smlc->cell_table, &params->cell_id, &cell_idx, &lat, &lon, &radius))
+		return false;
+	if (!radius)
+		radius = g_smlc->cell_id_only_default_radius;
+	if (!radius)
+		return false;
+
+	cell_location_estimate_from_radius(&location, lat, lon, radius);
+	if (params->lcs_qos.ha_ind
+	    && location.ell_point_unc_circle.unc > osmo_gad_dec_unc(params->lcs_qos.ha_val)) {
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_CELL_ID_ONLY_INACCURATE]);
+		return false;
+	}
+
+	bssmap_le = (struct bssmap_le_pdu){
+		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
+		.perform_loc_resp = {
+			.location_estimate_present = true,
+		},
+	};
+	rc = osmo_gad_enc(&bssmap_le.perform_loc_resp.location_estimate, &location);
+	if (rc <= 0)
+		return false;
+
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_CELL_ID_ONLY]);
+	LOG_LB_CONN(lb_conn, LOGL_INFO, "Rx low delay Perform Location Request, returning cell location to BSC:"
+		    " %s --> %s\n",
+		    gsm0808_cell_id_name_c(OTC_SELECT, &params->cell_id),
+		    osmo_gad_to_str_c(OTC_SELECT, &location));
+
+	if (lb_conn_send_bssmap_le(lb_conn, &bssmap_le))
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to encode/send BSSMAP-LE Perform Location Response\n");
+	return true;
+}
+
+/* Answer with a failure right away, without an smlc_loc_req */
+static void smlc_loc_req_tx_failure(struct lb_conn *lb_conn, enum lcs_cause cause)
+{
+	struct bssmap_le_pdu bssmap_le = {
+		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
+		.perform_loc_resp = {
+			.lcs_cause = {
+				.present = true,
+				.cause_val = cause,
+			},
+		},
+	};
 
-		if (other_conn && other_conn != lb_conn) {
-			LOG_LB_CONN(lb_conn, LOGL_ERROR, "Another conn already active for this subscriber\n");
-			LOG_LB_CONN(other_conn, LOGL_ERROR, "Another conn opened for this subscriber, discarding\n");
-			lb_conn_close(other_conn);
+	if (lb_conn_send_bssmap_le(lb_conn, &bssmap_le))
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to encode/send BSSMAP-LE Perform Location Response\n");
+}
+
+static enum smlc_loc_req_prio smlc_loc_req_prio(const struct bssmap_le_perform_loc_req *loc_req_pdu)
+{
+	if (loc_req_pdu->lcs_client_type_present) {
+		/* The high nibble is the client category, the low nibble a subtype */
+		switch (loc_req_pdu->lcs_client_type & 0xf0) {
+		case BSSMAP_LE_LCS_CTYPE_EMERG_SVC_UNSPECIFIED:
+			return SMLC_LOC_REQ_PRIO_EMERGENCY;
+		case BSSMAP_LE_LCS_CTYPE_LI_UNSPECIFIED:
+			return SMLC_LOC_REQ_PRIO_HIGH;
+		default:
+			break;
 		}
+	}
+	if (loc_req_pdu->lcs_priority_present && loc_req_pdu->lcs_priority == LCS_PRIORITY_HIGHEST)
+		return SMLC_LOC_REQ_PRIO_HIGH;
+	return SMLC_LOC_REQ_PRIO_NORMAL;
+}
 
+/* Keep only what is used after receiving the request */
+static void smlc_loc_req_params_from_pdu(struct smlc_loc_req_params *params,
+					 const struct bssmap_le_perform_loc_req *loc_req_pdu)
+{
+	*params = (struct smlc_loc_req_params){
+		.location_type = loc_req_pdu->location_type,
+		.cell_id = loc_req_pdu->cell_id,
+		.lcs_qos_present = loc_req_pdu->lcs_qos_present,
+		.lcs_qos = loc_req_pdu->lcs_qos,
+		.prio = smlc_loc_req_prio(loc_req_pdu),
+	};
+	if (loc_req_pdu->apdu_present && loc_req_pdu->apdu.msg_type == BSSLAP_MSGT_TA_LAYER3) {
+		params->ta_present = true;
+		params->ta = loc_req_pdu->apdu.ta_layer3.ta;
+	}
+}
+
+/* Set the subscriber of lb_conn from the IMSI of a Perform Location Request, if the request has one */
+static int smlc_loc_req_set_subscr(struct lb_conn *lb_conn, const struct osmo_mobile_identity *imsi)
+{
+	struct smlc_subscr *smlc_subscr;
+	struct lb_conn *other_conn;
+
+	if (imsi->type != GSM_MI_TYPE_IMSI)
+		return 0;
+	if (lb_conn->smlc_subscr && !osmo_mobile_identity_cmp(imsi, &lb_conn->smlc_subscr->imsi))
+		return 0;
+
+	smlc_subscr = smlc_subscr_find_or_create(imsi, __func__);
+	OSMO_ASSERT(smlc_subscr);
+
+	if (lb_conn->smlc_subscr && lb_conn->smlc_subscr != smlc_subscr) {
+		LOG_LB_CONN(lb_conn, LOGL_ERROR,
+			    "IMSI mismatch: lb_conn has %s, Rx Perform Location Request has %s\n",
+			    smlc_subscr_to_str_c(OTC_SELECT, lb_conn->smlc_subscr),
+			    smlc_subscr_to_str_c(OTC_SELECT, smlc_subscr));
 		smlc_subscr_put(smlc_subscr, __func__);
-		if (other_conn)
-			lb_conn_put(other_conn, __func__);
+		return -EINVAL;
+	}
+
+	/* Find another conn before setting this conn's subscriber */
+	other_conn = lb_conn_find_by_smlc_subscr(smlc_subscr, __func__);
+
+	/* Set the subscriber before logging about it, so that it shows as log context */
+	if (!lb_conn->smlc_subscr) {
+		lb_conn->smlc_subscr = smlc_subscr;
+		smlc_subscr_get(lb_conn->smlc_subscr, SMLC_SUBSCR_USE_LB_CONN);
+	}
+	smlc_subscr->lb_conn = lb_conn;
+
+	if (other_conn && other_conn != lb_conn) {
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Another conn already active for this subscriber\n");
+		LOG_LB_CONN(other_conn, LOGL_ERROR, "Another conn opened for this subscriber, discarding\n");
+		lb_conn_close(other_conn);
+	}
+
+	smlc_subscr_put(smlc_subscr, __func__);
+	if (other_conn)
+		lb_conn_put(other_conn, __func__);
+	return 0;
+}
+
+/* Answer or start a Perform Location Request. Pass imsi to set the subscriber of lb_conn, or NULL if already done. */
+static int smlc_loc_req_start(struct lb_conn *lb_conn, const struct smlc_loc_req_params *params,
+			      const struct osmo_mobile_identity *imsi, const struct smlc_latency_stamps *rx_stamps)
+{
+	struct smlc_loc_req *smlc_loc_req;
+	struct smlc_latency_stamps stamps = *rx_stamps;
+	enum smlc_loc_req_prio prio = params->prio;
+
+	if (prio == SMLC_LOC_REQ_PRIO_NORMAL && g_smlc->overload->state >= SMLC_OVERLOAD_REJECT_NORMAL) {
+		LOG_LB_CONN(lb_conn, LOGL_NOTICE,
+			    "Rejecting Perform Location Request of normal priority, overload state %s\n",
+			    get_value_string(smlc_overload_state_names, g_smlc->overload->state));
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_OVERLOAD_LOCATION_REQUEST_REJECTED]);
+		smlc_loc_req_tx_failure(lb_conn, LCS_CAUSE_CONGESTION);
+		return 0;
+	}
+
+	/* Emergency requests are exempt from the rate limit */
+	if (prio != SMLC_LOC_REQ_PRIO_EMERGENCY && lb_conn->lb_peer && !lb_peer_admit_loc_req(lb_conn->lb_peer)) {
+		LOG_LB_CONN(lb_conn, LOGL_NOTICE,
+			    "Rejecting Perform Location Request, Lb peer exceeds the location request rate limit\n");
+		smlc_loc_req_tx_failure(lb_conn, LCS_CAUSE_CONGESTION);
+		return 0;
+	}
+
+	if (imsi && smlc_loc_req_set_subscr(lb_conn, imsi))
+		return -EINVAL;
+
+	if (smlc_loc_req_fast_path(lb_conn, params)
+	    || smlc_loc_req_from_handover_ta(lb_conn, params)
+	    || smlc_loc_req_from_last_location(lb_conn, params)
+	    || smlc_loc_req_cell_id_only(lb_conn, params)) {
+		smlc_latency_record(lb_conn->lb_peer, prio, &stamps);
+		return 0;
 	}
 
 	/* smlc_loc_req has a use count on lb_conn, so its talloc ctx must not be a child of lb_conn. (Otherwise an
@@ -151,41 +483,198 @@ static int smlc_loc_req_start(struct lb_conn *lb_conn, const struct bssmap_le_pe
 
 	*smlc_loc_req = (struct smlc_loc_req){
 		.fi = smlc_loc_req->fi,
+		.pool_chunk = smlc_loc_req->pool_chunk,
 		.lb_conn = lb_conn,
-		.req = *loc_req_pdu,
+		.params = *params,
+		.stamps = stamps,
 	};
-	smlc_loc_req->latest_cell_id = loc_req_pdu->cell_id;
+	timer_wheel_timer_setup(&smlc_loc_req->timeout, smlc_loc_req_timeout_cb, smlc_loc_req);
+	smlc_loc_req->latest_cell_id = params->cell_id;
+	smlc_loc_req->cell_table = g_smlc->cell_table;
+	if (smlc_loc_req->cell_table)
+		cell_table_get(smlc_loc_req->cell_table, CELL_TABLE_USE_SMLC_LOC_REQ);
 	lb_conn->smlc_loc_req = smlc_loc_req;
 	lb_conn_get(smlc_loc_req->lb_conn, LB_CONN_USE_SMLC_LOC_REQ);
 
-	LOG_LB_CONN(lb_conn, LOGL_INFO, "Rx Perform Location Request (BSSLAP APDU %s), cell id is %s\n",
-		    loc_req_pdu->apdu_present ?
-		    osmo_bsslap_msgt_name(loc_req_pdu->apdu.msg_type) : "omitted",
+	LOG_LB_CONN(lb_conn, LOGL_INFO, "Rx Perform Location Request (%s TA), cell id is %s\n",
+		    params->ta_present ? "with" : "without",
 		    gsm0808_cell_id_name_c(OTC_SELECT, &smlc_loc_req->latest_cell_id));
 
-	/* state change to start the timeout */
-	smlc_loc_req_fsm_state_chg(smlc_loc_req->fi, SMLC_LOC_REQ_ST_WAIT_TA);
+	switch (smlc_admission_request(g_smlc->admission, &smlc_loc_req->admission, prio)) {
+	case SMLC_ADMISSION_START:
+		/* state change to start the timeout */
+		smlc_loc_req_fsm_state_chg(smlc_loc_req->fi, SMLC_LOC_REQ_ST_WAIT_TA);
+		break;
+	case SMLC_ADMISSION_QUEUED:
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_QUEUED]);
+		LOG_SMLC_LOC_REQ(smlc_loc_req, LOGL_DEBUG, "Waiting in the admission queue with %s priority\n",
+				 get_value_string(smlc_loc_req_prio_names, prio));
+		/* Do not start a request the BSC has given up on already. The timeout stays in state INIT, so it is not in
+		 * smlc_loc_req_fsm_timeouts; the state change on admission replaces it. */
+		smlc_loc_req->fi->T = -16;
+		timer_wheel_schedule(g_smlc->timer_wheel, &smlc_loc_req->timeout,
+				     osmo_tdef_get(g_smlc_tdefs, -16, OSMO_TDEF_MS, -1));
+		break;
+	case SMLC_ADMISSION_REJECTED:
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_CONGESTION]);
+		smlc_loc_req_fail(LCS_CAUSE_CONGESTION, "Admission queue exceeds the max backlog for %s priority",
+				  get_value_string(smlc_loc_req_prio_names, prio));
+		break;
+	}
+	return 0;
+}
+
+/* Another request is already pending on lb_conn. Queue this one behind it, to be answered from the same TA. */
+static int smlc_loc_req_enqueue(struct lb_conn *lb_conn, const struct smlc_loc_req_params *params,
+				const struct osmo_mobile_identity *imsi, const struct smlc_latency_stamps *rx_stamps)
+{
+	struct smlc_loc_req_queued *q;
+
+	if (lb_conn->loc_req_queue_len >= g_smlc->loc_req_pipeline_depth) {
+		/* If we send Perform Location Abort, the peer doesn't know which request we would mean. Just drop this
+		 * on the floor. */
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_PIPELINE_FULL]);
+		LOG_SMLC_LOC_REQ(lb_conn->smlc_loc_req, LOGL_ERROR,
+				 "Ignoring Perform Location Request, another request and %u queued ones are still pending\n",
+				 lb_conn->loc_req_queue_len);
+		return -EAGAIN;
+	}
+
+	/* Only the params are kept while queued, so check the IMSI now */
+	if (smlc_loc_req_set_subscr(lb_conn, imsi))
+		return -EINVAL;
+
+	q = talloc(lb_conn, struct smlc_loc_req_queued);
+	OSMO_ASSERT(q);
+	*q = (struct smlc_loc_req_queued){
+		.params = *params,
+		.stamps = *rx_stamps,
+	};
+	llist_add_tail(&q->entry, &lb_conn->loc_req_queue);
+	lb_conn->loc_req_queue_len++;
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_PIPELINED]);
+	LOG_SMLC_LOC_REQ(lb_conn->smlc_loc_req, LOGL_INFO,
+			 "Rx Perform Location Request while another one is pending, %u queued\n",
+			 lb_conn->loc_req_queue_len);
 	return 0;
 }
 
-static int handle_bssmap_le_conn_oriented_info(struct smlc_loc_req *smlc_loc_req,
+static struct smlc_loc_req_queued *smlc_loc_req_dequeue(struct lb_conn *lb_conn)
+{
+	struct smlc_loc_req_queued *q = llist_first_entry_or_null(&lb_conn->loc_req_queue, struct smlc_loc_req_queued,
+								   entry);
+	if (!q)
+		return NULL;
+	llist_del(&q->entry);
+	lb_conn->loc_req_queue_len--;
+	return q;
+}
+
+/* Drop all queued requests without answering them, e.g. on Perform Location Abort */
+static void smlc_loc_req_flush_queued(struct lb_conn *lb_conn)
+{
+	struct smlc_loc_req_queued *q;
+
+	if (lb_conn->loc_req_queue_len)
+		LOG_LB_CONN(lb_conn, LOGL_INFO, "Discarding %u queued Perform Location Requests\n",
+			    lb_conn->loc_req_queue_len);
+	while ((q = smlc_loc_req_dequeue(lb_conn)))
+		talloc_free(q);
+}
+
+/* The MS has not moved since the queued requests were received: answer them all with the same Perform Location
+ * Response that the pending request just got, instead of asking for the TA again for each. */
+static void smlc_loc_req_coalesce_queued(struct lb_conn *lb_conn, const struct bssmap_le_pdu *resp)
+{
+	struct smlc_loc_req_queued *q;
+
+	while ((q = smlc_loc_req_dequeue(lb_conn))) {
+		if (lb_conn_send_bssmap_le(lb_conn, resp)) {
+			LOG_LB_CONN(lb_conn, LOGL_ERROR, "Unable to encode/send BSSMAP-LE Perform Location Response\n");
+		} else {
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_REQUEST_COALESCED]);
+			smlc_latency_record(lb_conn->lb_peer, q->params.prio, &q->stamps);
+		}
+		talloc_free(q);
+	}
+}
+
+/* The pending request ended without a location. Start the queued requests one by one, until one stays pending. */
+static void smlc_loc_req_start_queued(struct lb_conn *lb_conn)
+{
+	struct smlc_loc_req_queued *q;
+
+	while (!lb_conn->smlc_loc_req && (q = smlc_loc_req_dequeue(lb_conn))) {
+		LOG_LB_CONN(lb_conn, LOGL_DEBUG, "Starting queued Perform Location Request, %u more queued\n",
+			    lb_conn->loc_req_queue_len);
+		smlc_loc_req_start(lb_conn, &q->params, NULL, &q->stamps);
+		talloc_free(q);
+	}
+}
+
+static int smlc_loc_req_rx_perform_loc_req(struct lb_conn *lb_conn, const struct bssmap_le_perform_loc_req *loc_req_pdu)
+{
+	struct smlc_latency_stamps stamps = {};
+	struct smlc_loc_req_params params;
+
+	smlc_latency_stamp(&stamps.rx_req);
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_DT1_PERFORM_LOCATION_REQUEST]);
+
+	smlc_loc_req_params_from_pdu(&params, loc_req_pdu);
+	if (lb_conn->smlc_loc_req)
+		return smlc_loc_req_enqueue(lb_conn, &params, &loc_req_pdu->imsi, &stamps);
+	return smlc_loc_req_start(lb_conn, &params, &loc_req_pdu->imsi, &stamps);
+}
+
+/* g_smlc->admission lets a queued request start */
+void smlc_loc_req_admitted(struct smlc_admission_entry *e)
+{
+	struct smlc_loc_req *smlc_loc_req = container_of(e, struct smlc_loc_req, admission);
+
+	smlc_latency_stamp(&smlc_loc_req->stamps.dequeued);
+	smlc_loc_req_fsm_state_chg(smlc_loc_req->fi, SMLC_LOC_REQ_ST_WAIT_TA);
+}
+
+static int handle_bssmap_le_conn_oriented_info(struct lb_conn *lb_conn,
 					       const struct bssmap_le_conn_oriented_info *coi)
 {
+	struct smlc_loc_req *smlc_loc_req = lb_conn->smlc_loc_req;
+
+	/* A BSSLAP Reset also tells the TA after a handover when no request is pending */
+	if (coi->apdu.msg_type == BSSLAP_MSGT_RESET)
+		smlc_loc_req_handover_ta_set(lb_conn, &coi->apdu.reset);
+
+	if (!smlc_loc_req) {
+		if (coi->apdu.msg_type == BSSLAP_MSGT_RESET) {
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_DT1_BSSLAP_RESET]);
+			LOG_LB_CONN(lb_conn, LOGL_INFO, "Rx BSSLAP Reset without a pending location request: CI=%u TA=%u\n",
+				    coi->apdu.reset.cell_id, coi->apdu.reset.ta);
+			return 0;
+		}
+		LOG_LB_CONN(lb_conn, LOGL_ERROR, "Rx BSSLAP %s, but no location request is pending\n",
+			    osmo_bsslap_msgt_name(coi->apdu.msg_type));
+		return -EINVAL;
+	}
+
 	switch (coi->apdu.msg_type) {
 
 	case BSSLAP_MSGT_TA_RESPONSE:
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_DT1_BSSLAP_TA_RESPONSE]);
 		return osmo_fsm_inst_dispatch(smlc_loc_req->fi, SMLC_LOC_REQ_EV_RX_TA_RESPONSE,
 					      (void*)&coi->apdu.ta_response);
 
 	case BSSLAP_MSGT_RESET:
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_DT1_BSSLAP_RESET]);
 		return osmo_fsm_inst_dispatch(smlc_loc_req->fi, SMLC_LOC_REQ_EV_RX_BSSLAP_RESET,
 					      (void*)&coi->apdu.reset);
 
 	case BSSLAP_MSGT_ABORT:
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_DT1_BSSLAP_ABORT]);
 		smlc_loc_req_fail(LCS_CAUSE_REQUEST_ABORTED, "Aborting Location Request due to BSSLAP Abort");
 		return 0;
 
 	case BSSLAP_MSGT_REJECT:
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_BSSMAP_LE_RX_DT1_BSSLAP_REJECT]);
 		smlc_loc_req_fail(LCS_CAUSE_REQUEST_ABORTED, "Aborting Location Request due to BSSLAP Reject");
 		return 0;
 
@@ -211,14 +700,20 @@ int smlc_loc_req_rx_bssap_le(struct lb_conn *lb_conn, const struct bssap_le_pdu
 	switch (bssmap_le->msg_type) {
 
 	case BSSMAP_LE_MSGT_PERFORM_LOC_REQ:
-		return smlc_loc_req_start(lb_conn, &bssmap_le->perform_loc_req);
+		return smlc_loc_req_rx_perform_loc_req(lb_conn, &bssmap_le->perform_loc_req);
 
 	case BSSMAP_LE_MSGT_PERFORM_LOC_ABORT:
+		/* The peer cannot tell the pending request from the queued ones, abort them all */
+		smlc_loc_req_flush_queued(lb_conn);
+		if (!smlc_loc_req) {
+			LOG_LB_CONN(lb_conn, LOGL_NOTICE, "Rx Perform Location Abort, but no location request is pending\n");
+			return 0;
+		}
 		return osmo_fsm_inst_dispatch(smlc_loc_req->fi, SMLC_LOC_REQ_EV_RX_LE_PERFORM_LOCATION_ABORT,
 					      (void*)&bssmap_le->perform_loc_abort);
 
 	case BSSMAP_LE_MSGT_CONN_ORIENTED_INFO:
-		return handle_bssmap_le_conn_oriented_info(smlc_loc_req, &bssmap_le->conn_oriented_info);
+		return handle_bssmap_le_conn_oriented_info(lb_conn, &bssmap_le->conn_oriented_info);
 
 	default:
 		LOG_SMLC_LOC_REQ(smlc_loc_req, LOGL_ERROR, "Rx BSSMAP-LE from SMLC with unsupported message type: %s\n",
@@ -230,43 +725,44 @@ int smlc_loc_req_rx_bssap_le(struct lb_conn *lb_conn, const struct bssap_le_pdu
 void smlc_loc_req_reset(struct lb_conn *lb_conn)
 {
 	struct smlc_loc_req *smlc_loc_req = lb_conn->smlc_loc_req;
+	smlc_loc_req_flush_queued(lb_conn);
 	if (!smlc_loc_req)
 		return;
 	smlc_loc_req_fail(LCS_CAUSE_SYSTEM_FAILURE, "Aborting Location Request due to RESET on Lb");
 }
 
-static int smlc_loc_req_fsm_timer_cb(struct osmo_fsm_inst *fi)
+static void smlc_loc_req_init_action(struct osmo_fsm_inst *fi, uint32_t event, void *data)
 {
 	struct smlc_loc_req *smlc_loc_req = fi->priv;
-	smlc_loc_req_fail(LCS_CAUSE_SYSTEM_FAILURE, "Timeout");
-	return 1;
+
+	switch (event) {
+
+	case SMLC_LOC_REQ_EV_RX_LE_PERFORM_LOCATION_ABORT:
+		LOG_SMLC_LOC_REQ(smlc_loc_req, LOGL_INFO, "Rx Perform Location Abort while waiting in the admission queue\n");
+		osmo_fsm_inst_term(fi, OSMO_FSM_TERM_REQUEST, NULL);
+		return;
+
+	default:
+		OSMO_ASSERT(false);
+	}
 }
 
 static void smlc_loc_req_wait_ta_onenter(struct osmo_fsm_inst *fi, uint32_t prev_state)
 {
 	struct smlc_loc_req *smlc_loc_req = fi->priv;
-	struct bssmap_le_pdu bssmap_le;
 
 	/* Did the original request contain a TA already? */
-	if (smlc_loc_req->req.apdu_present && smlc_loc_req->req.apdu.msg_type == BSSLAP_MSGT_TA_LAYER3) {
+	if (smlc_loc_req->params.ta_present) {
 		smlc_loc_req->ta_present = true;
-		smlc_loc_req->ta = smlc_loc_req->req.apdu.ta_layer3.ta;
+		smlc_loc_req->ta = smlc_loc_req->params.ta;
 		LOG_SMLC_LOC_REQ(smlc_loc_req, LOGL_INFO, "TA = %u\n", smlc_loc_req->ta);
 		smlc_loc_req_fsm_state_chg(smlc_loc_req->fi, SMLC_LOC_REQ_ST_GOT_TA);
 		return;
 	}
 
-	/* No TA known yet, ask via BSSLAP */
-	bssmap_le = (struct bssmap_le_pdu){
-		.msg_type = BSSMAP_LE_MSGT_CONN_ORIENTED_INFO,
-		.conn_oriented_info = {
-			.apdu = {
-				.msg_type = BSSLAP_MSGT_TA_REQUEST,
-			},
-		},
-	};
-
-	lb_conn_send_bssmap_le(smlc_loc_req->lb_conn, &bssmap_le);
+	/* No TA known yet, ask via BSSLAP. The TA Request never changes, send it from the template cache. */
+	smlc_latency_stamp(&smlc_loc_req->stamps.tx_ta_req);
+	lb_conn_send_tmpl(smlc_loc_req->lb_conn, LB_MSGB_TMPL_TA_REQUEST);
 }
 
 static void update_ci(struct gsm0808_cell_id *cell_id, int16_t new_ci)
@@ -294,6 +790,11 @@ static void smlc_loc_req_wait_ta_action(struct osmo_fsm_inst *fi, uint32_t event
 
 	case SMLC_LOC_REQ_EV_RX_TA_RESPONSE:
 		ta_response = data;
+		smlc_latency_stamp(&smlc_loc_req->stamps.rx_ta);
+		if (smlc_loc_req->lb_conn->lb_peer)
+			ta_rtt_sample(&smlc_loc_req->lb_conn->lb_peer->ta_rtt,
+				      smlc_latency_stamp_diff_us(&smlc_loc_req->stamps.rx_ta,
+								 &smlc_loc_req->stamps.tx_ta_req));
 		smlc_loc_req->ta_present = true;
 		smlc_loc_req->ta = ta_response->ta;
 		update_ci(&smlc_loc_req->latest_cell_id, ta_response->cell_id);
@@ -304,6 +805,7 @@ static void smlc_loc_req_wait_ta_action(struct osmo_fsm_inst *fi, uint32_t event
 
 	case SMLC_LOC_REQ_EV_RX_BSSLAP_RESET:
 		reset = data;
+		smlc_latency_stamp(&smlc_loc_req->stamps.rx_ta);
 		smlc_loc_req->ta_present = true;
 		smlc_loc_req->ta = reset->ta;
 		update_ci(&smlc_loc_req->latest_cell_id, reset->cell_id);
@@ -322,10 +824,65 @@ static void smlc_loc_req_wait_ta_action(struct osmo_fsm_inst *fi, uint32_t event
 	}
 }
 
+/* Send the Perform Location Response, and end the request */
+static void smlc_loc_req_respond(struct smlc_loc_req *smlc_loc_req, const union gad_raw *location_estimate,
+				 const struct osmo_gad *location)
+{
+	struct bssmap_le_pdu bssmap_le = {
+		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
+		.perform_loc_resp = {
+			.location_estimate_present = true,
+			.location_estimate = *location_estimate,
+		},
+	};
+
+	LOG_SMLC_LOC_REQ(smlc_loc_req, LOGL_INFO, "Returning location estimate to BSC: %s TA=%u --> %s\n",
+			 gsm0808_cell_id_name_c(OTC_SELECT, &smlc_loc_req->latest_cell_id),
+			 smlc_loc_req->ta, osmo_gad_to_str_c(OTC_SELECT, location));
+
+	if (lb_conn_send_bssmap_le(smlc_loc_req->lb_conn, &bssmap_le)) {
+		smlc_loc_req_fail(LCS_CAUSE_SYSTEM_FAILURE,
+				  "Unable to encode/send BSSMAP-LE Perform Location Response");
+		return;
+	}
+	smlc_latency_record(smlc_loc_req->lb_conn->lb_peer, smlc_loc_req->admission.prio, &smlc_loc_req->stamps);
+	smlc_loc_req_coalesce_queued(smlc_loc_req->lb_conn, &bssmap_le);
+	if (smlc_loc_req->lb_conn->smlc_subscr)
+		smlc_subscr_last_location_set(smlc_loc_req->lb_conn->smlc_subscr, &smlc_loc_req->latest_cell_id,
+					      smlc_loc_req->ta, location, &bssmap_le.perform_loc_resp.location_estimate);
+	osmo_fsm_inst_term(smlc_loc_req->fi, OSMO_FSM_TERM_REGULAR, NULL);
+}
+
+/* A location estimate was computed, inline or on a positioning thread: cache and send it */
+static void smlc_loc_req_pos_result(struct smlc_loc_req *smlc_loc_req, const struct smlc_pos_job *job)
+{
+	if (job->rc) {
+		smlc_loc_req_fail(LCS_CAUSE_FACILITY_NOTSUPP, "Unable to encode Location Estimate for %s (rc=%d)",
+				  gsm0808_cell_id_name_c(OTC_SELECT, &smlc_loc_req->latest_cell_id), job->rc);
+		return;
+	}
+	cell_table_estimate_add(smlc_loc_req->cell_table, smlc_loc_req->cell_idx, smlc_loc_req->ta,
+				&job->location_estimate, job->location_estimate_len, &job->location);
+	smlc_loc_req_respond(smlc_loc_req, &job->location_estimate, &job->location);
+}
+
+/* On the main thread, when a positioning thread is done with a job */
+static void smlc_loc_req_pos_done(struct smlc_pos_job *job)
+{
+	struct smlc_loc_req *smlc_loc_req = job->priv;
+
+	/* The request ended meanwhile, see smlc_loc_req_fsm_cleanup() */
+	if (!smlc_loc_req)
+		return;
+	osmo_fsm_inst_dispatch(smlc_loc_req->fi, SMLC_LOC_REQ_EV_POS_RESULT, job);
+}
+
 static void smlc_loc_req_got_ta_onenter(struct osmo_fsm_inst *fi, uint32_t prev_state)
 {
 	struct smlc_loc_req *smlc_loc_req = fi->priv;
-	struct bssmap_le_pdu bssmap_le;
+	struct smlc_pos_job *pos_job;
+	struct smlc_pos_job job = {};
+	union gad_raw location_estimate;
 	struct osmo_gad location;
 	int rc;
 
@@ -335,38 +892,70 @@ static void smlc_loc_req_got_ta_onenter(struct osmo_fsm_inst *fi, uint32_t prev_
 		return;
 	}
 
-	bssmap_le = (struct bssmap_le_pdu){
-		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
-		.perform_loc_resp = {
-			.location_estimate_present = true,
-		},
-	};
-
-	rc = cell_location_from_ta(&location, &smlc_loc_req->latest_cell_id, smlc_loc_req->ta);
+	rc = cell_table_find(smlc_loc_req->cell_table, &smlc_loc_req->latest_cell_id, &smlc_loc_req->cell_idx,
+			     &job.lat, &job.lon, &job.radius);
 	if (rc) {
 		smlc_loc_req_fail(LCS_CAUSE_FACILITY_NOTSUPP, "Unable to compose Location Estimate for %s: %s",
 				  gsm0808_cell_id_name_c(OTC_SELECT, &smlc_loc_req->latest_cell_id),
-				  rc == -ENOENT ? "No location information for this cell" : "unknown error");
+				  "No location information for this cell");
 		return;
 	}
+	job.ta = smlc_loc_req->ta;
 
-	rc = osmo_gad_enc(&bssmap_le.perform_loc_resp.location_estimate, &location);
-	if (rc <= 0) {
-		smlc_loc_req_fail(LCS_CAUSE_FACILITY_NOTSUPP, "Unable to encode Location Estimate for %s (rc=%d)",
-				  gsm0808_cell_id_name_c(OTC_SELECT, &smlc_loc_req->latest_cell_id), rc);
+	if (cell_table_estimate_cached(smlc_loc_req->cell_table, smlc_loc_req->cell_idx, smlc_loc_req->ta,
+				       &location_estimate, &location)) {
+		smlc_loc_req_respond(smlc_loc_req, &location_estimate, &location);
 		return;
 	}
 
-	LOG_SMLC_LOC_REQ(smlc_loc_req, LOGL_INFO, "Returning location estimate to BSC: %s TA=%u --> %s\n",
-			 gsm0808_cell_id_name_c(OTC_SELECT, &smlc_loc_req->latest_cell_id),
-			 smlc_loc_req->ta, osmo_gad_to_str_c(OTC_SELECT, &location));
+	if (g_smlc->pos_workers) {
+		pos_job = smlc_pos_job_alloc(g_smlc, smlc_loc_req_pos_done, smlc_loc_req);
+		pos_job->lat = job.lat;
+		pos_job->lon = job.lon;
+		pos_job->radius = job.radius;
+		pos_job->ta = job.ta;
+		if (!smlc_pos_submit(g_smlc->pos_workers, smlc_loc_req->lb_conn->sccp_conn_id, pos_job,
+				     g_smlc->positioning_deadline_ms)) {
+			smlc_loc_req->pos_job = pos_job;
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_POSITIONING_POOLED]);
+			/* Continues in smlc_loc_req_computing_action() */
+			smlc_loc_req_fsm_state_chg(fi, SMLC_LOC_REQ_ST_COMPUTING);
+			return;
+		}
+		/* The thread is a full queue behind. Compute here rather than make the main loop wait for it. */
+		talloc_free(pos_job);
+	}
 
-	if (lb_conn_send_bssmap_le(smlc_loc_req->lb_conn, &bssmap_le)) {
-		smlc_loc_req_fail(LCS_CAUSE_SYSTEM_FAILURE,
-				  "Unable to encode/send BSSMAP-LE Perform Location Response");
+	job.rc = smlc_pos_compute(&job);
+	smlc_loc_req_pos_result(smlc_loc_req, &job);
+}
+
+static void smlc_loc_req_computing_action(struct osmo_fsm_inst *fi, uint32_t event, void *data)
+{
+	struct smlc_loc_req *smlc_loc_req = fi->priv;
+	const struct smlc_pos_job *job;
+
+	switch (event) {
+
+	case SMLC_LOC_REQ_EV_POS_RESULT:
+		job = data;
+		smlc_loc_req->pos_job = NULL;
+		if (job->rc == -ETIMEDOUT) {
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_POSITIONING_EXPIRED]);
+			smlc_loc_req_fail(LCS_CAUSE_SYSTEM_FAILURE, "Positioning thread missed the deadline");
+			return;
+		}
+		smlc_loc_req_pos_result(smlc_loc_req, job);
 		return;
+
+	case SMLC_LOC_REQ_EV_RX_LE_PERFORM_LOCATION_ABORT:
+		LOG_SMLC_LOC_REQ(smlc_loc_req, LOGL_INFO, "Rx Perform Location Abort while computing the location\n");
+		osmo_fsm_inst_term(fi, OSMO_FSM_TERM_REQUEST, NULL);
+		return;
+
+	default:
+		OSMO_ASSERT(false);
 	}
-	osmo_fsm_inst_term(fi, OSMO_FSM_TERM_REGULAR, NULL);
 }
 
 static void smlc_loc_req_failed_onenter(struct osmo_fsm_inst *fi, uint32_t prev_state)
@@ -380,16 +969,34 @@ static void smlc_loc_req_failed_onenter(struct osmo_fsm_inst *fi, uint32_t prev_
 	};
 	int rc;
 	rc = lb_conn_send_bssmap_le(smlc_loc_req->lb_conn, &bssmap_le);
+	if (!rc)
+		smlc_latency_record(smlc_loc_req->lb_conn->lb_peer, smlc_loc_req->admission.prio,
+				    &smlc_loc_req->stamps);
 	osmo_fsm_inst_term(fi, rc ? OSMO_FSM_TERM_ERROR : OSMO_FSM_TERM_REGULAR, NULL);
 }
 
 void smlc_loc_req_fsm_cleanup(struct osmo_fsm_inst *fi, enum osmo_fsm_term_cause cause)
 {
 	struct smlc_loc_req *smlc_loc_req = fi->priv;
+	timer_wheel_del(&smlc_loc_req->timeout);
+	/* Drop the result of a job still on a positioning thread */
+	if (smlc_loc_req->pos_job) {
+		smlc_loc_req->pos_job->priv = NULL;
+		smlc_loc_req->pos_job = NULL;
+	}
+	smlc_admission_release(g_smlc->admission, &smlc_loc_req->admission);
+	g_smlc->loc_reqs_count--;
 	if (smlc_loc_req->lb_conn && smlc_loc_req->lb_conn->smlc_loc_req == smlc_loc_req) {
 		smlc_loc_req->lb_conn->smlc_loc_req = NULL;
+		/* Serve the next queued request, still holding our use count so that the lb_conn stays around */
+		if (!smlc_loc_req->lb_conn->closing)
+			smlc_loc_req_start_queued(smlc_loc_req->lb_conn);
 		lb_conn_put(smlc_loc_req->lb_conn, LB_CONN_USE_SMLC_LOC_REQ);
 	}
+	if (smlc_loc_req->cell_table) {
+		cell_table_put(smlc_loc_req->cell_table, CELL_TABLE_USE_SMLC_LOC_REQ);
+		smlc_loc_req->cell_table = NULL;
+	}
 }
 
 #define S(x)    (1 << (x))
@@ -397,10 +1004,14 @@ void smlc_loc_req_fsm_cleanup(struct osmo_fsm_inst *fi, enum osmo_fsm_term_cause
 static const struct osmo_fsm_state smlc_loc_req_fsm_states[] = {
 	[SMLC_LOC_REQ_ST_INIT] = {
 		.name = "INIT",
+		.in_event_mask = 0
+			| S(SMLC_LOC_REQ_EV_RX_LE_PERFORM_LOCATION_ABORT)
+			,
 		.out_state_mask = 0
 			| S(SMLC_LOC_REQ_ST_WAIT_TA)
 			| S(SMLC_LOC_REQ_ST_FAILED)
 			,
+		.action = smlc_loc_req_init_action,
 	},
 	[SMLC_LOC_REQ_ST_WAIT_TA] = {
 		.name = "WAIT_TA",
@@ -419,10 +1030,22 @@ static const struct osmo_fsm_state smlc_loc_req_fsm_states[] = {
 	[SMLC_LOC_REQ_ST_GOT_TA] = {
 		.name = "GOT_TA",
 		.out_state_mask = 0
+			| S(SMLC_LOC_REQ_ST_COMPUTING)
 			| S(SMLC_LOC_REQ_ST_FAILED)
 			,
 		.onenter = smlc_loc_req_got_ta_onenter,
 	},
+	[SMLC_LOC_REQ_ST_COMPUTING] = {
+		.name = "COMPUTING",
+		.in_event_mask = 0
+			| S(SMLC_LOC_REQ_EV_POS_RESULT)
+			| S(SMLC_LOC_REQ_EV_RX_LE_PERFORM_LOCATION_ABORT)
+			,
+		.out_state_mask = 0
+			| S(SMLC_LOC_REQ_ST_FAILED)
+			,
+		.action = smlc_loc_req_computing_action,
+	},
 	[SMLC_LOC_REQ_ST_FAILED] = {
 		.name = "FAILED",
 		.onenter = smlc_loc_req_failed_onenter,
@@ -435,7 +1058,6 @@ static struct osmo_fsm smlc_loc_req_fsm = {
 	.num_states = ARRAY_SIZE(smlc_loc_req_fsm_states),
 	.log_subsys = DLCS,
 	.event_names = smlc_loc_req_fsm_event_names,
-	.timer_cb = smlc_loc_req_fsm_timer_cb,
 	.cleanup = smlc_loc_req_fsm_cleanup,
 };
 
@@ -443,3 +1065,21 @@ static __attribute__((constructor)) void smlc_loc_req_fsm_register(void)
 {
 	OSMO_ASSERT(osmo_fsm_register(&smlc_loc_req_fsm) == 0);
 }
+
+/* Compute location estimates on g_smlc->positioning_threads worker threads, or on the main thread if that is 0. Jobs
+ * already handed to the previous threads are still completed. */
+void smlc_loc_req_positioning_restart(void)
+{
+	struct smlc_workers *old = g_smlc->pos_workers;
+
+	g_smlc->pos_workers = NULL;
+	smlc_workers_free(old);
+
+	if (!g_smlc->positioning_threads)
+		return;
+	g_smlc->pos_workers = smlc_workers_alloc(g_smlc, "positioning", g_smlc->positioning_threads,
+						 SMLC_POS_QUEUE_LEN);
+	if (!g_smlc->pos_workers)
+		LOGP(DLCS, LOGL_ERROR, "Cannot start %u positioning threads, computing on the main thread\n",
+		     g_smlc->positioning_threads);
+}
@@ -40,11 +40,21 @@
 #include <osmocom/smlc/smlc_data.h>
 #include <osmocom/smlc/sccp_lb_inst.h>
 #include <osmocom/smlc/cell_locations.h>
+#include <osmocom/smlc/cell_table.h>
+#include <osmocom/smlc/lb_conn.h>
+#include <osmocom/smlc/lb_msgb.h>
+#include <osmocom/smlc/smlc_loc_req.h>
+#include <osmocom/smlc/smlc_pool.h>
+#include <osmocom/smlc/timer_wheel.h>
+#include <osmocom/smlc/smlc_admission.h>
+#include <osmocom/smlc/smlc_overload.h>
+#include <osmocom/smlc/smlc_vty.h>
 
 #define _GNU_SOURCE
 #include <getopt.h>
 
 #include <signal.h>
+#include <sys/signalfd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -192,6 +202,19 @@ static void signal_handler(int signal)
 	}
 }
 
+/* Signals that do more than logging are handled from the main loop, see osmo_signalfd_setup() */
+static void signalfd_cb(struct osmo_signalfd *osfd, const struct signalfd_siginfo *fdsi)
+{
+	switch (fdsi->ssi_signo) {
+	case SIGHUP:
+		LOGP(DSMLC, LOGL_NOTICE, "SIGHUP received, reloading cell locations\n");
+		cell_table_rebuild();
+		break;
+	default:
+		break;
+	}
+}
+
 static const struct log_info_cat smlc_categories[] = {
 	[DSMLC] = {
 		.name = "DSMLC",
@@ -224,6 +247,7 @@ int main(int argc, char **argv)
 {
 	int rc;
 	int default_pc;
+	sigset_t sigset;
 
 	tall_smlc_ctx = talloc_named_const(NULL, 1, "osmo-smlc");
 	msgb_talloc_ctx_init(tall_smlc_ctx, 0);
@@ -238,6 +262,16 @@ int main(int argc, char **argv)
 	osmo_fsm_set_dealloc_ctx(OTC_SELECT);
 
 	g_smlc = smlc_state_alloc(tall_smlc_ctx);
+	g_smlc->cell_locations = cell_locations_alloc(g_smlc);
+	g_smlc->lb_conn_pool = smlc_pool_alloc(g_smlc, "lb-conn", LB_CONN_POOL_CHUNK_SIZE,
+					       SMLC_POOL_DEFAULT_SIZE, SMLC_POOL_DEFAULT_HIGH_WATER_MARK);
+	g_smlc->loc_req_pool = smlc_pool_alloc(g_smlc, "location-request", SMLC_LOC_REQ_POOL_CHUNK_SIZE,
+					       SMLC_POOL_DEFAULT_SIZE, SMLC_POOL_DEFAULT_HIGH_WATER_MARK);
+	g_smlc->lb_msgb_pool = smlc_pool_alloc(g_smlc, "lb-msgb", LB_MSGB_POOL_CHUNK_SIZE,
+					       LB_MSGB_POOL_DEFAULT_SIZE, LB_MSGB_POOL_DEFAULT_HIGH_WATER_MARK);
+	g_smlc->timer_wheel = timer_wheel_alloc(g_smlc, SMLC_TIMER_WHEEL_TICK_MS);
+	g_smlc->admission = smlc_admission_alloc(g_smlc, smlc_loc_req_admitted);
+	g_smlc->overload = smlc_overload_alloc(g_smlc);
 
 	/* This needs to precede handle_options() */
 	vty_init(&vty_info);
@@ -245,6 +279,7 @@ int main(int argc, char **argv)
 	osmo_talloc_vty_add_cmds();
 	ctrl_vty_init(tall_smlc_ctx);
 	cell_locations_vty_init();
+	smlc_vty_init();
 
 	/* Initialize SS7 */
 	OSMO_ASSERT(osmo_ss7_init() == 0);
@@ -261,6 +296,11 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
+	if (cell_table_rebuild_sync()) {
+		fprintf(stderr, "Failed to load cell locations\n");
+		exit(1);
+	}
+
 	/* Start telnet interface after reading config for vty_get_bind_addr() */
 	rc = telnet_init_dynif(tall_smlc_ctx, g_smlc, vty_get_bind_addr(), OSMO_VTY_PORT_SMLC);
 	if (rc < 0)
@@ -275,13 +315,11 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
-	/*
 	rc = smlc_ctrl_cmds_install(g_smlc);
 	if (rc < 0) {
 		fprintf(stderr, "Failed to install control commands. Exiting.\n");
 		exit(1);
 	}
-	*/
 
 	default_pc = osmo_ss7_pointcode_parse(NULL, SMLC_DEFAULT_PC);
 	OSMO_ASSERT(default_pc);
@@ -306,6 +344,16 @@ int main(int argc, char **argv)
 	signal(SIGUSR2, &signal_handler);
 	osmo_init_ignore_signals();
 
+	/* SIGHUP is blocked and read from a signalfd instead, and must not be ignored for that */
+	sigemptyset(&sigset);
+	sigaddset(&sigset, SIGHUP);
+	sigprocmask(SIG_BLOCK, &sigset, NULL);
+	signal(SIGHUP, SIG_DFL);
+	if (!osmo_signalfd_setup(tall_smlc_ctx, sigset, signalfd_cb, NULL)) {
+		fprintf(stderr, "Failed to set up signal handling\n");
+		exit(1);
+	}
+
 	if (daemonize) {
 		rc = osmo_daemonize();
 		if (rc < 0) {
@@ -314,6 +362,10 @@ int main(int argc, char **argv)
 		}
 	}
 
+	/* Threads do not survive the fork of osmo_daemonize(). Starting them here also makes them inherit the blocked
+	 * signals from above, so that those keep going to the signalfd. */
+	smlc_loc_req_positioning_restart();
+
 	while (1) {
 		osmo_select_main_ctx(0);
 	}
@@ -0,0 +1,230 @@
+/* OsmoSMLC overload protection */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <inttypes.h>
+
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/logging.h>
+#include <osmocom/core/rate_ctr.h>
+#include <osmocom/core/timer_compat.h>
+#include <osmocom/vty/vty.h>
+
+#include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/smlc_overload.h>
+
+const struct value_string smlc_overload_state_names[] = {
+	{ SMLC_OVERLOAD_NONE, "none" },
+	{ SMLC_OVERLOAD_SKIP_DEBUG_LOG, "skip-debug-log" },
+	{ SMLC_OVERLOAD_REJECT_NORMAL, "reject-normal" },
+	{ SMLC_OVERLOAD_REFUSE_CONN, "refuse-connection" },
+	{}
+};
+
+const struct value_string smlc_overload_metric_names[] = {
+	{ SMLC_OVERLOAD_METRIC_LAG, "lag" },
+	{ SMLC_OVERLOAD_METRIC_LB_CONNS, "lb-conns" },
+	{ SMLC_OVERLOAD_METRIC_LOC_REQS, "location-requests" },
+	{ SMLC_OVERLOAD_METRIC_SUBSCRIBERS, "subscribers" },
+	{}
+};
+
+struct smlc_overload_saved_loglevel {
+	struct llist_head entry;
+	struct log_target *target;
+	uint8_t loglevel;
+};
+
+static bool smlc_overload_exceeds(const struct smlc_overload *ov, enum smlc_overload_state state,
+				  const uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC], unsigned int percent)
+{
+	enum smlc_overload_metric m;
+
+	for (m = 0; m < _NUM_SMLC_OVERLOAD_METRIC; m++) {
+		uint64_t threshold = ov->threshold[state][m];
+		if (threshold && (uint64_t)metrics[m] * 100 >= threshold * percent)
+			return true;
+	}
+	return false;
+}
+
+/* Return the state that the given metrics call for: the highest state with any metric at or above its threshold. The
+ * current state and those below it are kept until no metric is above the hysteresis share of its threshold anymore. */
+enum smlc_overload_state smlc_overload_eval(const struct smlc_overload *ov,
+					    const uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC])
+{
+	enum smlc_overload_state state;
+
+	for (state = _NUM_SMLC_OVERLOAD_STATE - 1; state > SMLC_OVERLOAD_NONE; state--) {
+		unsigned int percent = state <= ov->state ? SMLC_OVERLOAD_HYSTERESIS_PERCENT : 100;
+		if (smlc_overload_exceeds(ov, state, metrics, percent))
+			return state;
+	}
+	return SMLC_OVERLOAD_NONE;
+}
+
+static void smlc_overload_skip_debug_log(struct smlc_overload *ov)
+{
+	struct smlc_overload_saved_loglevel *saved;
+	struct log_target *target;
+
+	llist_for_each_entry(target, &osmo_log_target_list, entry) {
+		if (target->loglevel >= LOGL_INFO)
+			continue;
+		saved = talloc_zero(ov, struct smlc_overload_saved_loglevel);
+		OSMO_ASSERT(saved);
+		saved->target = target;
+		saved->loglevel = target->loglevel;
+		llist_add_tail(&saved->entry, &ov->saved_loglevels);
+		target->loglevel = LOGL_INFO;
+	}
+}
+
+static void smlc_overload_restore_log(struct smlc_overload *ov)
+{
+	struct smlc_overload_saved_loglevel *saved, *saved_next;
+	struct log_target *target;
+
+	llist_for_each_entry_safe(saved, saved_next, &ov->saved_loglevels, entry) {
+		/* Leave alone targets that were removed or reconfigured in the meantime */
+		llist_for_each_entry(target, &osmo_log_target_list, entry) {
+			if (target == saved->target && target->loglevel == LOGL_INFO)
+				target->loglevel = saved->loglevel;
+		}
+		llist_del(&saved->entry);
+		talloc_free(saved);
+	}
+}
+
+/* Re-evaluate the overload state from the given metrics, and log and count a transition */
+void smlc_overload_update(struct smlc_overload *ov, const uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC])
+{
+	enum smlc_overload_state old_state = ov->state;
+	enum smlc_overload_state new_state = smlc_overload_eval(ov, metrics);
+
+	if (new_state == old_state)
+		return;
+
+	/* Log the transition itself before skipping debug logging, and after resuming it */
+	if (old_state >= SMLC_OVERLOAD_SKIP_DEBUG_LOG && new_state < SMLC_OVERLOAD_SKIP_DEBUG_LOG)
+		smlc_overload_restore_log(ov);
+
+	LOGP(DSMLC, new_state > old_state ? LOGL_ERROR : LOGL_NOTICE,
+	     "Overload state %s -> %s (lag %u ms, %u lb-conns, %u location-requests, %u subscribers)\n",
+	     get_value_string(smlc_overload_state_names, old_state),
+	     get_value_string(smlc_overload_state_names, new_state),
+	     metrics[SMLC_OVERLOAD_METRIC_LAG], metrics[SMLC_OVERLOAD_METRIC_LB_CONNS],
+	     metrics[SMLC_OVERLOAD_METRIC_LOC_REQS], metrics[SMLC_OVERLOAD_METRIC_SUBSCRIBERS]);
+
+	ov->state = new_state;
+	ov->entered[new_state]++;
+	if (g_smlc && g_smlc->ctrs)
+		rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_OVERLOAD_ENTER_NONE + new_state]);
+
+	if (old_state < SMLC_OVERLOAD_SKIP_DEBUG_LOG && new_state >= SMLC_OVERLOAD_SKIP_DEBUG_LOG)
+		smlc_overload_skip_debug_log(ov);
+}
+
+void smlc_overload_metrics(const struct smlc_overload *ov, uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC])
+{
+	metrics[SMLC_OVERLOAD_METRIC_LAG] = ov->lag_avg_us / 1000;
+	metrics[SMLC_OVERLOAD_METRIC_LB_CONNS] = g_smlc->lb_conns_count;
+	metrics[SMLC_OVERLOAD_METRIC_LOC_REQS] = g_smlc->loc_reqs_count;
+	metrics[SMLC_OVERLOAD_METRIC_SUBSCRIBERS] = g_smlc->subscribers_count;
+}
+
+static void smlc_overload_probe_schedule(struct smlc_overload *ov)
+{
+	struct timespec interval = {
+		.tv_sec = SMLC_OVERLOAD_PROBE_MS / 1000,
+		.tv_nsec = (SMLC_OVERLOAD_PROBE_MS % 1000) * 1000000,
+	};
+	struct timespec now;
+
+	osmo_clock_gettime(CLOCK_MONOTONIC, &now);
+	timespecadd(&now, &interval, &ov->probe_due);
+	osmo_timer_schedule(&ov->probe_timer, interval.tv_sec, interval.tv_nsec / 1000);
+}
+
+/* The probe timer fires late by as much as the main loop spends handling other file descriptors and timers */
+static void smlc_overload_probe_cb(void *data)
+{
+	struct smlc_overload *ov = data;
+	uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC];
+	struct timespec now;
+	struct timespec late;
+
+	osmo_clock_gettime(CLOCK_MONOTONIC, &now);
+	if (timespeccmp(&now, &ov->probe_due, >)) {
+		timespecsub(&now, &ov->probe_due, &late);
+		ov->lag_us = OSMO_MIN(late.tv_sec, 3600) * 1000000 + late.tv_nsec / 1000;
+	} else {
+		ov->lag_us = 0;
+	}
+	/* Same smoothing as the TCP SRTT: an eighth of each new sample */
+	ov->lag_avg_us = ov->lag_avg_us - ov->lag_avg_us / 8 + ov->lag_us / 8;
+	ov->lag_max_us = OSMO_MAX(ov->lag_max_us, ov->lag_us);
+
+	smlc_overload_metrics(ov, metrics);
+	smlc_overload_update(ov, metrics);
+	smlc_overload_probe_schedule(ov);
+}
+
+struct smlc_overload *smlc_overload_alloc(void *ctx)
+{
+	struct smlc_overload *ov = talloc_zero(ctx, struct smlc_overload);
+	OSMO_ASSERT(ov);
+
+	INIT_LLIST_HEAD(&ov->saved_loglevels);
+	osmo_timer_setup(&ov->probe_timer, smlc_overload_probe_cb, ov);
+	smlc_overload_probe_schedule(ov);
+	return ov;
+}
+
+void smlc_overload_vty_show(struct vty *vty, const struct smlc_overload *ov)
+{
+	uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC];
+	enum smlc_overload_state state;
+	enum smlc_overload_metric m;
+
+	smlc_overload_metrics(ov, metrics);
+
+	vty_out(vty, "state: %s%s", get_value_string(smlc_overload_state_names, ov->state), VTY_NEWLINE);
+	vty_out(vty, "lag: %u us, smoothed %u us, max %u us%s", ov->lag_us, ov->lag_avg_us, ov->lag_max_us,
+		VTY_NEWLINE);
+	vty_out(vty, "lb-conns: %u, location-requests: %u, subscribers: %u%s",
+		metrics[SMLC_OVERLOAD_METRIC_LB_CONNS], metrics[SMLC_OVERLOAD_METRIC_LOC_REQS],
+		metrics[SMLC_OVERLOAD_METRIC_SUBSCRIBERS], VTY_NEWLINE);
+	for (state = SMLC_OVERLOAD_SKIP_DEBUG_LOG; state < _NUM_SMLC_OVERLOAD_STATE; state++) {
+		vty_out(vty, "%s: entered %" PRIu64 " times, thresholds:",
+			get_value_string(smlc_overload_state_names, state), ov->entered[state]);
+		for (m = 0; m < _NUM_SMLC_OVERLOAD_METRIC; m++) {
+			if (ov->threshold[state][m])
+				vty_out(vty, " %s %u", get_value_string(smlc_overload_metric_names, m),
+					ov->threshold[state][m]);
+			else
+				vty_out(vty, " %s -", get_value_string(smlc_overload_metric_names, m));
+		}
+		vty_out(vty, "%s", VTY_NEWLINE);
+	}
+}
@@ -0,0 +1,119 @@
+/* OsmoSMLC: preallocated memory for per-transaction objects */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <inttypes.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/vty/vty.h>
+
+#include <osmocom/smlc/smlc_pool.h>
+
+static void smlc_pool_ensure_free_chunks_len(struct smlc_pool *pool, unsigned int len)
+{
+	if (pool->free_chunks_len >= len)
+		return;
+	pool->free_chunks = talloc_realloc(pool, pool->free_chunks, void *, len);
+	OSMO_ASSERT(pool->free_chunks);
+	pool->free_chunks_len = len;
+}
+
+static void smlc_pool_add_chunk(struct smlc_pool *pool)
+{
+	void *chunk = talloc_pool(pool, pool->chunk_size);
+	OSMO_ASSERT(chunk);
+	talloc_set_name_const(chunk, pool->name);
+	pool->chunk_count++;
+	smlc_pool_ensure_free_chunks_len(pool, pool->chunk_count);
+	pool->free_chunks[pool->free_count++] = chunk;
+}
+
+/* Free unused chunks above the high water mark. Chunks are only freed here and not in smlc_pool_put(), which may be
+ * called from a talloc destructor while objects in the chunk are still being freed. */
+static void smlc_pool_trim(struct smlc_pool *pool)
+{
+	while (pool->chunk_count > pool->high_water_mark && pool->free_count) {
+		talloc_free(pool->free_chunks[--pool->free_count]);
+		pool->chunk_count--;
+	}
+}
+
+struct smlc_pool *smlc_pool_alloc(void *ctx, const char *name, size_t chunk_size, unsigned int size,
+				  unsigned int high_water_mark)
+{
+	struct smlc_pool *pool = talloc_zero(ctx, struct smlc_pool);
+	OSMO_ASSERT(pool);
+	pool->name = name;
+	pool->chunk_size = chunk_size;
+	talloc_set_name(pool, "smlc_pool %s", name);
+	smlc_pool_set_size(pool, size, high_water_mark);
+	return pool;
+}
+
+void smlc_pool_set_size(struct smlc_pool *pool, unsigned int size, unsigned int high_water_mark)
+{
+	pool->size = size;
+	pool->high_water_mark = OSMO_MAX(size, high_water_mark);
+	smlc_pool_trim(pool);
+	while (pool->chunk_count < pool->size)
+		smlc_pool_add_chunk(pool);
+}
+
+/* Return an empty talloc pool to allocate the objects of one transaction in, or NULL if high_water_mark chunks are
+ * already in use. In that case, the caller allocates its objects from a talloc context of its choice, as usual. */
+void *smlc_pool_get(struct smlc_pool *pool)
+{
+	smlc_pool_trim(pool);
+
+	if (!pool->free_count && pool->chunk_count < pool->high_water_mark)
+		smlc_pool_add_chunk(pool);
+
+	if (!pool->free_count) {
+		pool->unpooled++;
+		return NULL;
+	}
+
+	pool->pooled++;
+	pool->free_count--;
+	pool->peak_in_use = OSMO_MAX(pool->peak_in_use, smlc_pool_in_use(pool));
+	return pool->free_chunks[pool->free_count];
+}
+
+/* Hand a chunk back to the pool, once all of its objects are freed or are about to be freed. This is safe to call
+ * from a talloc destructor of an object in the chunk. chunk may be NULL. */
+void smlc_pool_put(struct smlc_pool *pool, void *chunk)
+{
+	if (!chunk)
+		return;
+	OSMO_ASSERT(pool->free_count < pool->chunk_count);
+	pool->free_chunks[pool->free_count++] = chunk;
+}
+
+void smlc_pool_vty_show(struct vty *vty, const struct smlc_pool *pool)
+{
+	vty_out(vty, "%s: size %u, high-water-mark %u, %u chunks, %u in use, peak %u in use%s",
+		pool->name, pool->size, pool->high_water_mark, pool->chunk_count,
+		smlc_pool_in_use(pool), pool->peak_in_use, VTY_NEWLINE);
+	vty_out(vty, " %" PRIu64 " allocations from the pool, %" PRIu64 " without the pool%s",
+		pool->pooled, pool->unpooled, VTY_NEWLINE);
+}
@@ -0,0 +1,101 @@
+/* OsmoSMLC: positioning, i.e. computing location estimates, inline or on worker threads */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <errno.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+
+#include <osmocom/smlc/cell_locations.h>
+#include <osmocom/smlc/smlc_pos.h>
+
+static void smlc_pos_done(struct smlc_work *work)
+{
+	struct smlc_pos_job *job = container_of(work, struct smlc_pos_job, work);
+	job->done_cb(job);
+	talloc_free(job);
+}
+
+/* Allocate a job to fill in and pass to smlc_pos_submit(), or to smlc_pos_compute() and free again */
+struct smlc_pos_job *smlc_pos_job_alloc(void *ctx, smlc_pos_done_cb_t done_cb, void *priv)
+{
+	struct smlc_pos_job *job = talloc_zero(ctx, struct smlc_pos_job);
+	OSMO_ASSERT(job);
+	job->work = (struct smlc_work){
+		.run = smlc_pos_run,
+		.done = smlc_pos_done,
+	};
+	job->done_cb = done_cb;
+	job->priv = priv;
+	return job;
+}
+
+/* Compute the location estimate from the job's input, and encode it. So far, a circle around the cell with the TA
+ * distance as radius. Safe to call on any thread. Return 0 on success, a negative error otherwise. */
+int smlc_pos_compute(struct smlc_pos_job *job)
+{
+	int rc;
+
+	cell_location_estimate_from_ta(&job->location, job->lat, job->lon, job->ta);
+	rc = osmo_gad_enc(&job->location_estimate, &job->location);
+	if (rc <= 0)
+		return rc ? : -EINVAL;
+	job->location_estimate_len = rc;
+	return 0;
+}
+
+static bool timespec_passed(const struct timespec *now, const struct timespec *t)
+{
+	return now->tv_sec > t->tv_sec || (now->tv_sec == t->tv_sec && now->tv_nsec >= t->tv_nsec);
+}
+
+/* The smlc_work run cb of a job, on a positioning thread */
+void smlc_pos_run(struct smlc_work *work)
+{
+	struct smlc_pos_job *job = container_of(work, struct smlc_pos_job, work);
+	struct timespec now;
+
+	/* The requester has given up on this job already, do not spend time on it */
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (timespec_passed(&now, &job->deadline)) {
+		job->rc = -ETIMEDOUT;
+		return;
+	}
+	job->rc = smlc_pos_compute(job);
+}
+
+/* Hand a job to the positioning thread for shard, to be computed within deadline_ms. The job's done_cb is called
+ * from the main loop, and the job freed after. Return -EAGAIN if the thread is a full queue behind; the job then stays
+ * with the caller. */
+int smlc_pos_submit(struct smlc_workers *workers, unsigned int shard, struct smlc_pos_job *job,
+		     unsigned long deadline_ms)
+{
+	clock_gettime(CLOCK_MONOTONIC, &job->deadline);
+	job->deadline.tv_sec += deadline_ms / 1000;
+	job->deadline.tv_nsec += (deadline_ms % 1000) * 1000000;
+	if (job->deadline.tv_nsec >= 1000000000) {
+		job->deadline.tv_sec++;
+		job->deadline.tv_nsec -= 1000000000;
+	}
+	return smlc_workers_submit(workers, shard, &job->work);
+}
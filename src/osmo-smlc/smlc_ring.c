@@ -0,0 +1,80 @@
+/* OsmoSMLC: lock-free single producer, single consumer ring of pointers */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+
+#include <osmocom/smlc/smlc_ring.h>
+
+/* Allocate a ring with room for at least size items */
+struct smlc_ring *smlc_ring_alloc(void *ctx, unsigned int size)
+{
+	struct smlc_ring *ring = talloc_zero(ctx, struct smlc_ring);
+	OSMO_ASSERT(ring);
+
+	ring->size = 1;
+	while (ring->size < size)
+		ring->size <<= 1;
+	ring->slots = talloc_zero_array(ring, void *, ring->size);
+	OSMO_ASSERT(ring->slots);
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	return ring;
+}
+
+/* Producer side: append item, or return false if the ring is full */
+bool smlc_ring_push(struct smlc_ring *ring, void *item)
+{
+	unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	if (head - tail == ring->size)
+		return false;
+	ring->slots[head & (ring->size - 1)] = item;
+	/* Publish the slot only after it is written */
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	return true;
+}
+
+/* Consumer side: remove and return the oldest item, or NULL if the ring is empty */
+void *smlc_ring_pop(struct smlc_ring *ring)
+{
+	unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	unsigned int head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	void *item;
+
+	if (head == tail)
+		return NULL;
+	item = ring->slots[tail & (ring->size - 1)];
+	/* Hand the slot back only after it is read */
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	return item;
+}
+
+/* Number of items in the ring. Exact when called from the producer or consumer while the other side is idle, otherwise a
+ * snapshot. */
+unsigned int smlc_ring_count(struct smlc_ring *ring)
+{
+	return atomic_load_explicit(&ring->head, memory_order_acquire)
+		- atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
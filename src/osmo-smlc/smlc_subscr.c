@@ -21,13 +21,36 @@
  *
  */
 
+#include <osmocom/core/timer.h>
+#include <osmocom/core/timer_compat.h>
+#include <osmocom/gsm/bssmap_le.h>
+
 #include <osmocom/smlc/debug.h>
 #include <osmocom/smlc/smlc_data.h>
 #include <osmocom/smlc/smlc_subscr.h>
+#include <osmocom/smlc/smlc_loc_req.h>
+
+/* Pack the IMSI digits as BCD, and the number of digits in the top nibble, so that IMSIs that differ only in leading
+ * zeros do not collide. 15 digits fit in 60 bits. Only used as hash key, identities are still compared in full. */
+uint64_t smlc_subscr_imsi_key(const struct osmo_mobile_identity *imsi)
+{
+	uint64_t key = 0;
+	unsigned int len = 0;
+	const char *pos;
+
+	if (imsi->type != GSM_MI_TYPE_IMSI)
+		return 0;
+
+	for (pos = imsi->imsi; *pos && len < 15; pos++, len++)
+		key = (key << 4) | ((*pos - '0') & 0xf);
+	return key | ((uint64_t)len << 60);
+}
 
 static void smlc_subscr_free(struct smlc_subscr *smlc_subscr)
 {
+	hash_del(&smlc_subscr->hnode);
 	llist_del(&smlc_subscr->entry);
+	g_smlc->subscribers_count--;
 	talloc_free(smlc_subscr);
 }
 
@@ -60,7 +83,7 @@ static int smlc_subscr_use_cb(struct osmo_use_count_entry *e, int32_t old_use_co
 	return 0;
 }
 
-static struct smlc_subscr *smlc_subscr_alloc()
+static struct smlc_subscr *smlc_subscr_alloc(const struct osmo_mobile_identity *imsi)
 {
 	struct smlc_subscr *smlc_subscr;
 
@@ -72,8 +95,12 @@ static struct smlc_subscr *smlc_subscr_alloc()
 		.talloc_object = smlc_subscr,
 		.use_cb = smlc_subscr_use_cb,
 	};
+	smlc_subscr->imsi = *imsi;
+	smlc_subscr->imsi_key = smlc_subscr_imsi_key(imsi);
 
 	llist_add_tail(&smlc_subscr->entry, &g_smlc->subscribers);
+	hash_add(g_smlc->subscribers_by_imsi, &smlc_subscr->hnode, smlc_subscr->imsi_key);
+	g_smlc->subscribers_count++;
 
 	return smlc_subscr;
 }
@@ -81,11 +108,14 @@ static struct smlc_subscr *smlc_subscr_alloc()
 struct smlc_subscr *smlc_subscr_find(const struct osmo_mobile_identity *imsi, const char *use_token)
 {
 	struct smlc_subscr *smlc_subscr;
+	uint64_t key;
 	if (!imsi)
 		return NULL;
 
-	llist_for_each_entry(smlc_subscr, &g_smlc->subscribers, entry) {
-		if (!osmo_mobile_identity_cmp(&smlc_subscr->imsi, imsi)) {
+	key = smlc_subscr_imsi_key(imsi);
+	hash_for_each_possible(g_smlc->subscribers_by_imsi, smlc_subscr, hnode, key) {
+		if (smlc_subscr->imsi_key == key
+		    && !osmo_mobile_identity_cmp(&smlc_subscr->imsi, imsi)) {
 			smlc_subscr_get(smlc_subscr, use_token);
 			return smlc_subscr;
 		}
@@ -101,14 +131,115 @@ struct smlc_subscr *smlc_subscr_find_or_create(const struct osmo_mobile_identity
 	smlc_subscr = smlc_subscr_find(imsi, use_token);
 	if (smlc_subscr)
 		return smlc_subscr;
-	smlc_subscr = smlc_subscr_alloc();
+	smlc_subscr = smlc_subscr_alloc(imsi);
 	if (!smlc_subscr)
 		return NULL;
-	smlc_subscr->imsi = *imsi;
 	smlc_subscr_get(smlc_subscr, use_token);
 	return smlc_subscr;
 }
 
+static void smlc_subscr_last_location_clear(struct smlc_subscr *smlc_subscr)
+{
+	if (!smlc_subscr->last_location.valid)
+		return;
+	llist_del(&smlc_subscr->last_location.entry);
+	smlc_subscr->last_location.valid = false;
+	g_smlc->last_locations_count--;
+	/* May free smlc_subscr */
+	smlc_subscr_put(smlc_subscr, SMLC_SUBSCR_USE_LAST_LOCATION);
+}
+
+static unsigned int last_location_age(const struct smlc_subscr_last_location *last, const struct timespec *now)
+{
+	struct timespec age;
+	timespecsub(now, &last->time, &age);
+	return age.tv_sec;
+}
+
+/* Forget last known locations above the configured capacity, and those older than the configured max-age. The oldest
+ * are at the start of the list, so this stops at the first one that is kept. */
+void smlc_subscr_last_location_expire(void)
+{
+	struct smlc_subscr_last_location *last;
+	struct timespec now;
+
+	osmo_clock_gettime(CLOCK_MONOTONIC, &now);
+
+	while ((last = llist_first_entry_or_null(&g_smlc->last_locations, struct smlc_subscr_last_location, entry))) {
+		bool expired = (last_location_age(last, &now) >= g_smlc->last_location_max_age);
+		if (!expired && g_smlc->last_locations_count <= g_smlc->last_location_capacity)
+			break;
+		if (expired)
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LAST_LOCATION_EXPIRED]);
+		smlc_subscr_last_location_clear(container_of(last, struct smlc_subscr, last_location));
+	}
+}
+
+/* Remember the location estimate sent for this subscriber, to answer later requests from it. */
+void smlc_subscr_last_location_set(struct smlc_subscr *smlc_subscr, const struct gsm0808_cell_id *cell_id, uint8_t ta,
+				   const struct osmo_gad *location, const union gad_raw *location_estimate)
+{
+	struct smlc_subscr_last_location *last = &smlc_subscr->last_location;
+
+	if (!g_smlc->last_location_max_age || !g_smlc->last_location_capacity)
+		return;
+
+	if (last->valid) {
+		llist_del(&last->entry);
+	} else {
+		smlc_subscr_get(smlc_subscr, SMLC_SUBSCR_USE_LAST_LOCATION);
+		last->valid = true;
+		g_smlc->last_locations_count++;
+	}
+	llist_add_tail(&last->entry, &g_smlc->last_locations);
+
+	osmo_clock_gettime(CLOCK_MONOTONIC, &last->time);
+	smlc_subscr->cell_id = *cell_id;
+	last->ta = ta;
+	last->location = *location;
+	last->location_estimate = *location_estimate;
+
+	smlc_subscr_last_location_expire();
+}
+
+/* Return the last known location of this subscriber, if it is recent enough, from the same cell as indicated in the
+ * request, and good enough for the LCS QoS of the request. Otherwise return NULL. */
+const struct smlc_subscr_last_location *smlc_subscr_last_location_get(struct smlc_subscr *smlc_subscr,
+								     const struct smlc_loc_req_params *req)
+{
+	const struct smlc_subscr_last_location *last = &smlc_subscr->last_location;
+
+	smlc_subscr_last_location_expire();
+
+	if (!last->valid) {
+		if (g_smlc->last_location_max_age)
+			rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LAST_LOCATION_MISS]);
+		return NULL;
+	}
+
+	/* smlc_subscr_last_location_expire() has dropped entries of max-age and older */
+
+	if (!gsm0808_cell_ids_match(&smlc_subscr->cell_id, &req->cell_id, true))
+		goto qos_mismatch;
+
+	if (req->lcs_qos_present) {
+		/* The requester can afford the TA round trip for a current location */
+		if (req->lcs_qos.rt == LCS_QOS_RT_DELAY_TOLERANT)
+			goto qos_mismatch;
+		if (req->lcs_qos.ha_ind
+		    && (last->location.type != GAD_TYPE_ELL_POINT_UNC_CIRCLE
+			|| last->location.ell_point_unc_circle.unc > osmo_gad_dec_unc(req->lcs_qos.ha_val)))
+			goto qos_mismatch;
+	}
+
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LAST_LOCATION_HIT]);
+	return last;
+
+qos_mismatch:
+	rate_ctr_inc(&g_smlc->ctrs->ctr[SMLC_CTR_LAST_LOCATION_QOS_MISMATCH]);
+	return NULL;
+}
+
 int smlc_subscr_to_str_buf(char *buf, size_t buf_len, const struct smlc_subscr *smlc_subscr)
 {
 	struct osmo_strbuf sb = { .buf = buf, .len = buf_len };
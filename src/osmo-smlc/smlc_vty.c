@@ -0,0 +1,508 @@
+/* OsmoSMLC VTY configuration */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/vty/command.h>
+#include <osmocom/vty/vty.h>
+#include <osmocom/sigtran/sccp_sap.h>
+
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/smlc_vty.h>
+#include <osmocom/smlc/smlc_pool.h>
+#include <osmocom/smlc/smlc_subscr.h>
+#include <osmocom/smlc/smlc_latency.h>
+#include <osmocom/smlc/smlc_admission.h>
+#include <osmocom/smlc/smlc_overload.h>
+#include <osmocom/smlc/sccp_lb_inst.h>
+#include <osmocom/smlc/lb_peer.h>
+#include <osmocom/smlc/smlc_loc_req.h>
+#include <osmocom/smlc/smlc_workers.h>
+
+static const struct value_string smlc_cell_id_only_names[] = {
+	{ SMLC_CELL_ID_ONLY_DISABLED, "disabled" },
+	{ SMLC_CELL_ID_ONLY_LOW_DELAY, "low-delay" },
+	{}
+};
+
+static const struct value_string smlc_ta_timeout_names[] = {
+	{ SMLC_TA_TIMEOUT_FIXED, "fixed" },
+	{ SMLC_TA_TIMEOUT_ADAPTIVE, "adaptive" },
+	{}
+};
+
+struct cmd_node smlc_node = {
+	SMLC_NODE,
+	"%s(config-smlc)# ",
+	1,
+};
+
+static int config_write_smlc(struct vty *vty)
+{
+	enum smlc_overload_state state;
+	enum smlc_overload_metric m;
+
+	vty_out(vty, "smlc%s", VTY_NEWLINE);
+	vty_out(vty, " pool lb-conn size %u high-water-mark %u%s",
+		g_smlc->lb_conn_pool->size, g_smlc->lb_conn_pool->high_water_mark, VTY_NEWLINE);
+	vty_out(vty, " pool location-request size %u high-water-mark %u%s",
+		g_smlc->loc_req_pool->size, g_smlc->loc_req_pool->high_water_mark, VTY_NEWLINE);
+	vty_out(vty, " pool lb-msgb size %u high-water-mark %u%s",
+		g_smlc->lb_msgb_pool->size, g_smlc->lb_msgb_pool->high_water_mark, VTY_NEWLINE);
+	vty_out(vty, " last-location max-age %u%s", g_smlc->last_location_max_age, VTY_NEWLINE);
+	vty_out(vty, " last-location capacity %u%s", g_smlc->last_location_capacity, VTY_NEWLINE);
+	vty_out(vty, " handover-ta max-age %u%s", g_smlc->handover_ta_max_age, VTY_NEWLINE);
+	vty_out(vty, " cell-id-only %s%s", get_value_string(smlc_cell_id_only_names, g_smlc->cell_id_only),
+		VTY_NEWLINE);
+	vty_out(vty, " cell-id-only default-radius %u%s", g_smlc->cell_id_only_default_radius, VTY_NEWLINE);
+	vty_out(vty, " ta-timeout %s%s", get_value_string(smlc_ta_timeout_names, g_smlc->ta_timeout), VTY_NEWLINE);
+	vty_out(vty, " ta-timeout min %lu max %lu%s", g_smlc->ta_timeout_min_ms, g_smlc->ta_timeout_max_ms,
+		VTY_NEWLINE);
+	vty_out(vty, " admission max-active %u%s", g_smlc->admission->max_active, VTY_NEWLINE);
+	vty_out(vty, " admission max-backlog high %u%s", g_smlc->admission->max_backlog[SMLC_LOC_REQ_PRIO_HIGH],
+		VTY_NEWLINE);
+	vty_out(vty, " admission max-backlog normal %u%s", g_smlc->admission->max_backlog[SMLC_LOC_REQ_PRIO_NORMAL],
+		VTY_NEWLINE);
+	vty_out(vty, " rate-limit connection %u burst %u%s",
+		g_smlc->rate_limit_conn.rate, g_smlc->rate_limit_conn.burst, VTY_NEWLINE);
+	vty_out(vty, " rate-limit location-request %u burst %u%s",
+		g_smlc->rate_limit_loc_req.rate, g_smlc->rate_limit_loc_req.burst, VTY_NEWLINE);
+	vty_out(vty, " location-request pipeline-depth %u%s", g_smlc->loc_req_pipeline_depth, VTY_NEWLINE);
+	vty_out(vty, " positioning threads %u%s", g_smlc->positioning_threads, VTY_NEWLINE);
+	vty_out(vty, " positioning deadline %lu%s", g_smlc->positioning_deadline_ms, VTY_NEWLINE);
+	for (state = SMLC_OVERLOAD_SKIP_DEBUG_LOG; state < _NUM_SMLC_OVERLOAD_STATE; state++) {
+		for (m = 0; m < _NUM_SMLC_OVERLOAD_METRIC; m++) {
+			if (!g_smlc->overload->threshold[state][m])
+				continue;
+			vty_out(vty, " overload %s %s %u%s", get_value_string(smlc_overload_state_names, state),
+				get_value_string(smlc_overload_metric_names, m), g_smlc->overload->threshold[state][m],
+				VTY_NEWLINE);
+		}
+	}
+	return 0;
+}
+
+DEFUN(cfg_smlc, cfg_smlc_cmd,
+      "smlc",
+      "Configure the SMLC\n")
+{
+	vty->node = SMLC_NODE;
+	return CMD_SUCCESS;
+}
+
+#define POOL_STR "Memory preallocated for objects of each location transaction\n"
+#define POOL_NAMES "(lb-conn|location-request|lb-msgb)"
+#define POOL_NAMES_STR \
+	"Lb connections\n" \
+	"Location requests and their FSM instances\n" \
+	"Message buffers for sending on the Lb interface\n"
+
+static struct smlc_pool *pool_by_name(const char *name)
+{
+	if (!strcmp(name, "lb-conn"))
+		return g_smlc->lb_conn_pool;
+	if (!strcmp(name, "lb-msgb"))
+		return g_smlc->lb_msgb_pool;
+	return g_smlc->loc_req_pool;
+}
+
+DEFUN(cfg_smlc_pool, cfg_smlc_pool_cmd,
+      "pool " POOL_NAMES " size <0-65535> high-water-mark <0-65535>",
+      POOL_STR POOL_NAMES_STR
+      "Number of objects to preallocate memory for at startup\n"
+      "Number of objects\n"
+      "When more objects are in use, allocate memory for more on demand, up to this many;"
+      " beyond that, allocate without the pool\n"
+      "Number of objects, at least the size\n")
+{
+	int size = atoi(argv[1]);
+	int high_water_mark = atoi(argv[2]);
+
+	if (high_water_mark < size) {
+		vty_out(vty, "%% high-water-mark must not be less than the size%s", VTY_NEWLINE);
+		return CMD_WARNING;
+	}
+	smlc_pool_set_size(pool_by_name(argv[0]), size, high_water_mark);
+	return CMD_SUCCESS;
+}
+
+#define LAST_LOCATION_STR "Answer location requests from the subscriber's last known location\n"
+
+DEFUN(cfg_smlc_last_location_max_age, cfg_smlc_last_location_max_age_cmd,
+      "last-location max-age <0-86400>",
+      LAST_LOCATION_STR
+      "Use a last known location only up to this age\n"
+      "Seconds; 0 disables, always asking the BSC for the TA\n")
+{
+	g_smlc->last_location_max_age = atoi(argv[0]);
+	smlc_subscr_last_location_expire();
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_last_location_capacity, cfg_smlc_last_location_capacity_cmd,
+      "last-location capacity <0-10000000>",
+      LAST_LOCATION_STR
+      "Remember the last known locations of at most this many subscribers, the least recently updated are dropped\n"
+      "Number of subscribers\n")
+{
+	g_smlc->last_location_capacity = atoi(argv[0]);
+	smlc_subscr_last_location_expire();
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_handover_ta_max_age, cfg_smlc_handover_ta_max_age_cmd,
+      "handover-ta max-age <0-3600>",
+      "Answer location requests from the TA and cell identity of the latest BSSLAP Reset on the same Lb connection\n"
+      "Use the TA of a BSSLAP Reset only up to this age, and only while the request indicates the same cell\n"
+      "Seconds; 0 disables, always asking the BSC for the TA\n")
+{
+	g_smlc->handover_ta_max_age = atoi(argv[0]);
+	return CMD_SUCCESS;
+}
+
+#define CELL_ID_ONLY_STR "Answer location requests from the cell identity alone, without asking the BSC for the TA\n"
+
+DEFUN(cfg_smlc_cell_id_only, cfg_smlc_cell_id_only_cmd,
+      "cell-id-only (disabled|low-delay)",
+      CELL_ID_ONLY_STR
+      "Never, always ask the BSC for the TA\n"
+      "When the LCS QoS asks for a low delay response, and the cell radius satisfies the requested horizontal"
+      " accuracy\n")
+{
+	g_smlc->cell_id_only = get_string_value(smlc_cell_id_only_names, argv[0]);
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_cell_id_only_default_radius, cfg_smlc_cell_id_only_default_radius_cmd,
+      "cell-id-only default-radius <0-100000>",
+      CELL_ID_ONLY_STR
+      "Uncertainty radius for cells that have no radius configured, including all cells from the cell database\n"
+      "Radius in meters; 0 means to always ask for the TA for such cells\n")
+{
+	g_smlc->cell_id_only_default_radius = atoi(argv[0]);
+	return CMD_SUCCESS;
+}
+
+#define TA_TIMEOUT_STR "How long to wait for a BSSLAP TA Response from the BSC\n"
+
+DEFUN(cfg_smlc_ta_timeout, cfg_smlc_ta_timeout_cmd,
+      "ta-timeout (fixed|adaptive)",
+      TA_TIMEOUT_STR
+      "T-12, the same for all Lb peers\n"
+      "Per Lb peer, from the smoothed round trip time and its variance, like TCP's retransmission timeout\n")
+{
+	g_smlc->ta_timeout = get_string_value(smlc_ta_timeout_names, argv[0]);
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_ta_timeout_min_max, cfg_smlc_ta_timeout_min_max_cmd,
+      "ta-timeout min <10-600000> max <10-600000>",
+      TA_TIMEOUT_STR
+      "Lower bound of the adaptive timeout\n" "Milliseconds\n"
+      "Upper bound of the adaptive timeout\n" "Milliseconds\n")
+{
+	unsigned long min_ms = atol(argv[0]);
+	unsigned long max_ms = atol(argv[1]);
+
+	if (max_ms < min_ms) {
+		vty_out(vty, "%% max must not be less than min%s", VTY_NEWLINE);
+		return CMD_WARNING;
+	}
+	g_smlc->ta_timeout_min_ms = min_ms;
+	g_smlc->ta_timeout_max_ms = max_ms;
+	return CMD_SUCCESS;
+}
+
+#define ADMISSION_STR "Limit the number of concurrent location requests that ask the BSC for the TA\n"
+
+DEFUN(cfg_smlc_admission_max_active, cfg_smlc_admission_max_active_cmd,
+      "admission max-active <0-1000000>",
+      ADMISSION_STR
+      "Queue more location requests by priority, emergency first, then high, then normal priority\n"
+      "Number of location requests; 0 for no limit\n")
+{
+	g_smlc->admission->max_active = atoi(argv[0]);
+	smlc_admission_kick(g_smlc->admission);
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_admission_max_backlog, cfg_smlc_admission_max_backlog_cmd,
+      "admission max-backlog (high|normal) <0-1000000>",
+      ADMISSION_STR
+      "Reject location requests with LCS cause 'congestion' when this many are queued already;"
+      " emergency requests are never rejected\n"
+      "Location requests with LCS priority 'highest', or from lawful intercept clients\n"
+      "All other location requests that are not from emergency services\n"
+      "Number of queued location requests\n")
+{
+	enum smlc_loc_req_prio prio = get_string_value(smlc_loc_req_prio_names, argv[0]);
+	g_smlc->admission->max_backlog[prio] = atoi(argv[1]);
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_rate_limit, cfg_smlc_rate_limit_cmd,
+      "rate-limit (connection|location-request) <0-1000000> burst <1-1000000>",
+      "Limit the rate of each Lb peer by a token bucket\n"
+      "Refuse new SCCP connections over the limit at N-CONNECT\n"
+      "Reject Perform Location Requests over the limit with LCS cause 'congestion'; emergency requests are exempt\n"
+      "Sustained rate per second; 0 for no limit\n"
+      "Allow short bursts above the rate\n"
+      "Max burst size\n")
+{
+	struct token_bucket_cfg *cfg = !strcmp(argv[0], "connection") ?
+		&g_smlc->rate_limit_conn : &g_smlc->rate_limit_loc_req;
+	cfg->rate = atoi(argv[1]);
+	cfg->burst = atoi(argv[2]);
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_loc_req_pipeline_depth, cfg_smlc_loc_req_pipeline_depth_cmd,
+      "location-request pipeline-depth <0-100>",
+      "Location Requests\n"
+      "Queue Perform Location Requests on an Lb connection behind a pending one, and answer them all from the same"
+      " TA; when the pending one fails, start the queued ones in turn\n"
+      "Number of queued requests per Lb connection; 0 to ignore Perform Location Requests while one is pending\n")
+{
+	g_smlc->loc_req_pipeline_depth = atoi(argv[0]);
+	return CMD_SUCCESS;
+}
+
+#define POSITIONING_STR "Computing location estimates\n"
+
+DEFUN(cfg_smlc_positioning_threads, cfg_smlc_positioning_threads_cmd,
+      "positioning threads <0-64>",
+      POSITIONING_STR
+      "Compute location estimates on worker threads, so that the main thread keeps serving the Lb interface\n"
+      "Number of threads; 0 to compute on the main thread\n")
+{
+	unsigned int n = atoi(argv[0]);
+
+	if (n == g_smlc->positioning_threads)
+		return CMD_SUCCESS;
+	g_smlc->positioning_threads = n;
+	/* When reading the config file, the threads are started once osmo-smlc is done forking */
+	if (vty->type != VTY_FILE)
+		smlc_loc_req_positioning_restart();
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_positioning_deadline, cfg_smlc_positioning_deadline_cmd,
+      "positioning deadline <10-600000>",
+      POSITIONING_STR
+      "Fail a location request when its location estimate is not computed in time on a positioning thread\n"
+      "Time in milliseconds\n")
+{
+	g_smlc->positioning_deadline_ms = atoi(argv[0]);
+	return CMD_SUCCESS;
+}
+
+DEFUN(cfg_smlc_overload, cfg_smlc_overload_cmd,
+      "overload (skip-debug-log|reject-normal|refuse-connection)"
+      " (lag|lb-conns|location-requests|subscribers) <0-100000000>",
+      "Shed load in graded steps when the main loop lags or too many objects are live\n"
+      "Raise the log level of all log targets to at least INFO\n"
+      "Also reject new Perform Location Requests of normal priority with LCS cause 'congestion'\n"
+      "Also refuse new SCCP connections at N-CONNECT\n"
+      "Smoothed lateness of the main loop in ms\n"
+      "Number of Lb connections\n"
+      "Number of location requests waiting for the TA or in the admission queue\n"
+      "Number of subscribers\n"
+      "Enter the state at this value, leave it when all values are below 80 percent of their thresholds;"
+      " 0 to disable\n")
+{
+	enum smlc_overload_state state = get_string_value(smlc_overload_state_names, argv[0]);
+	enum smlc_overload_metric m = get_string_value(smlc_overload_metric_names, argv[1]);
+	g_smlc->overload->threshold[state][m] = atoi(argv[2]);
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_last_locations, show_last_locations_cmd,
+      "show last-locations",
+      SHOW_STR "Show how many last known subscriber locations are remembered\n")
+{
+	vty_out(vty, "%u of max %u last known locations, max-age %u seconds%s",
+		g_smlc->last_locations_count, g_smlc->last_location_capacity, g_smlc->last_location_max_age,
+		VTY_NEWLINE);
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_pools, show_pools_cmd,
+      "show pools",
+      SHOW_STR "Show preallocated memory for objects of each location transaction\n")
+{
+	smlc_pool_vty_show(vty, g_smlc->lb_conn_pool);
+	smlc_pool_vty_show(vty, g_smlc->loc_req_pool);
+	smlc_pool_vty_show(vty, g_smlc->lb_msgb_pool);
+	return CMD_SUCCESS;
+}
+
+#define SHOW_LATENCY_STR SHOW_STR "Location Requests\n" "Show latency histograms of answered location requests\n"
+
+DEFUN(show_location_request_latency, show_location_request_latency_cmd,
+      "show location-request latency",
+      SHOW_LATENCY_STR)
+{
+	vty_out(vty, "All Lb peers:%s", VTY_NEWLINE);
+	smlc_latency_vty_show(vty, &g_smlc->latency);
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_location_request_latency_priority, show_location_request_latency_priority_cmd,
+      "show location-request latency priority",
+      SHOW_LATENCY_STR "Show the histograms of each location request priority separately\n")
+{
+	enum smlc_loc_req_prio prio;
+
+	for (prio = 0; prio < _NUM_SMLC_LOC_REQ_PRIO; prio++) {
+		vty_out(vty, "%s priority:%s", get_value_string(smlc_loc_req_prio_names, prio), VTY_NEWLINE);
+		smlc_latency_vty_show(vty, &g_smlc->latency_by_prio[prio]);
+	}
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_location_request_latency_lb_peers, show_location_request_latency_lb_peers_cmd,
+      "show location-request latency lb-peers",
+      SHOW_LATENCY_STR "Show the histograms of each Lb peer separately\n")
+{
+	struct lb_peer *lbp;
+
+	if (!g_smlc->lb)
+		return CMD_SUCCESS;
+	llist_for_each_entry(lbp, &g_smlc->lb->lb_peers, entry) {
+		vty_out(vty, "%s:%s", lbp->fi->id ? : lbp->fi->name, VTY_NEWLINE);
+		smlc_latency_vty_show(vty, &lbp->latency);
+	}
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_location_request_admission, show_location_request_admission_cmd,
+      "show location-request admission",
+      SHOW_STR "Location Requests\n" "Show active and queued location requests by priority\n")
+{
+	smlc_admission_vty_show(vty, g_smlc->admission);
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_location_request_ta_timeout, show_location_request_ta_timeout_cmd,
+      "show location-request ta-timeout",
+      SHOW_STR "Location Requests\n" "Show the timeout for BSSLAP TA Responses of each Lb peer\n")
+{
+	struct lb_peer *lbp;
+
+	if (g_smlc->ta_timeout == SMLC_TA_TIMEOUT_ADAPTIVE)
+		vty_out(vty, "ta-timeout adaptive, min %lu ms, max %lu ms%s",
+			g_smlc->ta_timeout_min_ms, g_smlc->ta_timeout_max_ms, VTY_NEWLINE);
+	else
+		vty_out(vty, "ta-timeout fixed, T-12 = %lu ms%s", lb_peer_ta_timeout_ms(NULL), VTY_NEWLINE);
+
+	if (!g_smlc->lb)
+		return CMD_SUCCESS;
+	llist_for_each_entry(lbp, &g_smlc->lb->lb_peers, entry) {
+		vty_out(vty, "%s: timeout %lu ms, srtt %u us, rttvar %u us, %u round trips, %u timeouts in a row%s",
+			lbp->fi->id ? : lbp->fi->name, lb_peer_ta_timeout_ms(lbp), lbp->ta_rtt.srtt_us,
+			lbp->ta_rtt.rttvar_us, lbp->ta_rtt.samples, lbp->ta_rtt.backoff, VTY_NEWLINE);
+	}
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_rate_limit, show_rate_limit_cmd,
+      "show rate-limit",
+      SHOW_STR "Show the rate limit token buckets of each Lb peer\n")
+{
+	struct lb_peer *lbp;
+
+	vty_out(vty, "connection: rate %u burst %u, location-request: rate %u burst %u%s",
+		g_smlc->rate_limit_conn.rate, g_smlc->rate_limit_conn.burst,
+		g_smlc->rate_limit_loc_req.rate, g_smlc->rate_limit_loc_req.burst, VTY_NEWLINE);
+
+	if (!g_smlc->lb)
+		return CMD_SUCCESS;
+	llist_for_each_entry(lbp, &g_smlc->lb->lb_peers, entry) {
+		vty_out(vty, "%s:%s", lbp->fi->id ? : lbp->fi->name, VTY_NEWLINE);
+		vty_out(vty, " connection: %u tokens, %" PRIu64 " refused%s",
+			token_bucket_tokens(&lbp->conn_bucket, &g_smlc->rate_limit_conn),
+			lbp->ctrs->ctr[LB_PEER_CTR_RATE_LIMIT_CONN_REFUSED].current, VTY_NEWLINE);
+		vty_out(vty, " location-request: %u tokens, %" PRIu64 " rejected%s",
+			token_bucket_tokens(&lbp->loc_req_bucket, &g_smlc->rate_limit_loc_req),
+			lbp->ctrs->ctr[LB_PEER_CTR_RATE_LIMIT_LOC_REQ_REJECTED].current, VTY_NEWLINE);
+	}
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_overload, show_overload_cmd,
+      "show overload",
+      SHOW_STR "Show the overload state, its metrics and thresholds\n")
+{
+	smlc_overload_vty_show(vty, g_smlc->overload);
+	return CMD_SUCCESS;
+}
+
+DEFUN(show_positioning, show_positioning_cmd,
+      "show positioning",
+      SHOW_STR "Show the positioning threads\n")
+{
+	vty_out(vty, "deadline %lu ms, %" PRIu64 " computed on threads, %" PRIu64 " expired%s",
+		g_smlc->positioning_deadline_ms, g_smlc->ctrs->ctr[SMLC_CTR_POSITIONING_POOLED].current,
+		g_smlc->ctrs->ctr[SMLC_CTR_POSITIONING_EXPIRED].current, VTY_NEWLINE);
+	if (!g_smlc->pos_workers) {
+		vty_out(vty, "Computing on the main thread%s", VTY_NEWLINE);
+		return CMD_SUCCESS;
+	}
+	smlc_workers_vty_show(vty, g_smlc->pos_workers);
+	return CMD_SUCCESS;
+}
+
+int smlc_vty_init(void)
+{
+	install_element(CONFIG_NODE, &cfg_smlc_cmd);
+	install_node(&smlc_node, config_write_smlc);
+	install_element(SMLC_NODE, &cfg_smlc_pool_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_last_location_max_age_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_last_location_capacity_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_handover_ta_max_age_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_cell_id_only_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_cell_id_only_default_radius_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_ta_timeout_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_ta_timeout_min_max_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_admission_max_active_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_admission_max_backlog_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_rate_limit_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_loc_req_pipeline_depth_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_positioning_threads_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_positioning_deadline_cmd);
+	install_element(SMLC_NODE, &cfg_smlc_overload_cmd);
+	install_element_ve(&show_pools_cmd);
+	install_element_ve(&show_last_locations_cmd);
+	install_element_ve(&show_location_request_latency_cmd);
+	install_element_ve(&show_location_request_latency_lb_peers_cmd);
+	install_element_ve(&show_location_request_latency_priority_cmd);
+	install_element_ve(&show_location_request_ta_timeout_cmd);
+	install_element_ve(&show_location_request_admission_cmd);
+	install_element_ve(&show_rate_limit_cmd);
+	install_element_ve(&show_overload_cmd);
+	install_element_ve(&show_positioning_cmd);
+	return 0;
+}
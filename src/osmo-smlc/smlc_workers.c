@@ -0,0 +1,261 @@
+/* OsmoSMLC: pool of worker threads fed through lock-free rings */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/logging.h>
+#include <osmocom/vty/vty.h>
+
+#include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/smlc_ring.h>
+#include <osmocom/smlc/smlc_workers.h>
+
+/* Add 1 to an eventfd. This only fails if the counter would overflow, so the result is not checked. */
+static void eventfd_add(int fd)
+{
+	uint64_t one = 1;
+	if (write(fd, &one, sizeof(one)) != sizeof(one))
+		return;
+}
+
+static void *smlc_worker_main(void *arg)
+{
+	struct smlc_worker *w = arg;
+	struct smlc_workers *workers = w->workers;
+	struct smlc_work *work;
+	char name[32];
+	uint64_t val;
+
+	snprintf(name, sizeof(name), "%s-%u", workers->name, w->nr);
+	/* Per-thread OTC_SELECT and OTC_GLOBAL, in case the jobs use them */
+	osmo_ctx_init(name);
+
+	while (1) {
+		unsigned int n = 0;
+
+		while ((work = smlc_ring_pop(w->jobs))) {
+			work->run(work);
+			/* Cannot fail, see smlc_worker->in_flight */
+			OSMO_ASSERT(smlc_ring_push(w->done, work));
+			if (++n % SMLC_WORKERS_BATCH == 0)
+				eventfd_add(workers->done_ofd.fd);
+		}
+		if (n % SMLC_WORKERS_BATCH)
+			eventfd_add(workers->done_ofd.fd);
+		/* There is no select loop on this thread to clean up */
+		talloc_free_children(OTC_SELECT);
+
+		if (atomic_load(&workers->stop))
+			break;
+
+		/* Sleep until smlc_workers_submit() adds jobs. Tell first, then look again, so that jobs added meanwhile are
+		 * not missed: either this sees them, or smlc_workers_submit() sees sleeping == true and wakes this thread. */
+		atomic_store(&w->sleeping, true);
+		atomic_thread_fence(memory_order_seq_cst);
+		if (!smlc_ring_count(w->jobs) && !atomic_load(&workers->stop)) {
+			if (read(w->wake_fd, &val, sizeof(val)) < 0 && errno != EINTR)
+				break;
+		}
+		atomic_store(&w->sleeping, false);
+	}
+
+	talloc_free(osmo_ctx);
+	return NULL;
+}
+
+/* Move completed jobs to the backlog, without calling their done cb */
+static void smlc_worker_take_done(struct smlc_worker *w)
+{
+	struct smlc_work *work;
+
+	while ((work = smlc_ring_pop(w->done))) {
+		llist_add_tail(&work->entry, &w->backlog);
+		w->in_flight--;
+	}
+}
+
+/* Call the done cb of all completed jobs */
+void smlc_workers_poll(struct smlc_workers *workers)
+{
+	struct smlc_work *work;
+	unsigned int i;
+
+	for (i = 0; i < workers->num_workers; i++) {
+		struct smlc_worker *w = &workers->workers[i];
+
+		smlc_worker_take_done(w);
+		while ((work = llist_first_entry_or_null(&w->backlog, struct smlc_work, entry))) {
+			llist_del(&work->entry);
+			work->done(work);
+		}
+	}
+}
+
+static int smlc_workers_done_fd_cb(struct osmo_fd *ofd, unsigned int what)
+{
+	struct smlc_workers *workers = ofd->data;
+	uint64_t val;
+
+	if (read(ofd->fd, &val, sizeof(val)) < 0 && errno != EAGAIN)
+		return -errno;
+	smlc_workers_poll(workers);
+	return 0;
+}
+
+/* Start num_workers threads named after name, each handling up to queue_len jobs at a time. Return NULL on error. */
+struct smlc_workers *smlc_workers_alloc(void *ctx, const char *name, unsigned int num_workers, unsigned int queue_len)
+{
+	struct smlc_workers *workers;
+	unsigned int i;
+	int fd;
+
+	OSMO_ASSERT(num_workers);
+
+	workers = talloc_zero(ctx, struct smlc_workers);
+	OSMO_ASSERT(workers);
+	workers->name = talloc_strdup(workers, name);
+	workers->queue_len = queue_len;
+	atomic_init(&workers->stop, false);
+
+	fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd < 0) {
+		LOGP(DSMLC, LOGL_ERROR, "Cannot create eventfd for %s threads: %s\n", name, strerror(errno));
+		talloc_free(workers);
+		return NULL;
+	}
+	osmo_fd_setup(&workers->done_ofd, fd, OSMO_FD_READ, smlc_workers_done_fd_cb, workers, 0);
+	if (osmo_fd_register(&workers->done_ofd)) {
+		close(fd);
+		talloc_free(workers);
+		return NULL;
+	}
+
+	/* The workers may log, e.g. from within libosmogsm */
+	log_enable_multithread();
+
+	workers->workers = talloc_zero_array(workers, struct smlc_worker, num_workers);
+	OSMO_ASSERT(workers->workers);
+	for (i = 0; i < num_workers; i++) {
+		struct smlc_worker *w = &workers->workers[i];
+		int rc;
+
+		workers->num_workers++;
+		w->workers = workers;
+		w->nr = i;
+		w->jobs = smlc_ring_alloc(workers, queue_len);
+		w->done = smlc_ring_alloc(workers, queue_len);
+		INIT_LLIST_HEAD(&w->backlog);
+		atomic_init(&w->sleeping, false);
+
+		w->wake_fd = eventfd(0, EFD_CLOEXEC);
+		if (w->wake_fd < 0) {
+			LOGP(DSMLC, LOGL_ERROR, "Cannot create eventfd for %s thread: %s\n", name, strerror(errno));
+			smlc_workers_free(workers);
+			return NULL;
+		}
+		rc = pthread_create(&w->thread, NULL, smlc_worker_main, w);
+		if (rc) {
+			LOGP(DSMLC, LOGL_ERROR, "Cannot start %s thread: %s\n", name, strerror(rc));
+			smlc_workers_free(workers);
+			return NULL;
+		}
+		w->started = true;
+	}
+
+	LOGP(DSMLC, LOGL_NOTICE, "Started %u %s threads\n", num_workers, name);
+	return workers;
+}
+
+/* Stop the threads after they have run all submitted jobs, and call the done cb for those */
+void smlc_workers_free(struct smlc_workers *workers)
+{
+	unsigned int i;
+
+	if (!workers)
+		return;
+
+	atomic_store(&workers->stop, true);
+	for (i = 0; i < workers->num_workers; i++) {
+		struct smlc_worker *w = &workers->workers[i];
+		if (!w->started)
+			continue;
+		eventfd_add(w->wake_fd);
+		pthread_join(w->thread, NULL);
+	}
+
+	smlc_workers_poll(workers);
+
+	for (i = 0; i < workers->num_workers; i++) {
+		if (workers->workers[i].wake_fd > 0)
+			close(workers->workers[i].wake_fd);
+	}
+	osmo_fd_unregister(&workers->done_ofd);
+	close(workers->done_ofd.fd);
+	talloc_free(workers);
+}
+
+/* Hand a job to the worker for shard. Its done cb is called later from the main loop, never from within this
+ * function. This never waits for the worker: return -EAGAIN if it is a full ring behind, and leave the job to the
+ * caller, e.g. to run it on the main thread. */
+int smlc_workers_submit(struct smlc_workers *workers, unsigned int shard, struct smlc_work *work)
+{
+	struct smlc_worker *w = &workers->workers[shard % workers->num_workers];
+
+	/* Make room from jobs the worker completed since the last smlc_workers_poll(), keeping them for that */
+	if (w->in_flight >= workers->queue_len)
+		smlc_worker_take_done(w);
+	if (w->in_flight >= workers->queue_len) {
+		workers->queue_full++;
+		return -EAGAIN;
+	}
+
+	OSMO_ASSERT(smlc_ring_push(w->jobs, work));
+	w->in_flight++;
+	w->submitted++;
+
+	/* Pairs with the fence in smlc_worker_main() */
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load(&w->sleeping))
+		eventfd_add(w->wake_fd);
+	return 0;
+}
+
+void smlc_workers_vty_show(struct vty *vty, const struct smlc_workers *workers)
+{
+	unsigned int i;
+
+	vty_out(vty, "%s: %u threads, %" PRIu64 " jobs refused for a full queue%s", workers->name,
+		workers->num_workers, workers->queue_full, VTY_NEWLINE);
+	for (i = 0; i < workers->num_workers; i++) {
+		const struct smlc_worker *w = &workers->workers[i];
+		vty_out(vty, " thread %u: %" PRIu64 " jobs, %u in flight%s", w->nr, w->submitted, w->in_flight,
+			VTY_NEWLINE);
+	}
+}
@@ -0,0 +1,68 @@
+/* OsmoSMLC adaptive BSSLAP TA Response timeout */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <osmocom/core/utils.h>
+
+#include <osmocom/smlc/ta_rtt.h>
+
+/* Add a measured round trip, with the gains of RFC 6298: alpha = 1/8, beta = 1/4. */
+void ta_rtt_sample(struct ta_rtt *rtt, uint64_t rtt_us)
+{
+	uint32_t r = OSMO_MIN(rtt_us, (uint64_t)UINT32_MAX);
+	uint32_t delta;
+
+	if (!rtt->samples) {
+		rtt->srtt_us = r;
+		rtt->rttvar_us = r / 2;
+	} else {
+		delta = (rtt->srtt_us > r) ? (rtt->srtt_us - r) : (r - rtt->srtt_us);
+		rtt->rttvar_us = ((uint64_t)rtt->rttvar_us * 3 + delta) / 4;
+		rtt->srtt_us = ((uint64_t)rtt->srtt_us * 7 + r) / 8;
+	}
+	if (rtt->samples < UINT32_MAX)
+		rtt->samples++;
+	rtt->backoff = 0;
+}
+
+/* A TA Response did not arrive in time: back off until the next measured round trip. */
+void ta_rtt_timed_out(struct ta_rtt *rtt)
+{
+	if (rtt->backoff < TA_RTT_MAX_BACKOFF)
+		rtt->backoff++;
+}
+
+/* Return the timeout to wait for a TA Response: srtt + 4 * rttvar, doubled for each timeout since the last measured
+ * round trip, clamped to [min_ms, max_ms]. Before any round trip was measured, start from initial_ms. */
+unsigned long ta_rtt_timeout_ms(const struct ta_rtt *rtt, unsigned long initial_ms, unsigned long min_ms,
+				unsigned long max_ms)
+{
+	uint64_t timeout_ms;
+
+	if (!rtt->samples)
+		timeout_ms = initial_ms;
+	else
+		timeout_ms = ((uint64_t)rtt->srtt_us + 4 * (uint64_t)rtt->rttvar_us + 999) / 1000;
+	timeout_ms <<= rtt->backoff;
+
+	return OSMO_MAX(min_ms, OSMO_MIN(max_ms, timeout_ms));
+}
@@ -0,0 +1,171 @@
+/* OsmoSMLC timer wheel for transaction timeouts */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/timer_compat.h>
+#include <osmocom/smlc/timer_wheel.h>
+
+static uint64_t timer_wheel_current_tick(const struct timer_wheel *w, unsigned long *ms_into_tick)
+{
+	struct timespec now;
+	struct timespec elapsed;
+	uint64_t elapsed_ms;
+
+	osmo_clock_gettime(CLOCK_MONOTONIC, &now);
+	timespecsub(&now, &w->epoch, &elapsed);
+	elapsed_ms = (uint64_t)elapsed.tv_sec * 1000 + elapsed.tv_nsec / 1000000;
+	if (ms_into_tick)
+		*ms_into_tick = elapsed_ms % w->tick_ms;
+	return elapsed_ms / w->tick_ms;
+}
+
+/* Put a timer in the slot that is processed at its expiry tick, or, for a tick beyond the next 64 on a level, in the
+ * slot of the next level up that is cascaded down when the ticks it covers are up next. */
+static void timer_wheel_slot_add(struct timer_wheel *w, struct timer_wheel_timer *t)
+{
+	uint64_t delta = t->expires - w->now;
+	unsigned int level;
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+		if (delta < (1ULL << (TIMER_WHEEL_SLOT_BITS * (level + 1))))
+			break;
+	}
+	llist_add_tail(&t->entry,
+		       &w->slots[level][(t->expires >> (TIMER_WHEEL_SLOT_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)]);
+}
+
+/* Re-distribute the timers of one slot over the levels below */
+static void timer_wheel_cascade(struct timer_wheel *w, unsigned int level)
+{
+	struct llist_head *slot = &w->slots[level][(w->now >> (TIMER_WHEEL_SLOT_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)];
+	struct timer_wheel_timer *t, *t2;
+	LLIST_HEAD(cascade);
+
+	llist_splice_init(slot, &cascade);
+	llist_for_each_entry_safe(t, t2, &cascade, entry)
+		timer_wheel_slot_add(w, t);
+}
+
+static void timer_wheel_schedule_tick(struct timer_wheel *w)
+{
+	unsigned long ms_into_tick;
+	unsigned long ms;
+
+	timer_wheel_current_tick(w, &ms_into_tick);
+	ms = w->tick_ms - ms_into_tick;
+	osmo_timer_schedule(&w->timer, ms / 1000, (ms % 1000) * 1000);
+}
+
+/* Process all ticks up to the current time, and call the callbacks of all timers expired on the way in one batch. */
+static void timer_wheel_timer_cb(void *data)
+{
+	struct timer_wheel *w = data;
+	uint64_t tick = timer_wheel_current_tick(w, NULL);
+	struct timer_wheel_timer *t;
+	LLIST_HEAD(expired);
+
+	while (w->now < tick && w->count) {
+		unsigned int level;
+
+		w->now++;
+		for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+			if (w->now & ((1ULL << (TIMER_WHEEL_SLOT_BITS * level)) - 1))
+				break;
+			timer_wheel_cascade(w, level);
+		}
+		/* Append to the end of the batch, to call the callbacks in order of expiry */
+		llist_splice_init(&w->slots[0][w->now & (TIMER_WHEEL_SLOTS - 1)], expired.prev);
+	}
+	/* With no timers pending, there is nothing to process in the skipped ticks */
+	w->now = tick;
+
+	/* A callback may remove other timers of this batch, so take them off the list one by one */
+	while ((t = llist_first_entry_or_null(&expired, struct timer_wheel_timer, entry))) {
+		llist_del_init(&t->entry);
+		w->count--;
+		t->cb(t->data);
+	}
+
+	if (w->count && !osmo_timer_pending(&w->timer))
+		timer_wheel_schedule_tick(w);
+}
+
+struct timer_wheel *timer_wheel_alloc(void *ctx, unsigned int tick_ms)
+{
+	struct timer_wheel *w = talloc_zero(ctx, struct timer_wheel);
+	unsigned int level, slot;
+
+	OSMO_ASSERT(w);
+	OSMO_ASSERT(tick_ms);
+	w->tick_ms = tick_ms;
+	osmo_clock_gettime(CLOCK_MONOTONIC, &w->epoch);
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+		for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+			INIT_LLIST_HEAD(&w->slots[level][slot]);
+	osmo_timer_setup(&w->timer, timer_wheel_timer_cb, w);
+	return w;
+}
+
+void timer_wheel_timer_setup(struct timer_wheel_timer *t, void (*cb)(void *data), void *data)
+{
+	*t = (struct timer_wheel_timer){
+		.cb = cb,
+		.data = data,
+	};
+	INIT_LLIST_HEAD(&t->entry);
+}
+
+/* (Re-)Start a timer to expire after timeout_ms, rounded up to the next tick. */
+void timer_wheel_schedule(struct timer_wheel *w, struct timer_wheel_timer *t, unsigned long timeout_ms)
+{
+	unsigned long ms_into_tick;
+	uint64_t tick;
+
+	timer_wheel_del(t);
+
+	tick = timer_wheel_current_tick(w, &ms_into_tick);
+	if (!w->count) {
+		/* Nothing to process in between, skip ahead to the current tick */
+		w->now = tick;
+		timer_wheel_schedule_tick(w);
+	}
+
+	t->wheel = w;
+	t->expires = tick + (ms_into_tick + timeout_ms + w->tick_ms - 1) / w->tick_ms;
+	/* The slot of the current tick is processed next only after a full round */
+	t->expires = OSMO_MAX(t->expires, w->now + 1);
+	t->expires = OSMO_MIN(t->expires, w->now + TIMER_WHEEL_MAX_TICKS);
+	timer_wheel_slot_add(w, t);
+	w->count++;
+}
+
+void timer_wheel_del(struct timer_wheel_timer *t)
+{
+	if (!timer_wheel_pending(t))
+		return;
+	llist_del_init(&t->entry);
+	t->wheel->count--;
+	if (!t->wheel->count)
+		osmo_timer_del(&t->wheel->timer);
+}
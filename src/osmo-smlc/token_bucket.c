@@ -0,0 +1,83 @@
+/* OsmoSMLC token bucket rate limiter */
+/*
+ * (C) 2026 by sysmocom - s.f.m.c. GmbH <info@sysmocom.de>
+ * All Rights Reserved
+ *
+ * SPDX-License-Identifier: GPL-2.0+
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/timer.h>
+#include <osmocom/core/timer_compat.h>
+
+#include <osmocom/smlc/token_bucket.h>
+
+/* Refilling the bucket from empty never takes longer than this, given a rate of at least one per second and a burst of
+ * at most a million. Longer quiet periods are cut short to this, to keep the arithmetic in range. */
+#define TOKEN_BUCKET_MAX_REFILL_US (1000000ULL * 1000000)
+
+static void token_bucket_refill(struct token_bucket *tb, const struct token_bucket_cfg *cfg)
+{
+	uint64_t max_millitokens = (uint64_t)cfg->burst * 1000;
+	struct timespec now;
+	struct timespec elapsed;
+	uint64_t elapsed_us;
+	uint64_t add;
+
+	osmo_clock_gettime(CLOCK_MONOTONIC, &now);
+	if (!tb->started) {
+		tb->started = true;
+		tb->millitokens = max_millitokens;
+		tb->last_refill = now;
+		return;
+	}
+
+	timespecsub(&now, &tb->last_refill, &elapsed);
+	if (elapsed.tv_sec < 0)
+		return;
+	elapsed_us = OSMO_MIN((uint64_t)elapsed.tv_sec * 1000000 + elapsed.tv_nsec / 1000, TOKEN_BUCKET_MAX_REFILL_US);
+
+	/* rate tokens per second are rate millitokens per millisecond */
+	add = elapsed_us * cfg->rate / 1000;
+	/* Keep the fraction of a millitoken for the next refill, by not moving last_refill before anything is added */
+	if (!add)
+		return;
+	tb->millitokens = OSMO_MIN(tb->millitokens + add, max_millitokens);
+	tb->last_refill = now;
+}
+
+/* Return true and take a token if the bucket holds one, or if cfg->rate is 0. Return false if the rate is exceeded. */
+bool token_bucket_take(struct token_bucket *tb, const struct token_bucket_cfg *cfg)
+{
+	if (!cfg->rate)
+		return true;
+
+	token_bucket_refill(tb, cfg);
+	if (tb->millitokens < 1000)
+		return false;
+	tb->millitokens -= 1000;
+	return true;
+}
+
+/* Return the number of whole tokens as of the last token_bucket_take(), for show commands */
+uint32_t token_bucket_tokens(const struct token_bucket *tb, const struct token_bucket_cfg *cfg)
+{
+	if (!tb->started)
+		return cfg->burst;
+	return OSMO_MIN(tb->millitokens / 1000, (uint64_t)cfg->burst);
+}
@@ -0,0 +1,587 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <osmocom/core/application.h>
+#include <osmocom/core/select.h>
+#include <osmocom/core/utils.h>
+#include <osmocom/gsm/gsm0808_utils.h>
+
+#include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/cell_locations.h>
+#include <osmocom/smlc/cell_db.h>
+#include <osmocom/smlc/cell_table.h>
+
+struct smlc_state *g_smlc;
+
+static uint32_t lcg_state;
+
+static uint32_t lcg_rand(void)
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static struct gsm0808_cell_id rand_cell_id(void)
+{
+	uint32_t r = lcg_rand();
+	struct gsm0808_cell_id cell_id;
+	struct osmo_cell_global_id cgi = {
+		.lai = {
+			.plmn = { .mcc = 901, .mnc = 70 },
+			.lac = 1 + (r % 1000),
+		},
+		.cell_identity = lcg_rand() & 0xffff,
+	};
+	gsm0808_cell_id_from_cgi(&cell_id, (r & 0x10000) ? CELL_IDENT_LAC_AND_CI : CELL_IDENT_WHOLE_GLOBAL, &cgi);
+	return cell_id;
+}
+
+/* The lookup as it was before cell_locations were indexed: walk the list for an exact match, then again for a partial
+ * match. */
+static struct cell_location *list_walk_find(const struct cell_locations *cl, const struct gsm0808_cell_id *cell_id)
+{
+	struct cell_location *cell;
+	llist_for_each_entry(cell, &cl->list, entry) {
+		if (gsm0808_cell_ids_match(&cell->cell_id, cell_id, true))
+			return cell;
+	}
+	llist_for_each_entry(cell, &cl->list, entry) {
+		if (gsm0808_cell_ids_match(&cell->cell_id, cell_id, false))
+			return cell;
+	}
+	return NULL;
+}
+
+static struct cell_locations *make_cells(void *ctx, unsigned int n, struct gsm0808_cell_id *ids)
+{
+	struct cell_locations *cl = cell_locations_alloc(ctx);
+	unsigned int i;
+
+	lcg_state = 23;
+	for (i = 0; i < n; i++) {
+		struct gsm0808_cell_id cell_id = rand_cell_id();
+		struct cell_location *cell = cell_locations_add(cl, &cell_id);
+		cell->lat = i;
+		if (ids)
+			ids[i] = cell_id;
+	}
+	return cl;
+}
+
+/* Queries for hits, fuzzy hits and misses of all kinds of cell identifier types */
+static struct gsm0808_cell_id make_query(const struct gsm0808_cell_id *ids, unsigned int n)
+{
+	static const enum CELL_IDENT discrs[] = {
+		CELL_IDENT_WHOLE_GLOBAL,
+		CELL_IDENT_LAC_AND_CI,
+		CELL_IDENT_LAC,
+		CELL_IDENT_CI,
+		CELL_IDENT_LAI_AND_LAC,
+	};
+	struct gsm0808_cell_id query;
+	struct osmo_cell_global_id cgi = {};
+	uint32_t r = lcg_rand();
+
+	if (r & 1)
+		query = ids[(r >> 1) % n];
+	else
+		query = rand_cell_id();
+
+	gsm0808_cell_id_to_cgi(&cgi, &query);
+	gsm0808_cell_id_from_cgi(&query, discrs[(r >> 4) % ARRAY_SIZE(discrs)], &cgi);
+	return query;
+}
+
+static void test_match_list_walk(void *ctx)
+{
+	static const unsigned int sizes[] = { 1, 10, 100, 1000, 5000 };
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		unsigned int n = sizes[i];
+		struct gsm0808_cell_id *ids = talloc_array(ctx, struct gsm0808_cell_id, n);
+		struct cell_locations *cl = make_cells(ctx, n, ids);
+		struct cell_location *cell;
+		unsigned int q;
+		unsigned int hits = 0;
+
+		OSMO_ASSERT(cl->count == n);
+
+		for (q = 0; q < 2000; q++) {
+			struct gsm0808_cell_id query = make_query(ids, n);
+			cell = cell_locations_find(cl, &query);
+			OSMO_ASSERT(cell == list_walk_find(cl, &query));
+			if (cell)
+				hits++;
+		}
+		OSMO_ASSERT(hits > 0);
+
+		/* Remove every other cell and compare again */
+		for (q = 0; q < n; q += 2) {
+			cell = cell_locations_find(cl, &ids[q]);
+			OSMO_ASSERT(cell);
+			cell_locations_del(cl, cell);
+		}
+		for (q = 0; q < 2000; q++) {
+			struct gsm0808_cell_id query = make_query(ids, n);
+			OSMO_ASSERT(cell_locations_find(cl, &query) == list_walk_find(cl, &query));
+		}
+
+		printf("- %u cells: lookups match the list walk\n", n);
+		talloc_free(cl);
+		talloc_free(ids);
+	}
+}
+
+/* Compile the cells to a cell database file and expect the same lookup results from it */
+static void test_cell_db(void *ctx)
+{
+	static const unsigned int sizes[] = { 0, 1, 10, 100, 1000, 5000 };
+	char path[] = "cell_locations_test.db.XXXXXX";
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	OSMO_ASSERT(mkstemp(path) >= 0);
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		unsigned int n = sizes[i];
+		struct gsm0808_cell_id *ids = talloc_array(ctx, struct gsm0808_cell_id, n + 1);
+		struct cell_locations *cl = make_cells(ctx, n, ids);
+		struct cell_db_record *records = talloc_array(ctx, struct cell_db_record, n + 1);
+		struct cell_location *cell;
+		struct cell_db *db;
+		uint32_t n_records = 0;
+		uint32_t n_written;
+		unsigned int q;
+
+		llist_for_each_entry(cell, &cl->list, entry) {
+			/* Skip exact duplicates, which a list walk never finds */
+			if (cell_locations_find(cl, &cell->cell_id) != cell)
+				continue;
+			records[n_records++] = (struct cell_db_record){
+				.lac = cell->cgi.lai.lac,
+				.ci = cell->cgi.cell_identity,
+				.mcc = cell->cgi.lai.plmn.mcc,
+				.mnc = cell->cgi.lai.plmn.mnc,
+				.mnc_3_digits = cell->cgi.lai.plmn.mnc_3_digits,
+				.id_discr = cell->cell_id.id_discr,
+				.seq = cell->seq,
+				.lat = cell->lat,
+				.radius = cell->seq % 1000,
+			};
+		}
+		OSMO_ASSERT(cell_db_write(path, records, n_records, &n_written) == 0);
+		OSMO_ASSERT(n_written == n_records);
+		OSMO_ASSERT(cell_db_open(ctx, &db, path) == 0);
+		OSMO_ASSERT(db->n_records == n_records);
+
+		for (q = 0; q < (n ? 2000 : 0); q++) {
+			struct gsm0808_cell_id query = make_query(ids, n);
+			const struct cell_db_record *rec = cell_db_find(db, &query);
+			cell = cell_locations_find(cl, &query);
+			OSMO_ASSERT(!rec == !cell);
+			OSMO_ASSERT(!rec || rec->lat == cell->lat);
+			OSMO_ASSERT(!rec || rec->radius == rec->seq % 1000);
+		}
+
+		printf("- %u cells: database lookups match\n", n);
+		talloc_free(db);
+		talloc_free(records);
+		talloc_free(cl);
+		talloc_free(ids);
+	}
+
+	/* Reject a file with a valid header whose CI index points past the records */
+	{
+		struct cell_db_record records[2] = {
+			{ .lac = 23, .ci = 42, .id_discr = CELL_IDENT_LAC_AND_CI },
+			{ .lac = 23, .ci = 43, .id_discr = CELL_IDENT_LAC_AND_CI },
+		};
+		struct cell_db_header hdr;
+		uint32_t bad = 2;
+		uint32_t n_written;
+		struct cell_db *db;
+		FILE *f;
+		OSMO_ASSERT(cell_db_write(path, records, 2, &n_written) == 0);
+		f = fopen(path, "r+");
+		OSMO_ASSERT(f);
+		OSMO_ASSERT(fread(&hdr, sizeof(hdr), 1, f) == 1);
+		OSMO_ASSERT(fseek(f, hdr.ci_index_ofs + sizeof(bad), SEEK_SET) == 0);
+		OSMO_ASSERT(fwrite(&bad, sizeof(bad), 1, f) == 1);
+		fclose(f);
+		OSMO_ASSERT(cell_db_open(ctx, &db, path) == -EINVAL);
+		printf("- corrupt CI index is rejected\n");
+	}
+
+	/* Reject a file that is not a cell database */
+	{
+		FILE *f = fopen(path, "w");
+		struct cell_db *db;
+		OSMO_ASSERT(f);
+		fprintf(f, "cells\n lac-ci 23 42 lat 23.23 lon 42.42\n");
+		fclose(f);
+		OSMO_ASSERT(cell_db_open(ctx, &db, path) == -EINVAL);
+		printf("- invalid file is rejected\n");
+	}
+
+	unlink(path);
+}
+
+static int32_t table_lat(const struct cell_table *cell_table, const struct gsm0808_cell_id *cell_id)
+{
+	const struct cell_location *cell = cell_locations_find(cell_table->cells, cell_id);
+	return cell ? cell->lat : -1;
+}
+
+/* Configuration changes are published as a new cell_table generation, built in chunks from the main loop, while a
+ * pinned generation stays unchanged */
+static void test_cell_table(void *ctx)
+{
+	const unsigned int n = 2500;
+	struct gsm0808_cell_id *ids = talloc_array(ctx, struct gsm0808_cell_id, n + 1);
+	struct cell_table *pinned;
+	struct cell_location *cell;
+	int iterations;
+
+	printf("\n%s()\n", __func__);
+
+	g_smlc = smlc_state_alloc(ctx);
+	g_smlc->cell_locations = make_cells(g_smlc, n, ids);
+	ids[n] = rand_cell_id();
+
+	OSMO_ASSERT(cell_table_rebuild_sync() == 0);
+	pinned = g_smlc->cell_table;
+	cell_table_get(pinned, __func__);
+	printf("- generation %u has %u cells\n", pinned->gen, pinned->cells->count);
+
+	/* Modify the configuration */
+	cell = cell_locations_find(g_smlc->cell_locations, &ids[0]);
+	cell->lat = 4242;
+	cell = cell_locations_add(g_smlc->cell_locations, &ids[n]);
+	cell->lat = 2323;
+	cell_table_rebuild();
+
+	for (iterations = 0; cell_table_rebuild_pending(); iterations++) {
+		OSMO_ASSERT(g_smlc->cell_table == pinned);
+		osmo_select_main(1);
+	}
+	printf("- generation %u has %u cells, built in %d main loop iterations\n",
+	       g_smlc->cell_table->gen, g_smlc->cell_table->cells->count, iterations);
+	OSMO_ASSERT(iterations == (n + 1 + CELL_TABLE_BUILD_CHUNK - 1) / CELL_TABLE_BUILD_CHUNK);
+	OSMO_ASSERT(table_lat(g_smlc->cell_table, &ids[0]) == 4242);
+	OSMO_ASSERT(table_lat(g_smlc->cell_table, &ids[n]) == 2323);
+
+	/* The pinned generation still has the old content */
+	OSMO_ASSERT(table_lat(pinned, &ids[0]) == 0);
+	OSMO_ASSERT(table_lat(pinned, &ids[n]) == -1);
+	OSMO_ASSERT(pinned->cells->count == n);
+	printf("- pinned generation %u is unchanged\n", pinned->gen);
+	cell_table_put(pinned, __func__);
+
+	/* A change during a build starts over, the next generation has all changes */
+	cell_table_rebuild();
+	osmo_select_main(1);
+	OSMO_ASSERT(cell_table_rebuild_pending());
+	cell = cell_locations_find(g_smlc->cell_locations, &ids[n]);
+	cell_locations_del(g_smlc->cell_locations, cell);
+	cell_table_rebuild();
+	while (cell_table_rebuild_pending())
+		osmo_select_main(1);
+	OSMO_ASSERT(table_lat(g_smlc->cell_table, &ids[n]) == -1);
+	printf("- generation %u has %u cells\n", g_smlc->cell_table->gen, g_smlc->cell_table->cells->count);
+
+	talloc_free(ids);
+}
+
+static void print_estimate_ctrs(void)
+{
+	printf("  cache hits: %" PRIu64 ", misses: %" PRIu64 "\n",
+	       g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_ESTIMATE_CACHE_HIT].current,
+	       g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_ESTIMATE_CACHE_MISS].current);
+}
+
+/* Encoded Location Estimates are cached per cell and TA, and a new cell table generation starts with an empty cache */
+static void test_estimate_cache(void *ctx)
+{
+	static const uint8_t tas[] = { 0, 5, 0, 5, 63, 5 };
+	struct gsm0808_cell_id cell_id = {
+		.id_discr = CELL_IDENT_LAC_AND_CI,
+		.id.lac_and_ci = { .lac = 23, .ci = 42 },
+	};
+	struct gsm0808_cell_id unknown = {
+		.id_discr = CELL_IDENT_LAC_AND_CI,
+		.id.lac_and_ci = { .lac = 23, .ci = 43 },
+	};
+	struct cell_location *cell;
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	g_smlc = smlc_state_alloc(ctx);
+	g_smlc->cell_locations = cell_locations_alloc(g_smlc);
+	cell = cell_locations_add(g_smlc->cell_locations, &cell_id);
+	cell->lat = 23230000;
+	cell->lon = 42420000;
+	OSMO_ASSERT(cell_table_rebuild_sync() == 0);
+
+	for (i = 0; i < ARRAY_SIZE(tas); i++) {
+		union gad_raw cached = {};
+		union gad_raw expect = {};
+		struct osmo_gad location;
+		struct osmo_gad expect_location;
+
+		OSMO_ASSERT(cell_table_location_estimate(g_smlc->cell_table, &cached, &location, &cell_id, tas[i]) == 0);
+		cell_location_estimate_from_ta(&expect_location, cell->lat, cell->lon, tas[i]);
+		OSMO_ASSERT(osmo_gad_enc(&expect, &expect_location) > 0);
+		OSMO_ASSERT(!memcmp(&cached, &expect, sizeof(expect)));
+		OSMO_ASSERT(!memcmp(&location.ell_point_unc_circle, &expect_location.ell_point_unc_circle,
+				    sizeof(location.ell_point_unc_circle)));
+	}
+	printf("- %zu estimates for 3 different TAs\n", ARRAY_SIZE(tas));
+	print_estimate_ctrs();
+
+	{
+		union gad_raw raw;
+		struct osmo_gad location;
+		OSMO_ASSERT(cell_table_location_estimate(g_smlc->cell_table, &raw, &location, &unknown, 5) == -ENOENT);
+		printf("- unknown cell\n");
+		print_estimate_ctrs();
+
+		cell->lat = 17170000;
+		OSMO_ASSERT(cell_table_rebuild_sync() == 0);
+		OSMO_ASSERT(cell_table_location_estimate(g_smlc->cell_table, &raw, &location, &cell_id, 5) == 0);
+		OSMO_ASSERT(location.ell_point_unc_circle.lat == 17170000);
+		printf("- modified cell in generation %u\n", g_smlc->cell_table->gen);
+		print_estimate_ctrs();
+	}
+
+	/* Once more cells and TAs were seen than the cache has slots, new ones still replace older ones */
+	{
+		struct gsm0808_cell_id many = {
+			.id_discr = CELL_IDENT_LAC_AND_CI,
+			.id.lac_and_ci = { .lac = 24 },
+		};
+		unsigned int n_cells = 2 * CELL_TABLE_ESTIMATES_SIZE / 64 + 1;
+		union gad_raw raw;
+		struct osmo_gad location;
+		uint64_t hits;
+		unsigned int ta;
+
+		for (i = 0; i < n_cells; i++) {
+			many.id.lac_and_ci.ci = i;
+			cell = cell_locations_add(g_smlc->cell_locations, &many);
+			cell->lat = 24000000 + i;
+			cell->lon = 42000000;
+		}
+		OSMO_ASSERT(cell_table_rebuild_sync() == 0);
+
+		for (i = 0; i < n_cells - 1; i++) {
+			many.id.lac_and_ci.ci = i;
+			for (ta = 0; ta < 64; ta++)
+				OSMO_ASSERT(cell_table_location_estimate(g_smlc->cell_table, &raw, &location, &many, ta)
+					    == 0);
+		}
+
+		hits = g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_ESTIMATE_CACHE_HIT].current;
+		many.id.lac_and_ci.ci = n_cells - 1;
+		OSMO_ASSERT(cell_table_location_estimate(g_smlc->cell_table, &raw, &location, &many, 7) == 0);
+		OSMO_ASSERT(cell_table_location_estimate(g_smlc->cell_table, &raw, &location, &many, 7) == 0);
+		OSMO_ASSERT(location.ell_point_unc_circle.lat == 24000000 + n_cells - 1);
+		printf("- %u cells x 64 TAs, then a new cell: %" PRIu64 " cache hit\n", n_cells - 1,
+		       g_smlc->ctrs->ctr[SMLC_CTR_LOCATION_ESTIMATE_CACHE_HIT].current - hits);
+	}
+}
+
+/* A configured cell radius, or one from the cell database file, is carried over to the cell_table, and is the
+ * uncertainty of an estimate without TA */
+static void test_cell_radius(void *ctx)
+{
+	struct gsm0808_cell_id cell_ids[] = {
+		{
+			.id_discr = CELL_IDENT_LAC_AND_CI,
+			.id.lac_and_ci = { .lac = 23, .ci = 42 },
+		},
+		{
+			.id_discr = CELL_IDENT_LAC_AND_CI,
+			.id.lac_and_ci = { .lac = 23, .ci = 43 },
+		},
+		{
+			.id_discr = CELL_IDENT_LAC_AND_CI,
+			.id.lac_and_ci = { .lac = 23, .ci = 44 },
+		},
+		{
+			.id_discr = CELL_IDENT_LAC_AND_CI,
+			.id.lac_and_ci = { .lac = 23, .ci = 45 },
+		},
+	};
+	struct cell_db_record records[] = {
+		{
+			.id_discr = CELL_IDENT_LAC_AND_CI,
+			.lac = 23,
+			.ci = 44,
+			.lat = 19190000,
+			.lon = 20200000,
+			.radius = 2000,
+		},
+		{
+			.id_discr = CELL_IDENT_LAC_AND_CI,
+			.lac = 23,
+			.ci = 45,
+			.seq = 1,
+			.lat = 21210000,
+			.lon = 22220000,
+		},
+	};
+	char path[] = "cell_locations_test.db.XXXXXX";
+	struct cell_location *cell;
+	uint32_t n_written;
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	OSMO_ASSERT(mkstemp(path) >= 0);
+	OSMO_ASSERT(cell_db_write(path, records, ARRAY_SIZE(records), &n_written) == 0);
+
+	g_smlc = smlc_state_alloc(ctx);
+	g_smlc->cell_db_path = talloc_strdup(g_smlc, path);
+	g_smlc->cell_locations = cell_locations_alloc(g_smlc);
+	cell = cell_locations_add(g_smlc->cell_locations, &cell_ids[0]);
+	cell->lat = 23230000;
+	cell->lon = 42420000;
+	cell->radius = 3000;
+	cell = cell_locations_add(g_smlc->cell_locations, &cell_ids[1]);
+	cell->lat = 17170000;
+	cell->lon = 18180000;
+	OSMO_ASSERT(cell_table_rebuild_sync() == 0);
+
+	for (i = 0; i < ARRAY_SIZE(cell_ids); i++) {
+		struct osmo_gad location;
+		uint32_t cell_idx;
+		int32_t lat, lon;
+		uint32_t radius;
+
+		OSMO_ASSERT(cell_table_find(g_smlc->cell_table, &cell_ids[i], &cell_idx, &lat, &lon, &radius) == 0);
+		printf("- %s: radius %u m\n", gsm0808_cell_id_name(&cell_ids[i]), radius);
+		if (!radius)
+			continue;
+
+		/* The uncertainty is rounded down to the next value that GAD can encode */
+		cell_location_estimate_from_radius(&location, lat, lon, radius);
+		OSMO_ASSERT(location.type == GAD_TYPE_ELL_POINT_UNC_CIRCLE);
+		OSMO_ASSERT(location.ell_point_unc_circle.lat == lat);
+		OSMO_ASSERT(location.ell_point_unc_circle.unc <= radius * 1000);
+		OSMO_ASSERT(location.ell_point_unc_circle.unc > radius * 1000 * 9 / 10);
+	}
+
+	unlink(path);
+}
+
+static double now_s(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Print the time per lookup for growing numbers of cells. Timing varies per host, hence only run on request. */
+static void bench_lookup(void *ctx)
+{
+	static const unsigned int sizes[] = { 100, 1000, 10000, 100000, 1000000 };
+	const unsigned int lookups = 1000000;
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		unsigned int n = sizes[i];
+		struct gsm0808_cell_id *ids = talloc_array(ctx, struct gsm0808_cell_id, n);
+		struct cell_locations *cl = make_cells(ctx, n, ids);
+		struct osmo_cell_global_id cgi = {};
+		struct gsm0808_cell_id query;
+		unsigned int q, hits = 0;
+		double t;
+
+		t = now_s();
+		for (q = 0; q < lookups; q++) {
+			/* Look up the CGI as a BSC sends it, whichever way the cell was configured */
+			gsm0808_cell_id_to_cgi(&cgi, &ids[lcg_rand() % n]);
+			gsm0808_cell_id_from_cgi(&query, CELL_IDENT_WHOLE_GLOBAL, &cgi);
+			if (cell_locations_find(cl, &query))
+				hits++;
+		}
+		t = now_s() - t;
+		OSMO_ASSERT(hits == lookups);
+
+		printf("- %7u cells: %.1f ns per lookup\n", n, t * 1e9 / lookups);
+		talloc_free(cl);
+		talloc_free(ids);
+	}
+}
+
+static const struct log_info_cat log_categories[] = {
+	[DSMLC] = {
+		.name = "DSMLC",
+		.description = "OsmoSMLC",
+		.enabled = 1, .loglevel = LOGL_DEBUG,
+	},
+	[DLCS] = {
+		.name = "DLCS",
+		.description = "Location Services",
+		.enabled = 1, .loglevel = LOGL_DEBUG,
+	},
+};
+
+static const struct log_info log_info = {
+	.cat = log_categories,
+	.num_cat = ARRAY_SIZE(log_categories),
+};
+
+int main(int argc, char **argv)
+{
+	void *ctx = talloc_named_const(NULL, 0, "cell_locations_test");
+
+	osmo_init_logging2(ctx, &log_info);
+	rate_ctr_init(ctx);
+
+	printf("Testing cell location lookups\n");
+
+	test_match_list_walk(ctx);
+	test_cell_db(ctx);
+	test_cell_table(ctx);
+	test_estimate_cache(ctx);
+	test_cell_radius(ctx);
+
+	if (argc > 1 && !strcmp(argv[1], "bench"))
+		bench_lookup(ctx);
+
+	printf("\nDone\n");
+	return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+
+#include <osmocom/smlc/conn_ids.h>
+
+#define VERBOSE_ASSERT(val, expect_op, fmt) \
+	do { \
+		printf(#val " == " fmt "\n", (val)); \
+		OSMO_ASSERT((val) expect_op); \
+	} while (0);
+
+static void *ctx;
+
+/* Deterministic pseudo random numbers, so that the output is stable */
+static uint32_t rnd_state = 1;
+static uint32_t rnd(void)
+{
+	rnd_state = rnd_state * 1103515245 + 12345;
+	return (rnd_state >> 8) & 0xffffff;
+}
+
+static void test_conn_ids(void)
+{
+	struct conn_ids *ids = conn_ids_alloc(ctx);
+	int rc;
+
+	printf("\n%s()\n", __func__);
+
+	VERBOSE_ASSERT(conn_ids_in_use(ids, 0), == true, "%d");
+	VERBOSE_ASSERT(ids->count, == 0, "%u");
+
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == 1, "%d");
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == 2, "%d");
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == 3, "%d");
+	rc = conn_ids_claim(ids, 2);
+	VERBOSE_ASSERT(rc, == -EEXIST, "%d");
+	rc = conn_ids_claim(ids, 0);
+	VERBOSE_ASSERT(rc, == -EEXIST, "%d");
+	rc = conn_ids_claim(ids, CONN_IDS_MAX + 1);
+	VERBOSE_ASSERT(rc, == -ERANGE, "%d");
+
+	/* An incoming connection takes the next ID, it is skipped */
+	rc = conn_ids_claim(ids, 4);
+	VERBOSE_ASSERT(rc, == 0, "%d");
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == 5, "%d");
+
+	/* A released ID is not reused right away */
+	conn_ids_release(ids, 2);
+	VERBOSE_ASSERT(conn_ids_in_use(ids, 2), == false, "%d");
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == 6, "%d");
+
+	/* Releasing 0 or an unused ID has no effect */
+	conn_ids_release(ids, 0);
+	conn_ids_release(ids, 2);
+	VERBOSE_ASSERT(conn_ids_in_use(ids, 0), == true, "%d");
+	VERBOSE_ASSERT(ids->count, == 5, "%u");
+
+	/* Wrap around to the start after the highest ID */
+	rc = conn_ids_claim(ids, CONN_IDS_MAX - 1);
+	VERBOSE_ASSERT(rc, == 0, "%d");
+	ids->next = CONN_IDS_MAX - 1;
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == CONN_IDS_MAX, "%d");
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == 2, "%d");
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == 7, "%d");
+
+	talloc_free(ids);
+}
+
+/* Use up all conn_ids, then keep releasing and allocating with only a few unused IDs left, and compare against a plain
+ * array of flags. */
+static void test_conn_ids_exhaustion(void)
+{
+	struct conn_ids *ids = conn_ids_alloc(ctx);
+	uint8_t *used = talloc_zero_array(ctx, uint8_t, CONN_IDS_MAX + 1);
+	uint32_t i;
+	int rc;
+	int round;
+	unsigned int mismatch = 0;
+
+	printf("\n%s()\n", __func__);
+
+	/* Some incoming connections were assigned IDs by the SCCP stack */
+	for (i = 0; i < 1000; i++) {
+		uint32_t id = rnd();
+		if (!id || used[id])
+			continue;
+		OSMO_ASSERT(conn_ids_claim(ids, id) == 0);
+		used[id] = 1;
+	}
+
+	for (;;) {
+		rc = conn_ids_next(ids);
+		if (rc < 0)
+			break;
+		if (!rc || used[rc])
+			mismatch++;
+		used[rc] = 1;
+	}
+	VERBOSE_ASSERT(rc, == -ENOSPC, "%d");
+	VERBOSE_ASSERT(ids->count, == CONN_IDS_MAX, "%u");
+	VERBOSE_ASSERT(mismatch, == 0, "%u");
+
+	/* Near exhaustion: release a few random IDs, the allocator has to find exactly those again */
+	for (round = 0; round < 100000; round++) {
+		int n = 1 + round % 5;
+		int j;
+		for (j = 0; j < n; j++) {
+			uint32_t id = rnd();
+			if (!id)
+				continue;
+			conn_ids_release(ids, id);
+			used[id] = 0;
+		}
+		while ((rc = conn_ids_next(ids)) > 0) {
+			if (used[rc])
+				mismatch++;
+			used[rc] = 1;
+		}
+		if (rc != -ENOSPC || ids->count != CONN_IDS_MAX)
+			mismatch++;
+	}
+	VERBOSE_ASSERT(mismatch, == 0, "%u");
+
+	/* The bitmap agrees with the flags */
+	for (i = 0; i <= CONN_IDS_MAX; i++) {
+		if (conn_ids_in_use(ids, i) != (i == 0 || used[i]))
+			mismatch++;
+	}
+	VERBOSE_ASSERT(mismatch, == 0, "%u");
+
+	/* Release all, claim all */
+	for (i = 1; i <= CONN_IDS_MAX; i++)
+		conn_ids_release(ids, i);
+	VERBOSE_ASSERT(ids->count, == 0, "%u");
+	for (i = 1; i <= CONN_IDS_MAX; i++) {
+		if (conn_ids_claim(ids, i))
+			mismatch++;
+	}
+	VERBOSE_ASSERT(mismatch, == 0, "%u");
+	rc = conn_ids_next(ids);
+	VERBOSE_ASSERT(rc, == -ENOSPC, "%d");
+
+	talloc_free(used);
+	talloc_free(ids);
+}
+
+int main(int argc, char **argv)
+{
+	ctx = talloc_named_const(NULL, 0, "conn_ids_test");
+
+	test_conn_ids();
+	test_conn_ids_exhaustion();
+
+	talloc_free(ctx);
+	printf("Done\n");
+	return 0;
+}
@@ -0,0 +1,341 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/msgb.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/gsm/bssmap_le.h>
+#include <osmocom/gsm/gad.h>
+
+#include <osmocom/smlc/lb_msgb.h>
+
+#define VERBOSE_ASSERT(val, expect_op, fmt) \
+	do { \
+		printf(#val " == " fmt "\n", (val)); \
+		OSMO_ASSERT((val) expect_op); \
+	} while (0);
+
+static void *ctx;
+
+/* Do what sccp_lb_down_l2_co() does to a msgb, and tell whether it stayed within the headroom */
+static void push_prim(struct msgb *msg)
+{
+	unsigned int headroom = msgb_headroom(msg);
+	unsigned int pad;
+
+	msg->l2h = msg->data;
+	pad = (uintptr_t)msg->data % 8;
+	printf("  data aligned: %s\n", pad ? "no" : "yes");
+	printf("  headroom for prim: %s\n", headroom >= pad + sizeof(struct osmo_scu_prim) ? "yes" : "no");
+}
+
+static void test_alloc(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", LB_MSGB_POOL_CHUNK_SIZE, 1, 1);
+	unsigned int len;
+
+	printf("\n%s()\n", __func__);
+	for (len = 0; len <= 16; len += 5) {
+		struct msgb *msg = lb_msgb_alloc(pool, len, __func__);
+		printf(" len=%u\n", len);
+		push_prim(msg);
+		printf("  tailroom: %s\n", msgb_tailroom(msg) >= len ? "yes" : "no");
+		lb_msgb_free(pool, msg);
+	}
+
+	printf(" without a pool\n");
+	{
+		struct msgb *msg = lb_msgb_alloc(NULL, 10, __func__);
+		push_prim(msg);
+		lb_msgb_free(NULL, msg);
+	}
+
+	printf(" longer than a chunk\n");
+	{
+		struct msgb *msg = lb_msgb_alloc(pool, LB_MSGB_POOL_MAX_LEN + 1, __func__);
+		push_prim(msg);
+		lb_msgb_free(pool, msg);
+	}
+	VERBOSE_ASSERT(pool->pooled, == 4, "%"PRIu64);
+	VERBOSE_ASSERT(pool->unpooled, == 0, "%"PRIu64);
+	VERBOSE_ASSERT(smlc_pool_in_use(pool), == 0, "%u");
+
+	talloc_free(pool);
+}
+
+/* Messages beyond the high water mark are allocated without the pool, and all chunks come back on free */
+static void test_pool(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", LB_MSGB_POOL_CHUNK_SIZE, 1, 2);
+	struct msgb *msg[3];
+	int i;
+
+	printf("\n%s()\n", __func__);
+	for (i = 0; i < ARRAY_SIZE(msg); i++) {
+		msg[i] = lb_msgb_alloc(pool, 10, __func__);
+		push_prim(msg[i]);
+	}
+	VERBOSE_ASSERT(pool->pooled, == 2, "%"PRIu64);
+	VERBOSE_ASSERT(pool->unpooled, == 1, "%"PRIu64);
+	VERBOSE_ASSERT(smlc_pool_in_use(pool), == 2, "%u");
+
+	for (i = 0; i < ARRAY_SIZE(msg); i++)
+		lb_msgb_free(pool, msg[i]);
+	VERBOSE_ASSERT(smlc_pool_in_use(pool), == 0, "%u");
+	VERBOSE_ASSERT(pool->chunk_count, == 2, "%u");
+
+	talloc_free(pool);
+}
+
+/* A msgb from some other talloc context is not handed to the pool, even if that context has the pool's name */
+static void test_pool_foreign(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", LB_MSGB_POOL_CHUNK_SIZE, 1, 1);
+	void *other = talloc_named_const(ctx, 0, pool->name);
+	struct msgb *msg;
+
+	printf("\n%s()\n", __func__);
+	msg = msgb_alloc_c(other, 64, __func__);
+	lb_msgb_free(pool, msg);
+	VERBOSE_ASSERT(pool->free_count, == 1, "%u");
+	VERBOSE_ASSERT(smlc_pool_in_use(pool), == 0, "%u");
+
+	talloc_free(other);
+	talloc_free(pool);
+}
+
+static const struct bssap_le_pdu expect_pdus[] = {
+	[LB_MSGB_TMPL_TA_REQUEST] = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = {
+			.msg_type = BSSMAP_LE_MSGT_CONN_ORIENTED_INFO,
+			.conn_oriented_info = {
+				.apdu = {
+					.msg_type = BSSLAP_MSGT_TA_REQUEST,
+				},
+			},
+		},
+	},
+	[LB_MSGB_TMPL_RESET] = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = {
+			.msg_type = BSSMAP_LE_MSGT_RESET,
+			.reset = GSM0808_CAUSE_EQUIPMENT_FAILURE,
+		},
+	},
+	[LB_MSGB_TMPL_RESET_ACK] = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = {
+			.msg_type = BSSMAP_LE_MSGT_RESET_ACK,
+		},
+	},
+};
+
+/* Each template must match what the BSSAP-LE encoder produces, also when taken more than once */
+static void test_tmpl(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", LB_MSGB_POOL_CHUNK_SIZE, 1, 1);
+	enum lb_msgb_tmpl tmpl;
+	int i;
+
+	printf("\n%s()\n", __func__);
+	for (tmpl = 0; tmpl < _NUM_LB_MSGB_TMPL; tmpl++) {
+		struct msgb *enc = osmo_bssap_le_enc(&expect_pdus[tmpl]);
+		printf(" %s\n", get_value_string(lb_msgb_tmpl_names, tmpl));
+		for (i = 0; i < 2; i++) {
+			struct msgb *msg = lb_msgb_tmpl(pool, tmpl);
+			printf("  same as encoder: %s\n",
+			       msg->len == enc->len && !memcmp(msg->data, enc->data, enc->len) ? "yes" : "no");
+			push_prim(msg);
+			lb_msgb_free(pool, msg);
+		}
+		msgb_free(enc);
+	}
+	VERBOSE_ASSERT(pool->unpooled, == 0, "%"PRIu64);
+
+	talloc_free(pool);
+}
+
+static const struct osmo_gad test_gads[] = {
+	{
+		.type = GAD_TYPE_ELL_POINT_UNC_CIRCLE,
+		.ell_point_unc_circle = { .lat = 52520008, .lon = 13404954, .unc = 1000000 },
+	},
+	{
+		.type = GAD_TYPE_ELL_POINT_UNC_CIRCLE,
+		.ell_point_unc_circle = { .lat = -33868820, .lon = 151209296, .unc = 3000 },
+	},
+	{
+		.type = GAD_TYPE_ELL_POINT,
+		.ell_point = { .lat = 48137154, .lon = 11576124 },
+	},
+};
+
+static const struct lcs_cause_ie test_causes[] = {
+	{ .present = true, .cause_val = LCS_CAUSE_SYSTEM_FAILURE },
+	{ .present = true, .cause_val = LCS_CAUSE_CONGESTION },
+	{ .present = true, .cause_val = LCS_CAUSE_REQUEST_ABORTED },
+	{ .present = true, .cause_val = LCS_CAUSE_SYSTEM_FAILURE, .diag_val_present = true, .diag_val = 23 },
+};
+
+static void check_perform_loc_resp(struct smlc_pool *pool, const struct bssmap_le_perform_loc_resp *resp)
+{
+	const struct bssap_le_pdu pdu = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = {
+			.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_RESP,
+			.perform_loc_resp = *resp,
+		},
+	};
+	struct msgb *enc = osmo_bssap_le_enc(&pdu);
+	int i;
+
+	OSMO_ASSERT(enc);
+	for (i = 0; i < 2; i++) {
+		struct msgb *msg = lb_msgb_perform_loc_resp(pool, resp);
+		if (!msg) {
+			printf("  left to the encoder\n");
+			continue;
+		}
+		printf("  same as encoder: %s\n",
+		       msg->len == enc->len && !memcmp(msg->data, enc->data, enc->len) ? "yes" : "no");
+		push_prim(msg);
+		lb_msgb_free(pool, msg);
+	}
+	msgb_free(enc);
+}
+
+/* Perform Location Responses composed from the template cache must match what the BSSAP-LE encoder produces */
+static void test_perform_loc_resp(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", LB_MSGB_POOL_CHUNK_SIZE, 1, 1);
+	struct bssmap_le_perform_loc_resp resp;
+	int i;
+
+	printf("\n%s()\n", __func__);
+	for (i = 0; i < ARRAY_SIZE(test_gads); i++) {
+		resp = (struct bssmap_le_perform_loc_resp){ .location_estimate_present = true };
+		OSMO_ASSERT(osmo_gad_enc(&resp.location_estimate, &test_gads[i]) > 0);
+		printf(" GAD type %d\n", test_gads[i].type);
+		check_perform_loc_resp(pool, &resp);
+	}
+	for (i = 0; i < ARRAY_SIZE(test_causes); i++) {
+		resp = (struct bssmap_le_perform_loc_resp){ .lcs_cause = test_causes[i] };
+		printf(" LCS Cause %d%s\n", test_causes[i].cause_val,
+		       test_causes[i].diag_val_present ? " with diagnostic value" : "");
+		check_perform_loc_resp(pool, &resp);
+	}
+
+	printf(" Location Estimate and LCS Cause\n");
+	resp = (struct bssmap_le_perform_loc_resp){
+		.location_estimate_present = true,
+		.lcs_cause = test_causes[0],
+	};
+	OSMO_ASSERT(osmo_gad_enc(&resp.location_estimate, &test_gads[0]) > 0);
+	check_perform_loc_resp(pool, &resp);
+
+	VERBOSE_ASSERT(pool->unpooled, == 0, "%"PRIu64);
+	VERBOSE_ASSERT(smlc_pool_in_use(pool), == 0, "%u");
+
+	talloc_free(pool);
+}
+
+/* Count calls to malloc() while enabled, to show how many allocations sending a message takes */
+static bool count_mallocs;
+static unsigned long mallocs;
+extern void *__libc_malloc(size_t size);
+void *malloc(size_t size)
+{
+	if (count_mallocs)
+		mallocs++;
+	return __libc_malloc(size);
+}
+
+static struct msgb *compose_ta_request(struct smlc_pool *pool)
+{
+	return lb_msgb_tmpl(pool, LB_MSGB_TMPL_TA_REQUEST);
+}
+
+static struct msgb *compose_perform_loc_resp(struct smlc_pool *pool)
+{
+	struct bssmap_le_perform_loc_resp resp = { .location_estimate_present = true };
+
+	osmo_gad_enc(&resp.location_estimate, &test_gads[0]);
+	return lb_msgb_perform_loc_resp(pool, &resp);
+}
+
+static double count_mallocs_per_msg(struct smlc_pool *pool, unsigned int n,
+				    struct msgb *(*compose)(struct smlc_pool *pool))
+{
+	unsigned int i;
+	/* Warm up, e.g. the template cache */
+	lb_msgb_free(pool, compose(pool));
+	mallocs = 0;
+	count_mallocs = true;
+	for (i = 0; i < n; i++) {
+		struct msgb *msg = compose(pool);
+		msgb_push(msg, sizeof(struct osmo_scu_prim));
+		lb_msgb_free(pool, msg);
+	}
+	count_mallocs = false;
+	return (double)mallocs / n;
+}
+
+static void bench_lb_msgb(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", LB_MSGB_POOL_CHUNK_SIZE, LB_MSGB_POOL_DEFAULT_SIZE,
+						 LB_MSGB_POOL_DEFAULT_HIGH_WATER_MARK);
+	printf("malloc() calls per BSSLAP TA Request with the pool: %.2f\n",
+	       count_mallocs_per_msg(pool, 100000, compose_ta_request));
+	printf("malloc() calls per Perform Location Response with the pool: %.2f\n",
+	       count_mallocs_per_msg(pool, 100000, compose_perform_loc_resp));
+	smlc_pool_set_size(pool, 0, 0);
+	printf("malloc() calls per BSSLAP TA Request without the pool: %.2f\n",
+	       count_mallocs_per_msg(pool, 100000, compose_ta_request));
+	printf("malloc() calls per Perform Location Response without the pool: %.2f\n",
+	       count_mallocs_per_msg(pool, 100000, compose_perform_loc_resp));
+	talloc_free(pool);
+}
+
+int main(int argc, char **argv)
+{
+	ctx = talloc_named_const(NULL, 0, "lb_msgb_test");
+
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		bench_lb_msgb();
+		return 0;
+	}
+
+	test_alloc();
+	test_pool();
+	test_pool_foreign();
+	test_tmpl();
+	test_perform_loc_resp();
+
+	talloc_free(ctx);
+	printf("\ndone\n");
+	return 0;
+}
@@ -0,0 +1,216 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/timer.h>
+
+#include <osmocom/smlc/smlc_admission.h>
+
+static void *ctx;
+static struct smlc_admission *adm;
+
+struct test_req {
+	struct smlc_admission_entry e;
+	char name[8];
+	/* Fail right when started, like a request whose TA Request cannot be sent */
+	bool fail_on_start;
+};
+
+static const struct value_string result_names[] = {
+	{ SMLC_ADMISSION_START, "START" },
+	{ SMLC_ADMISSION_QUEUED, "QUEUED" },
+	{ SMLC_ADMISSION_REJECTED, "REJECTED" },
+	{}
+};
+
+static void print_adm(void)
+{
+	printf("  active=%u queued: emergency=%u high=%u normal=%u\n", adm->active,
+	       adm->queued[SMLC_LOC_REQ_PRIO_EMERGENCY], adm->queued[SMLC_LOC_REQ_PRIO_HIGH],
+	       adm->queued[SMLC_LOC_REQ_PRIO_NORMAL]);
+}
+
+static void start_cb(struct smlc_admission_entry *e)
+{
+	struct test_req *r = container_of(e, struct test_req, e);
+	printf("  start %s (%s)\n", r->name, get_value_string(smlc_loc_req_prio_names, e->prio));
+	if (r->fail_on_start) {
+		printf("  %s fails\n", r->name);
+		smlc_admission_release(adm, e);
+	}
+}
+
+/* Let the drain timer run */
+static void main_loop(void)
+{
+	osmo_clock_override_add(CLOCK_MONOTONIC, 0, 1000);
+	osmo_timers_prepare();
+	osmo_timers_update();
+}
+
+static void request(struct test_req *r, enum smlc_loc_req_prio prio)
+{
+	enum smlc_admission_result res = smlc_admission_request(adm, &r->e, prio);
+	printf("request %s (%s): %s\n", r->name, get_value_string(smlc_loc_req_prio_names, prio),
+	       get_value_string(result_names, res));
+	if (res == SMLC_ADMISSION_START)
+		start_cb(&r->e);
+}
+
+static void release(struct test_req *r)
+{
+	printf("release %s\n", r->name);
+	smlc_admission_release(adm, &r->e);
+	main_loop();
+	print_adm();
+}
+
+static void init_reqs(struct test_req *reqs, int n)
+{
+	int i;
+	for (i = 0; i < n; i++) {
+		reqs[i] = (struct test_req){};
+		snprintf(reqs[i].name, sizeof(reqs[i].name), "r%d", i + 1);
+	}
+}
+
+static void test_no_limit(void)
+{
+	struct test_req r[3];
+	int i;
+
+	printf("\n%s()\n", __func__);
+	adm = smlc_admission_alloc(ctx, start_cb);
+	init_reqs(r, ARRAY_SIZE(r));
+	for (i = 0; i < ARRAY_SIZE(r); i++)
+		request(&r[i], SMLC_LOC_REQ_PRIO_NORMAL);
+	print_adm();
+	for (i = 0; i < ARRAY_SIZE(r); i++)
+		release(&r[i]);
+	talloc_free(adm);
+}
+
+static void test_priorities(void)
+{
+	struct test_req r[9];
+
+	printf("\n%s()\n", __func__);
+	adm = smlc_admission_alloc(ctx, start_cb);
+	adm->max_active = 2;
+	adm->max_backlog[SMLC_LOC_REQ_PRIO_HIGH] = 3;
+	adm->max_backlog[SMLC_LOC_REQ_PRIO_NORMAL] = 2;
+	init_reqs(r, ARRAY_SIZE(r));
+
+	request(&r[0], SMLC_LOC_REQ_PRIO_NORMAL);
+	request(&r[1], SMLC_LOC_REQ_PRIO_NORMAL);
+	request(&r[2], SMLC_LOC_REQ_PRIO_NORMAL);
+	request(&r[3], SMLC_LOC_REQ_PRIO_NORMAL);
+	/* Two are queued, the normal priority backlog is full */
+	request(&r[4], SMLC_LOC_REQ_PRIO_NORMAL);
+	request(&r[5], SMLC_LOC_REQ_PRIO_HIGH);
+	request(&r[6], SMLC_LOC_REQ_PRIO_EMERGENCY);
+	/* Four are queued, the high priority backlog is full, but emergency requests are never rejected */
+	request(&r[7], SMLC_LOC_REQ_PRIO_HIGH);
+	request(&r[8], SMLC_LOC_REQ_PRIO_EMERGENCY);
+	print_adm();
+
+	/* Emergency first, then high, then normal priority in the order they arrived */
+	release(&r[0]);
+	release(&r[1]);
+	release(&r[6]);
+	/* A queued request ends before it started, e.g. on Perform Location Abort */
+	release(&r[3]);
+	release(&r[8]);
+	release(&r[5]);
+	release(&r[2]);
+	OSMO_ASSERT(!adm->active && !adm->queued_total);
+	talloc_free(adm);
+}
+
+static void test_fail_on_start(void)
+{
+	struct test_req r[5];
+	int i;
+
+	printf("\n%s()\n", __func__);
+	adm = smlc_admission_alloc(ctx, start_cb);
+	adm->max_active = 1;
+	init_reqs(r, ARRAY_SIZE(r));
+
+	for (i = 0; i < ARRAY_SIZE(r); i++) {
+		r[i].fail_on_start = (i > 0 && i < 4);
+		request(&r[i], SMLC_LOC_REQ_PRIO_NORMAL);
+	}
+	print_adm();
+	/* The queued requests that fail right away make room for the next ones in one go */
+	release(&r[0]);
+	release(&r[4]);
+	OSMO_ASSERT(!adm->active && !adm->queued_total);
+	talloc_free(adm);
+}
+
+static void test_raise_max_active(void)
+{
+	struct test_req r[4];
+	int i;
+
+	printf("\n%s()\n", __func__);
+	adm = smlc_admission_alloc(ctx, start_cb);
+	adm->max_active = 1;
+	init_reqs(r, ARRAY_SIZE(r));
+
+	for (i = 0; i < ARRAY_SIZE(r); i++)
+		request(&r[i], SMLC_LOC_REQ_PRIO_NORMAL);
+	print_adm();
+
+	printf("max_active = 3\n");
+	adm->max_active = 3;
+	smlc_admission_kick(adm);
+	main_loop();
+	print_adm();
+
+	printf("max_active = 0\n");
+	adm->max_active = 0;
+	smlc_admission_kick(adm);
+	main_loop();
+	print_adm();
+
+	for (i = 0; i < ARRAY_SIZE(r); i++)
+		release(&r[i]);
+	talloc_free(adm);
+}
+
+int main(int argc, char **argv)
+{
+	ctx = talloc_named_const(NULL, 0, "smlc_admission_test");
+	osmo_clock_override_enable(CLOCK_MONOTONIC, true);
+
+	test_no_limit();
+	test_priorities();
+	test_fail_on_start();
+	test_raise_max_active();
+
+	printf("\nDone\n");
+	talloc_free(ctx);
+	return 0;
+}
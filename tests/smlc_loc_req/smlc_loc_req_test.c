@@ -0,0 +1,409 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/select.h>
+#include <osmocom/core/timer.h>
+#include <osmocom/core/tdef.h>
+#include <osmocom/core/fsm.h>
+#include <osmocom/core/logging.h>
+#include <osmocom/core/application.h>
+#include <osmocom/gsm/bsslap.h>
+#include <osmocom/gsm/bssmap_le.h>
+
+#include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/smlc_loc_req.h>
+#include <osmocom/smlc/smlc_admission.h>
+#include <osmocom/smlc/smlc_overload.h>
+#include <osmocom/smlc/lb_conn.h>
+#include <osmocom/smlc/lb_peer.h>
+#include <osmocom/smlc/cell_locations.h>
+#include <osmocom/smlc/cell_table.h>
+#include <osmocom/smlc/timer_wheel.h>
+
+#define VERBOSE_ASSERT(val, expect_op, fmt) \
+	do { \
+		printf(#val " == " fmt "\n", (val)); \
+		OSMO_ASSERT((val) expect_op); \
+	} while (0);
+
+struct smlc_state *g_smlc;
+
+#define LB_CONN_USE_TEST "test"
+
+static void *ctx;
+
+/* Stand-ins for sending on Lb: print what would be sent */
+
+int lb_conn_send_bssmap_le(struct lb_conn *lb_conn, const struct bssmap_le_pdu *bssmap_le)
+{
+	const struct bssmap_le_perform_loc_resp *resp = &bssmap_le->perform_loc_resp;
+
+	OSMO_ASSERT(bssmap_le->msg_type == BSSMAP_LE_MSGT_PERFORM_LOC_RESP);
+	if (resp->location_estimate_present)
+		printf("  Tx Perform Location Response: location estimate\n");
+	else
+		printf("  Tx Perform Location Response: LCS cause %u\n", resp->lcs_cause.cause_val);
+	return 0;
+}
+
+int lb_conn_send_tmpl(struct lb_conn *lb_conn, enum lb_msgb_tmpl tmpl)
+{
+	OSMO_ASSERT(tmpl == LB_MSGB_TMPL_TA_REQUEST);
+	printf("  Tx BSSLAP TA Request\n");
+	return 0;
+}
+
+struct lb_conn *lb_conn_find_by_smlc_subscr(struct smlc_subscr *smlc_subscr, const char *use_token)
+{
+	return NULL;
+}
+
+void lb_conn_close(struct lb_conn *lb_conn)
+{
+	OSMO_ASSERT(false);
+}
+
+unsigned long lb_peer_ta_timeout_ms(const struct lb_peer *lbp)
+{
+	return 10000;
+}
+
+bool lb_peer_admit_loc_req(struct lb_peer *lbp)
+{
+	return true;
+}
+
+static const struct gsm0808_cell_id cell_id = {
+	.id_discr = CELL_IDENT_LAC_AND_CI,
+	.id.lac_and_ci = {
+		.lac = 23,
+		.ci = 42,
+	},
+};
+
+static struct lb_conn *conn_alloc(void)
+{
+	struct lb_conn *lb_conn = talloc_zero(ctx, struct lb_conn);
+	OSMO_ASSERT(lb_conn);
+	lb_conn->sccp_conn_id = 1;
+	lb_conn->use_count.talloc_object = lb_conn;
+	INIT_LLIST_HEAD(&lb_conn->loc_req_queue);
+	lb_conn_get(lb_conn, LB_CONN_USE_TEST);
+	return lb_conn;
+}
+
+static void conn_free(struct lb_conn *lb_conn)
+{
+	OSMO_ASSERT(!lb_conn->smlc_loc_req);
+	OSMO_ASSERT(llist_empty(&lb_conn->loc_req_queue));
+	lb_conn_put(lb_conn, LB_CONN_USE_TEST);
+	OSMO_ASSERT(!osmo_use_count_total(&lb_conn->use_count));
+	talloc_free(lb_conn);
+	/* Free the terminated FSM instances */
+	osmo_select_main_ctx(1);
+}
+
+static void print_conn(const struct lb_conn *lb_conn)
+{
+	printf("  %s, %u queued\n", lb_conn->smlc_loc_req ? "pending" : "none pending", lb_conn->loc_req_queue_len);
+}
+
+static int rx_bssap_le(struct lb_conn *lb_conn, const struct bssmap_le_pdu *bssmap_le)
+{
+	struct bssap_le_pdu bssap_le = {
+		.discr = BSSAP_LE_MSG_DISCR_BSSMAP_LE,
+		.bssmap_le = *bssmap_le,
+	};
+	int rc = smlc_loc_req_rx_bssap_le(lb_conn, &bssap_le);
+	print_conn(lb_conn);
+	return rc;
+}
+
+static int rx_perform_loc_req(struct lb_conn *lb_conn)
+{
+	struct bssmap_le_pdu bssmap_le = {
+		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_REQ,
+		.perform_loc_req = {
+			.location_type = {
+				.location_information = BSSMAP_LE_LOC_INFO_CURRENT_GEOGRAPHIC,
+			},
+			.cell_id = cell_id,
+		},
+	};
+	int rc;
+
+	printf("Rx Perform Location Request\n");
+	rc = rx_bssap_le(lb_conn, &bssmap_le);
+	if (rc)
+		printf("  rc=%d\n", rc);
+	return rc;
+}
+
+static void rx_bsslap(struct lb_conn *lb_conn, enum bsslap_msgt msg_type)
+{
+	struct bssmap_le_pdu bssmap_le = {
+		.msg_type = BSSMAP_LE_MSGT_CONN_ORIENTED_INFO,
+		.conn_oriented_info.apdu = {
+			.msg_type = msg_type,
+		},
+	};
+
+	switch (msg_type) {
+	case BSSLAP_MSGT_TA_RESPONSE:
+		bssmap_le.conn_oriented_info.apdu.ta_response = (struct bsslap_ta_response){
+			.cell_id = cell_id.id.lac_and_ci.ci,
+			.ta = 5,
+		};
+		break;
+	case BSSLAP_MSGT_ABORT:
+		bssmap_le.conn_oriented_info.apdu.abort = BSSLAP_CAUSE_OTHER_RADIO_EVT_FAIL;
+		break;
+	default:
+		OSMO_ASSERT(false);
+	}
+
+	printf("Rx BSSLAP %s\n", osmo_bsslap_msgt_name(msg_type));
+	rx_bssap_le(lb_conn, &bssmap_le);
+}
+
+static void rx_perform_loc_abort(struct lb_conn *lb_conn)
+{
+	struct bssmap_le_pdu bssmap_le = {
+		.msg_type = BSSMAP_LE_MSGT_PERFORM_LOC_ABORT,
+		.perform_loc_abort = {
+			.present = true,
+			.cause_val = LCS_CAUSE_REQUEST_ABORTED,
+		},
+	};
+
+	printf("Rx Perform Location Abort\n");
+	rx_bssap_le(lb_conn, &bssmap_le);
+}
+
+static void clock_step(unsigned int ms)
+{
+	printf("%u ms later\n", ms);
+	osmo_clock_override_add(CLOCK_MONOTONIC, ms / 1000, (ms % 1000) * 1000000);
+	osmo_select_main_ctx(1);
+}
+
+static uint64_t ctr(unsigned int idx)
+{
+	return g_smlc->ctrs->ctr[idx].current;
+}
+
+static void reset_ctrs(void)
+{
+	unsigned int i;
+	for (i = 0; i < g_smlc->ctrs->desc->num_ctr; i++)
+		g_smlc->ctrs->ctr[i].current = 0;
+}
+
+/* The queued requests are answered from the TA Response to the pending one */
+static void test_coalesce(void)
+{
+	struct lb_conn *lb_conn = conn_alloc();
+
+	printf("\n%s()\n", __func__);
+	reset_ctrs();
+
+	rx_perform_loc_req(lb_conn);
+	rx_perform_loc_req(lb_conn);
+	rx_perform_loc_req(lb_conn);
+	rx_bsslap(lb_conn, BSSLAP_MSGT_TA_RESPONSE);
+
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_PIPELINED), == 2, "%"PRIu64);
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_COALESCED), == 2, "%"PRIu64);
+	conn_free(lb_conn);
+}
+
+/* When the pending request fails, the next queued one starts with its own TA Request */
+static void test_start_after_failure(void)
+{
+	struct lb_conn *lb_conn = conn_alloc();
+
+	printf("\n%s()\n", __func__);
+	reset_ctrs();
+
+	rx_perform_loc_req(lb_conn);
+	rx_perform_loc_req(lb_conn);
+	rx_perform_loc_req(lb_conn);
+	rx_bsslap(lb_conn, BSSLAP_MSGT_ABORT);
+	rx_bsslap(lb_conn, BSSLAP_MSGT_TA_RESPONSE);
+
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_PIPELINED), == 2, "%"PRIu64);
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_COALESCED), == 1, "%"PRIu64);
+	conn_free(lb_conn);
+}
+
+/* Requests beyond the pipeline depth are dropped, and a Perform Location Abort ends the pending and the queued ones */
+static void test_pipeline_full(void)
+{
+	struct lb_conn *lb_conn = conn_alloc();
+
+	printf("\n%s()\n", __func__);
+	reset_ctrs();
+	g_smlc->loc_req_pipeline_depth = 1;
+
+	rx_perform_loc_req(lb_conn);
+	rx_perform_loc_req(lb_conn);
+	OSMO_ASSERT(rx_perform_loc_req(lb_conn) == -EAGAIN);
+	rx_perform_loc_abort(lb_conn);
+
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_PIPELINED), == 1, "%"PRIu64);
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_PIPELINE_FULL), == 1, "%"PRIu64);
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_COALESCED), == 0, "%"PRIu64);
+
+	g_smlc->loc_req_pipeline_depth = SMLC_LOC_REQ_PIPELINE_DEFAULT_DEPTH;
+	conn_free(lb_conn);
+}
+
+/* After a RESET on Lb, lb_peer discards the lb_conn: lb_conn_close() ends the pending request, and the queued ones go
+ * away with the lb_conn instead of being started */
+static void test_reset(void)
+{
+	struct lb_conn *lb_conn = conn_alloc();
+
+	printf("\n%s()\n", __func__);
+	reset_ctrs();
+
+	rx_perform_loc_req(lb_conn);
+	rx_perform_loc_req(lb_conn);
+	rx_perform_loc_req(lb_conn);
+
+	printf("RESET on Lb, discarding the lb_conn\n");
+	/* What lb_conn_close() does about the smlc_loc_req */
+	lb_conn->closing = true;
+	osmo_fsm_inst_term(lb_conn->smlc_loc_req->fi, OSMO_FSM_TERM_REGULAR, NULL);
+	print_conn(lb_conn);
+
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_PIPELINED), == 2, "%"PRIu64);
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_COALESCED), == 0, "%"PRIu64);
+	VERBOSE_ASSERT(g_smlc->loc_reqs_count, == 0, "%u");
+
+	lb_conn_put(lb_conn, LB_CONN_USE_TEST);
+	OSMO_ASSERT(!osmo_use_count_total(&lb_conn->use_count));
+	/* The queued requests are talloc children of the lb_conn */
+	talloc_free(lb_conn);
+	osmo_select_main_ctx(1);
+}
+
+/* A request waiting in the admission queue for longer than T-16 is answered with LCS cause congestion, without ever
+ * asking the BSC for the TA */
+static void test_queue_timeout(void)
+{
+	struct lb_conn *active = conn_alloc();
+	struct lb_conn *queued = conn_alloc();
+	unsigned long t16_ms = osmo_tdef_get(g_smlc_tdefs, -16, OSMO_TDEF_MS, -1);
+
+	printf("\n%s()\n", __func__);
+	reset_ctrs();
+	memset(&g_smlc->latency, 0, sizeof(g_smlc->latency));
+	g_smlc->admission->max_active = 1;
+
+	rx_perform_loc_req(active);
+	rx_perform_loc_req(queued);
+	VERBOSE_ASSERT(g_smlc->admission->queued_total, == 1, "%u");
+
+	clock_step(t16_ms - SMLC_TIMER_WHEEL_TICK_MS);
+	print_conn(queued);
+	clock_step(2 * SMLC_TIMER_WHEEL_TICK_MS);
+	print_conn(queued);
+	VERBOSE_ASSERT(g_smlc->admission->queued_total, == 0, "%u");
+	VERBOSE_ASSERT(ctr(SMLC_CTR_LOCATION_REQUEST_QUEUE_TIMEOUT), == 1, "%"PRIu64);
+	/* The time in the queue is not processing time */
+	VERBOSE_ASSERT(g_smlc->latency.hist[SMLC_LATENCY_QUEUE].max_us, == 2100000, "%"PRIu64);
+	VERBOSE_ASSERT(g_smlc->latency.hist[SMLC_LATENCY_PROCESSING].max_us, == 0, "%"PRIu64);
+
+	rx_bsslap(active, BSSLAP_MSGT_TA_RESPONSE);
+
+	g_smlc->admission->max_active = 0;
+	conn_free(active);
+	conn_free(queued);
+}
+
+static const struct log_info_cat log_categories[] = {
+	[DSMLC] = {
+		.name = "DSMLC",
+		.description = "SMLC",
+		.enabled = 1, .loglevel = LOGL_NOTICE,
+	},
+	[DREF] = {
+		.name = "DREF",
+		.description = "Reference Counting",
+		.enabled = 1, .loglevel = LOGL_NOTICE,
+	},
+	[DLB] = {
+		.name = "DLB",
+		.description = "Lb interface",
+		.enabled = 1, .loglevel = LOGL_NOTICE,
+	},
+	[DLCS] = {
+		.name = "DLCS",
+		.description = "Location Services",
+		.enabled = 1, .loglevel = LOGL_NOTICE,
+	},
+};
+
+static const struct log_info log_info = {
+	.cat = log_categories,
+	.num_cat = ARRAY_SIZE(log_categories),
+};
+
+int main(int argc, char **argv)
+{
+	struct cell_location *cell;
+
+	ctx = talloc_named_const(NULL, 0, "smlc_loc_req_test");
+	osmo_init_logging2(ctx, &log_info);
+	osmo_fsm_set_dealloc_ctx(OTC_SELECT);
+	osmo_clock_override_enable(CLOCK_MONOTONIC, true);
+	/* A latency stamp of zero counts as not taken */
+	osmo_clock_override_add(CLOCK_MONOTONIC, 1, 0);
+
+	g_smlc = smlc_state_alloc(ctx);
+	g_smlc->loc_req_pool = smlc_pool_alloc(g_smlc, "location-request", SMLC_LOC_REQ_POOL_CHUNK_SIZE,
+					       SMLC_POOL_DEFAULT_SIZE, SMLC_POOL_DEFAULT_HIGH_WATER_MARK);
+	g_smlc->timer_wheel = timer_wheel_alloc(g_smlc, SMLC_TIMER_WHEEL_TICK_MS);
+	g_smlc->admission = smlc_admission_alloc(g_smlc, smlc_loc_req_admitted);
+	g_smlc->overload = smlc_overload_alloc(g_smlc);
+	g_smlc->cell_locations = cell_locations_alloc(g_smlc);
+	cell = cell_locations_add(g_smlc->cell_locations, &cell_id);
+	cell->lat = 23000000;
+	cell->lon = 42000000;
+	OSMO_ASSERT(cell_table_rebuild_sync() == 0);
+
+	test_coalesce();
+	test_start_after_failure();
+	test_pipeline_full();
+	test_reset();
+	test_queue_timeout();
+
+	printf("Done\n");
+	return 0;
+}
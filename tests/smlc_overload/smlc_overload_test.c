@@ -0,0 +1,161 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/timer.h>
+#include <osmocom/core/logging.h>
+
+#include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/smlc_overload.h>
+
+struct smlc_state *g_smlc;
+
+static struct smlc_overload *ov;
+
+static void update(uint32_t lag, uint32_t lb_conns, uint32_t loc_reqs, uint32_t subscribers)
+{
+	const uint32_t metrics[_NUM_SMLC_OVERLOAD_METRIC] = {
+		[SMLC_OVERLOAD_METRIC_LAG] = lag,
+		[SMLC_OVERLOAD_METRIC_LB_CONNS] = lb_conns,
+		[SMLC_OVERLOAD_METRIC_LOC_REQS] = loc_reqs,
+		[SMLC_OVERLOAD_METRIC_SUBSCRIBERS] = subscribers,
+	};
+	enum smlc_overload_state old_state = ov->state;
+
+	smlc_overload_update(ov, metrics);
+	printf("lag=%u lb-conns=%u location-requests=%u subscribers=%u: %s", lag, lb_conns, loc_reqs, subscribers,
+	       get_value_string(smlc_overload_state_names, ov->state));
+	if (ov->state != old_state)
+		printf(" (was %s, entered %u times)", get_value_string(smlc_overload_state_names, old_state),
+		       (unsigned int)ov->entered[ov->state]);
+	printf("\n");
+}
+
+static void test_states(void)
+{
+	printf("\n%s()\n", __func__);
+
+	ov->threshold[SMLC_OVERLOAD_SKIP_DEBUG_LOG][SMLC_OVERLOAD_METRIC_LAG] = 50;
+	ov->threshold[SMLC_OVERLOAD_REJECT_NORMAL][SMLC_OVERLOAD_METRIC_LAG] = 200;
+	ov->threshold[SMLC_OVERLOAD_REJECT_NORMAL][SMLC_OVERLOAD_METRIC_LOC_REQS] = 100;
+	ov->threshold[SMLC_OVERLOAD_REFUSE_CONN][SMLC_OVERLOAD_METRIC_LB_CONNS] = 1000;
+	ov->threshold[SMLC_OVERLOAD_REFUSE_CONN][SMLC_OVERLOAD_METRIC_SUBSCRIBERS] = 5000;
+
+	update(0, 0, 0, 0);
+	update(49, 999, 99, 4999);
+	update(50, 0, 0, 0);
+	printf("- the highest state reached wins\n");
+	update(50, 1000, 100, 0);
+	printf("- leave a state only below 80%% of its thresholds\n");
+	update(50, 800, 0, 0);
+	update(50, 799, 0, 0);
+	update(50, 0, 80, 0);
+	update(40, 0, 79, 0);
+	update(39, 0, 79, 0);
+	update(0, 0, 0, 0);
+	printf("- a state may be skipped\n");
+	update(0, 0, 0, 5000);
+	update(0, 0, 0, 0);
+	printf("- metrics without a threshold are ignored\n");
+	update(0, 0, 0, 0);
+	ov->threshold[SMLC_OVERLOAD_REFUSE_CONN][SMLC_OVERLOAD_METRIC_SUBSCRIBERS] = 0;
+	update(0, 0, 0, UINT32_MAX);
+}
+
+static void test_skip_debug_log(void)
+{
+	printf("\n%s()\n", __func__);
+
+	log_set_log_level(osmo_stderr_target, LOGL_DEBUG);
+	printf("stderr log level %u\n", osmo_stderr_target->loglevel);
+	update(50, 0, 0, 0);
+	printf("stderr log level %u\n", osmo_stderr_target->loglevel);
+	update(200, 0, 0, 0);
+	printf("stderr log level %u\n", osmo_stderr_target->loglevel);
+	update(0, 0, 0, 0);
+	printf("stderr log level %u\n", osmo_stderr_target->loglevel);
+
+	printf("- a log level configured meanwhile is kept\n");
+	update(50, 0, 0, 0);
+	log_set_log_level(osmo_stderr_target, LOGL_NOTICE);
+	update(0, 0, 0, 0);
+	printf("stderr log level %u\n", osmo_stderr_target->loglevel);
+}
+
+static void test_lag(void)
+{
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	/* The probe timer is due SMLC_OVERLOAD_PROBE_MS after smlc_overload_alloc() */
+	for (i = 0; i < 12; i++) {
+		osmo_clock_override_add(CLOCK_MONOTONIC, 0, (SMLC_OVERLOAD_PROBE_MS + (i < 5 ? 80 : 0)) * 1000000);
+		osmo_timers_prepare();
+		osmo_timers_update();
+		printf("lag %u us, smoothed %u us, max %u us: %s\n", ov->lag_us, ov->lag_avg_us, ov->lag_max_us,
+		       get_value_string(smlc_overload_state_names, ov->state));
+	}
+}
+
+static const struct log_info_cat log_categories[] = {
+	[DSMLC] = {
+		.name = "DSMLC",
+		.description = "SMLC",
+		.enabled = 1, .loglevel = LOGL_DEBUG,
+	},
+};
+
+static const struct log_info log_info = {
+	.cat = log_categories,
+	.num_cat = ARRAY_SIZE(log_categories),
+};
+
+int main(int argc, char **argv)
+{
+	void *ctx = talloc_named_const(NULL, 0, "smlc_overload_test");
+	struct smlc_state smlc = {};
+
+	osmo_init_logging2(ctx, &log_info);
+	log_set_print_filename2(osmo_stderr_target, LOG_FILENAME_NONE);
+	log_set_print_timestamp(osmo_stderr_target, 0);
+	log_set_use_color(osmo_stderr_target, 0);
+	log_set_print_category(osmo_stderr_target, 1);
+	log_set_print_category_hex(osmo_stderr_target, 0);
+
+	g_smlc = &smlc;
+	osmo_clock_override_enable(CLOCK_MONOTONIC, true);
+	ov = smlc_overload_alloc(ctx);
+
+	test_states();
+	test_skip_debug_log();
+
+	memset(ov->threshold, 0, sizeof(ov->threshold));
+	ov->threshold[SMLC_OVERLOAD_SKIP_DEBUG_LOG][SMLC_OVERLOAD_METRIC_LAG] = 20;
+	test_lag();
+
+	talloc_free(ov);
+	return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include <osmocom/core/application.h>
+#include <osmocom/core/logging.h>
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/fsm.h>
+#include <osmocom/core/select.h>
+
+#include <osmocom/smlc/smlc_pool.h>
+#include <osmocom/smlc/lb_conn.h>
+#include <osmocom/smlc/smlc_loc_req.h>
+
+#define VERBOSE_ASSERT(val, expect_op, fmt) \
+	do { \
+		printf(#val " == " fmt "\n", (val)); \
+		OSMO_ASSERT((val) expect_op); \
+	} while (0);
+
+static void *ctx;
+
+static const struct log_info log_info = {};
+
+/* Count calls to malloc() while enabled, to show how many allocations a location transaction takes */
+static bool count_mallocs;
+static unsigned long mallocs;
+extern void *__libc_malloc(size_t size);
+void *malloc(size_t size)
+{
+	if (count_mallocs)
+		mallocs++;
+	return __libc_malloc(size);
+}
+
+static void test_smlc_pool(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", 256, 2, 3);
+	void *a, *b, *c;
+
+	printf("\n%s()\n", __func__);
+
+	VERBOSE_ASSERT(pool->chunk_count, == 2, "%u");
+
+	a = smlc_pool_get(pool);
+	b = smlc_pool_get(pool);
+	VERBOSE_ASSERT(pool->chunk_count, == 2, "%u");
+	/* Grow up to the high water mark */
+	c = smlc_pool_get(pool);
+	VERBOSE_ASSERT(pool->chunk_count, == 3, "%u");
+	OSMO_ASSERT(a && b && c && a != b && b != c && a != c);
+	/* Then allocate without the pool */
+	OSMO_ASSERT(smlc_pool_get(pool) == NULL);
+	VERBOSE_ASSERT(pool->unpooled, == 1, "%"PRIu64);
+	VERBOSE_ASSERT(pool->pooled, == 3, "%"PRIu64);
+
+	/* The last chunk handed back is reused first */
+	smlc_pool_put(pool, b);
+	OSMO_ASSERT(smlc_pool_get(pool) == b);
+	VERBOSE_ASSERT(smlc_pool_in_use(pool), == 3, "%u");
+	VERBOSE_ASSERT(pool->peak_in_use, == 3, "%u");
+
+	/* Shrinking frees only unused chunks, the others when they are handed back */
+	smlc_pool_put(pool, a);
+	smlc_pool_set_size(pool, 0, 1);
+	VERBOSE_ASSERT(pool->chunk_count, == 2, "%u");
+	smlc_pool_put(pool, b);
+	smlc_pool_put(pool, c);
+	OSMO_ASSERT(smlc_pool_get(pool) != NULL);
+	VERBOSE_ASSERT(pool->chunk_count, == 1, "%u");
+
+	/* A NULL chunk from an allocation without the pool is ignored */
+	smlc_pool_put(pool, NULL);
+	VERBOSE_ASSERT(pool->free_count, == 0, "%u");
+
+	talloc_free(pool);
+}
+
+/* Mimic the allocations of an smlc_loc_req: an FSM instance, a child struct, an id change, and a deferred free of the
+ * FSM instance via OTC_SELECT */
+struct test_obj {
+	struct osmo_fsm_inst *fi;
+	struct smlc_pool *pool;
+	void *pool_chunk;
+	uint8_t payload[512];
+};
+
+static struct osmo_fsm test_fsm = {
+	.name = "test",
+	.states = (const struct osmo_fsm_state[]){
+		{ .name = "ST" },
+	},
+	.num_states = 1,
+	.log_subsys = DLGLOBAL,
+};
+
+static int test_obj_destructor(struct test_obj *obj)
+{
+	smlc_pool_put(obj->pool, obj->pool_chunk);
+	return 0;
+}
+
+static void transaction(struct smlc_pool *pool, unsigned int i)
+{
+	void *pool_chunk = smlc_pool_get(pool);
+	struct osmo_fsm_inst *fi = osmo_fsm_inst_alloc(&test_fsm, pool_chunk ? : ctx, NULL, LOGL_DEBUG, "no-id");
+	struct test_obj *obj = talloc_zero(fi, struct test_obj);
+	OSMO_ASSERT(fi && obj);
+	fi->priv = obj;
+	obj->fi = fi;
+	obj->pool = pool;
+	obj->pool_chunk = pool_chunk;
+	if (pool_chunk)
+		talloc_set_destructor(obj, test_obj_destructor);
+	osmo_fsm_inst_update_id_f(fi, "IMSI-90170%010u", i);
+	osmo_fsm_inst_term(fi, OSMO_FSM_TERM_REGULAR, NULL);
+	osmo_select_main_ctx(1);
+}
+
+#define CHUNK_SIZE (sizeof(struct osmo_fsm_inst) + sizeof(struct test_obj) + 6 * SMLC_POOL_TALLOC_OVERHEAD + 256)
+
+static unsigned long count_mallocs_per_transaction(struct smlc_pool *pool, unsigned int n)
+{
+	unsigned int i;
+	/* Warm up, e.g. the OTC_SELECT context */
+	transaction(pool, 0);
+	mallocs = 0;
+	count_mallocs = true;
+	for (i = 0; i < n; i++)
+		transaction(pool, i);
+	count_mallocs = false;
+	return mallocs / n;
+}
+
+static void test_smlc_pool_fsm(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", CHUNK_SIZE, 4, 16);
+	unsigned long with_pool;
+	unsigned long without_pool;
+
+	printf("\n%s()\n", __func__);
+
+	with_pool = count_mallocs_per_transaction(pool, 1000);
+	/* Each FSM instance was freed from OTC_SELECT, so the same chunk was used over and over */
+	VERBOSE_ASSERT(pool->pooled, == 1001, "%"PRIu64);
+	VERBOSE_ASSERT(pool->unpooled, == 0, "%"PRIu64);
+	VERBOSE_ASSERT(pool->peak_in_use, == 1, "%u");
+	VERBOSE_ASSERT(smlc_pool_in_use(pool), == 0, "%u");
+
+	smlc_pool_set_size(pool, 0, 0);
+	without_pool = count_mallocs_per_transaction(pool, 1000);
+	VERBOSE_ASSERT(pool->unpooled, == 1001, "%"PRIu64);
+
+	OSMO_ASSERT(with_pool < without_pool);
+	printf("fewer mallocs with the pool\n");
+
+	talloc_free(pool);
+}
+
+static void bench_smlc_pool(void)
+{
+	struct smlc_pool *pool = smlc_pool_alloc(ctx, "test", CHUNK_SIZE, 4, 16);
+	printf("malloc() calls per transaction with the pool: %lu\n", count_mallocs_per_transaction(pool, 100000));
+	smlc_pool_set_size(pool, 0, 0);
+	printf("malloc() calls per transaction without the pool: %lu\n", count_mallocs_per_transaction(pool, 100000));
+	talloc_free(pool);
+
+	/* Memory held by each location request while it waits for the TA */
+	printf("bytes per in-flight location request: %zu (lb-conn chunk %zu, location-request chunk %zu)\n",
+	       LB_CONN_POOL_CHUNK_SIZE + SMLC_LOC_REQ_POOL_CHUNK_SIZE, LB_CONN_POOL_CHUNK_SIZE,
+	       SMLC_LOC_REQ_POOL_CHUNK_SIZE);
+	printf("bytes per queued location request: %zu\n", sizeof(struct smlc_loc_req_queued));
+	printf("sizeof(struct smlc_loc_req) = %zu, of which params %zu; decoded Perform Location Request %zu\n",
+	       sizeof(struct smlc_loc_req), sizeof(struct smlc_loc_req_params),
+	       sizeof(struct bssmap_le_perform_loc_req));
+}
+
+int main(int argc, char **argv)
+{
+	ctx = talloc_named_const(NULL, 0, "smlc_pool_test");
+	osmo_init_logging2(ctx, &log_info);
+	OSMO_ASSERT(osmo_fsm_register(&test_fsm) == 0);
+	osmo_fsm_set_dealloc_ctx(OTC_SELECT);
+
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		bench_smlc_pool();
+		return 0;
+	}
+
+	test_smlc_pool();
+	test_smlc_pool_fsm();
+
+	talloc_free(ctx);
+	printf("Done\n");
+	return 0;
+}
@@ -0,0 +1,309 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/select.h>
+#include <osmocom/core/logging.h>
+#include <osmocom/core/application.h>
+
+#include <osmocom/smlc/debug.h>
+#include <osmocom/smlc/smlc_data.h>
+#include <osmocom/smlc/smlc_pos.h>
+#include <osmocom/smlc/smlc_ring.h>
+
+#define VERBOSE_ASSERT(val, expect_op, fmt) \
+	do { \
+		printf(#val " == " fmt "\n", (val)); \
+		OSMO_ASSERT((val) expect_op); \
+	} while (0);
+
+struct smlc_state *g_smlc;
+
+static void *ctx;
+
+static void test_ring(void)
+{
+	struct smlc_ring *ring = smlc_ring_alloc(ctx, 3);
+	int items[8];
+	int i;
+
+	printf("\n%s()\n", __func__);
+	VERBOSE_ASSERT(ring->size, == 4, "%u");
+
+	for (i = 0; i < 4; i++)
+		OSMO_ASSERT(smlc_ring_push(ring, &items[i]));
+	printf("push to a full ring: %s\n", smlc_ring_push(ring, &items[4]) ? "ok" : "refused");
+	VERBOSE_ASSERT(smlc_ring_count(ring), == 4, "%u");
+
+	for (i = 0; i < 4; i++)
+		OSMO_ASSERT(smlc_ring_pop(ring) == &items[i]);
+	printf("pop from an empty ring: %s\n", smlc_ring_pop(ring) ? "item" : "NULL");
+
+	/* Go around a few times, with the counters past the slot index */
+	for (i = 0; i < 10; i++) {
+		OSMO_ASSERT(smlc_ring_push(ring, &items[i % 8]));
+		OSMO_ASSERT(smlc_ring_push(ring, &items[(i + 1) % 8]));
+		OSMO_ASSERT(smlc_ring_pop(ring) == &items[i % 8]);
+		OSMO_ASSERT(smlc_ring_pop(ring) == &items[(i + 1) % 8]);
+	}
+	VERBOSE_ASSERT(smlc_ring_count(ring), == 0, "%u");
+
+	talloc_free(ring);
+}
+
+static void print_job(const struct smlc_pos_job *job)
+{
+	if (job->rc) {
+		printf(" ta=%u: rc=%d\n", job->ta, job->rc);
+		return;
+	}
+	/* The uncertainty is rounded to a GAD code by libosmogsm, see cell_locations_test for it */
+	printf(" ta=%u: lat=%d lon=%d, %u bytes\n", job->ta, job->location.ell_point_unc_circle.lat,
+	       job->location.ell_point_unc_circle.lon, job->location_estimate_len);
+}
+
+/* The same job gives the same result inline and on a thread */
+static struct smlc_pos_job inline_results[4];
+static unsigned int done_count;
+
+static void test_done_cb(struct smlc_pos_job *job)
+{
+	unsigned int i = (uintptr_t)job->priv;
+
+	printf("done: job %u\n", i);
+	print_job(job);
+	if (i < ARRAY_SIZE(inline_results) && !job->rc)
+		printf(" same as inline: %s\n",
+		       job->location_estimate_len == inline_results[i].location_estimate_len
+		       && !memcmp(&job->location_estimate, &inline_results[i].location_estimate,
+				  job->location_estimate_len) ? "yes" : "no");
+	done_count++;
+}
+
+static void test_compute(void)
+{
+	unsigned int i;
+
+	printf("\n%s()\n", __func__);
+	for (i = 0; i < ARRAY_SIZE(inline_results); i++) {
+		struct smlc_pos_job *job = &inline_results[i];
+		*job = (struct smlc_pos_job){
+			.lat = 52500000,
+			.lon = 13400000,
+			.ta = i * 20,
+		};
+		job->rc = smlc_pos_compute(job);
+		print_job(job);
+	}
+}
+
+/* Jobs complete in order on the main thread; a job that waited past its deadline is not computed */
+static void test_workers(void)
+{
+	struct smlc_workers *workers = smlc_workers_alloc(ctx, "positioning", 2, 4);
+	unsigned int i;
+
+	printf("\n%s()\n", __func__);
+	OSMO_ASSERT(workers);
+	done_count = 0;
+
+	for (i = 0; i < ARRAY_SIZE(inline_results); i++) {
+		struct smlc_pos_job *job = smlc_pos_job_alloc(ctx, test_done_cb, (void *)(uintptr_t)i);
+		job->lat = inline_results[i].lat;
+		job->lon = inline_results[i].lon;
+		job->ta = inline_results[i].ta;
+		/* All on one thread, to see the order */
+		OSMO_ASSERT(!smlc_pos_submit(workers, 0, job, 10000));
+	}
+	{
+		struct smlc_pos_job *job = smlc_pos_job_alloc(ctx, test_done_cb, (void *)(uintptr_t)99);
+		job->ta = 1;
+		/* Already due when a thread gets to it */
+		OSMO_ASSERT(!smlc_pos_submit(workers, 1, job, 0));
+	}
+
+	/* Poll only after everything is submitted, so that the output does not depend on thread timing */
+	smlc_workers_free(workers);
+	VERBOSE_ASSERT(done_count, == ARRAY_SIZE(inline_results) + 1, "%u");
+}
+
+static atomic_bool hold_workers;
+static unsigned int held_done_count;
+
+static void held_run(struct smlc_work *work)
+{
+	while (atomic_load(&hold_workers))
+		sched_yield();
+}
+
+static void held_done(struct smlc_work *work)
+{
+	held_done_count++;
+}
+
+/* A thread that is a full queue behind makes smlc_workers_submit() refuse the job right away, instead of waiting */
+static void test_queue_full(void)
+{
+	struct smlc_workers *workers = smlc_workers_alloc(ctx, "positioning", 1, 4);
+	struct smlc_work work[5];
+	unsigned int i;
+	int rc;
+
+	printf("\n%s()\n", __func__);
+	OSMO_ASSERT(workers);
+	atomic_store(&hold_workers, true);
+
+	for (i = 0; i < ARRAY_SIZE(work); i++)
+		work[i] = (struct smlc_work){ .run = held_run, .done = held_done };
+	for (i = 0; i < 4; i++)
+		OSMO_ASSERT(!smlc_workers_submit(workers, 0, &work[i]));
+	rc = smlc_workers_submit(workers, 0, &work[4]);
+	VERBOSE_ASSERT(rc, == -EAGAIN, "%d");
+	VERBOSE_ASSERT(workers->queue_full, == 1, "%"PRIu64);
+	VERBOSE_ASSERT(workers->workers[0].in_flight, == 4, "%u");
+
+	atomic_store(&hold_workers, false);
+	smlc_workers_free(workers);
+	VERBOSE_ASSERT(held_done_count, == 4, "%u");
+}
+
+/* How many location estimates per second, and how much of the main thread's time they take, computing inline vs on
+ * 1 to 8 positioning threads. Each computation is made artificially heavy, as for positioning methods beyond TA
+ * circles. While computing inline, the main thread does nothing else; with threads, it only hands jobs out and
+ * collects the results. */
+#define BENCH_JOBS 20000
+#define BENCH_SPIN 20000
+
+static unsigned int bench_done;
+
+static void bench_heavy(void)
+{
+	volatile unsigned int x = 0;
+	unsigned int i;
+	for (i = 0; i < BENCH_SPIN; i++)
+		x += i * i;
+}
+
+static void bench_run(struct smlc_work *work)
+{
+	bench_heavy();
+	smlc_pos_run(work);
+}
+
+static void bench_done_cb(struct smlc_pos_job *job)
+{
+	OSMO_ASSERT(!job->rc);
+	bench_done++;
+}
+
+static double seconds(clockid_t clk)
+{
+	struct timespec ts;
+	clock_gettime(clk, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_pos(void)
+{
+	static const unsigned int threads[] = { 0, 1, 2, 4, 8 };
+	unsigned int i, t;
+
+	for (t = 0; t < ARRAY_SIZE(threads); t++) {
+		struct smlc_workers *workers = NULL;
+		double start, start_cpu;
+
+		if (threads[t])
+			workers = smlc_workers_alloc(ctx, "positioning", threads[t], SMLC_POS_QUEUE_LEN);
+		bench_done = 0;
+		start = seconds(CLOCK_MONOTONIC);
+		start_cpu = seconds(CLOCK_THREAD_CPUTIME_ID);
+		for (i = 0; i < BENCH_JOBS; i++) {
+			struct smlc_pos_job job = { .ta = i % 64 };
+
+			if (workers) {
+				struct smlc_pos_job *pos_job = smlc_pos_job_alloc(ctx, bench_done_cb, NULL);
+				pos_job->ta = job.ta;
+				pos_job->work.run = bench_run;
+				/* Collect results between jobs, as the main loop would between messages */
+				smlc_workers_poll(workers);
+				if (!smlc_pos_submit(workers, i, pos_job, 60000))
+					continue;
+				/* A full queue: compute inline, as smlc_loc_req does */
+				talloc_free(pos_job);
+			}
+			bench_heavy();
+			job.rc = smlc_pos_compute(&job);
+			bench_done_cb(&job);
+		}
+		while (bench_done < BENCH_JOBS)
+			osmo_select_main(0);
+		printf("%s%u threads: %.0f estimates/s, main thread busy %.0f us per estimate, %" PRIu64 " inline for a"
+		       " full queue\n",
+		       threads[t] ? "" : "inline, ", threads[t], BENCH_JOBS / (seconds(CLOCK_MONOTONIC) - start),
+		       (seconds(CLOCK_THREAD_CPUTIME_ID) - start_cpu) * 1e6 / BENCH_JOBS,
+		       workers ? workers->queue_full : 0);
+		smlc_workers_free(workers);
+	}
+}
+
+static const struct log_info_cat log_categories[] = {
+	[DSMLC] = {
+		.name = "DSMLC",
+		.description = "SMLC",
+		.enabled = 1, .loglevel = LOGL_NOTICE,
+	},
+};
+
+static const struct log_info log_info = {
+	.cat = log_categories,
+	.num_cat = ARRAY_SIZE(log_categories),
+};
+
+int main(int argc, char **argv)
+{
+	ctx = talloc_named_const(NULL, 0, "smlc_pos_test");
+	osmo_init_logging2(ctx, &log_info);
+	log_set_print_filename2(osmo_stderr_target, LOG_FILENAME_NONE);
+	log_set_print_timestamp(osmo_stderr_target, 0);
+	log_set_use_color(osmo_stderr_target, 0);
+
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		bench_pos();
+		return 0;
+	}
+
+	test_ring();
+	test_compute();
+	test_workers();
+	test_queue_full();
+
+	printf("\ndone\n");
+	return 0;
+}
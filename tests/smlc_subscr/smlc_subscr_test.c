@@ -23,14 +23,18 @@
 #include <osmocom/smlc/debug.h>
 #include <osmocom/smlc/smlc_data.h>
 #include <osmocom/smlc/smlc_subscr.h>
+#include <osmocom/smlc/smlc_loc_req.h>
 
 #include <osmocom/core/application.h>
 #include <osmocom/core/utils.h>
+#include <osmocom/core/timer.h>
+#include <osmocom/gsm/bssmap_le.h>
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <time.h>
 
 struct smlc_state *g_smlc;
 
@@ -122,6 +126,244 @@ static void test_smlc_subscr(void)
 	OSMO_ASSERT(llist_empty(&g_smlc->subscribers));
 }
 
+static uint32_t lcg_state;
+
+static uint32_t lcg_rand(void)
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static struct osmo_mobile_identity rand_imsi(void)
+{
+	struct osmo_mobile_identity imsi = { .type = GSM_MI_TYPE_IMSI };
+	/* 001-01 test PLMN and random MSIN, with a few shorter IMSIs among them */
+	snprintf(imsi.imsi, sizeof(imsi.imsi), "00101%05u%05u", lcg_rand() % 100000, lcg_rand() % 100000);
+	if (!(lcg_rand() % 8))
+		imsi.imsi[6 + lcg_rand() % 9] = '\0';
+	return imsi;
+}
+
+/* The lookup as it was before subscribers were indexed by IMSI */
+static struct smlc_subscr *list_walk_find(const struct osmo_mobile_identity *imsi)
+{
+	struct smlc_subscr *smlc_subscr;
+	llist_for_each_entry(smlc_subscr, &g_smlc->subscribers, entry) {
+		if (!osmo_mobile_identity_cmp(&smlc_subscr->imsi, imsi))
+			return smlc_subscr;
+	}
+	return NULL;
+}
+
+static void test_smlc_subscr_index(void)
+{
+	const unsigned int n = 5000;
+	struct smlc_subscr **subscrs = talloc_zero_array(g_smlc, struct smlc_subscr *, n);
+	const struct osmo_mobile_identity zeros1 = { .type = GSM_MI_TYPE_IMSI, .imsi = "0012345" };
+	const struct osmo_mobile_identity zeros2 = { .type = GSM_MI_TYPE_IMSI, .imsi = "012345" };
+	struct smlc_subscr *s1, *s2;
+	unsigned int i, hits = 0;
+
+	printf("\n%s()\n", __func__);
+
+	/* IMSIs that differ only in leading zeros are different subscribers */
+	s1 = smlc_subscr_find_or_create(&zeros1, USE_FOO);
+	s2 = smlc_subscr_find_or_create(&zeros2, USE_FOO);
+	OSMO_ASSERT(s1 != s2);
+	assert_smlc_subscr(s1, &zeros1);
+	assert_smlc_subscr(s2, &zeros2);
+	smlc_subscr_put(s1, USE_FOO);
+	smlc_subscr_put(s2, USE_FOO);
+
+	lcg_state = 42;
+	for (i = 0; i < n; i++) {
+		struct osmo_mobile_identity imsi = rand_imsi();
+		subscrs[i] = smlc_subscr_find_or_create(&imsi, USE_FOO);
+	}
+	printf("- %u subscribers\n", llist_count(&g_smlc->subscribers));
+
+	for (i = 0; i < 2 * n; i++) {
+		struct osmo_mobile_identity imsi = (i & 1) ? subscrs[lcg_rand() % n]->imsi : rand_imsi();
+		struct smlc_subscr *found = smlc_subscr_find(&imsi, USE_BAR);
+		OSMO_ASSERT(found == list_walk_find(&imsi));
+		if (found) {
+			hits++;
+			smlc_subscr_put(found, USE_BAR);
+		}
+	}
+	OSMO_ASSERT(hits >= n);
+	printf("- lookups match the list walk\n");
+
+	/* Freeing removes subscribers from the index */
+	for (i = 0; i < n; i++) {
+		struct osmo_mobile_identity imsi = subscrs[i]->imsi;
+		struct smlc_subscr *found;
+		smlc_subscr_put(subscrs[i], USE_FOO);
+		found = smlc_subscr_find(&imsi, USE_BAR);
+		OSMO_ASSERT(found == list_walk_find(&imsi));
+		if (found)
+			smlc_subscr_put(found, USE_BAR);
+	}
+	OSMO_ASSERT(llist_empty(&g_smlc->subscribers));
+	printf("- all freed\n");
+	talloc_free(subscrs);
+}
+
+#define CTR(X) g_smlc->ctrs->ctr[SMLC_CTR_LAST_LOCATION_##X].current
+
+static void test_last_location(void)
+{
+	const struct osmo_mobile_identity imsi1 = { .type = GSM_MI_TYPE_IMSI, .imsi = "1234567890", };
+	const struct osmo_mobile_identity imsi2 = { .type = GSM_MI_TYPE_IMSI, .imsi = "9876543210", };
+	const struct osmo_mobile_identity imsi3 = { .type = GSM_MI_TYPE_IMSI, .imsi = "423423", };
+	const struct gsm0808_cell_id cell = {
+		.id_discr = CELL_IDENT_LAC_AND_CI,
+		.id.lac_and_ci = { .lac = 23, .ci = 42 },
+	};
+	const struct osmo_gad location = {
+		.type = GAD_TYPE_ELL_POINT_UNC_CIRCLE,
+		.ell_point_unc_circle = { .lat = 23230000, .lon = 42420000, .unc = 1100 },
+	};
+	const union gad_raw location_estimate = {};
+	struct smlc_loc_req_params req = {
+		.cell_id = cell,
+	};
+	const struct smlc_subscr_last_location *last;
+	struct smlc_subscr *s1, *s2, *s3;
+
+	printf("\n%s()\n", __func__);
+
+	osmo_clock_override_enable(CLOCK_MONOTONIC, true);
+	g_smlc->last_location_max_age = 10;
+	g_smlc->last_location_capacity = 2;
+
+	s1 = smlc_subscr_find_or_create(&imsi1, USE_FOO);
+	last = smlc_subscr_last_location_get(s1, &req);
+	OSMO_ASSERT(!last);
+	VERBOSE_ASSERT(CTR(MISS), == 1, "%"PRIu64);
+
+	smlc_subscr_last_location_set(s1, &cell, 3, &location, &location_estimate);
+	VERBOSE_ASSERT(g_smlc->last_locations_count, == 1, "%u");
+	last = smlc_subscr_last_location_get(s1, &req);
+	OSMO_ASSERT(last && last->ta == 3);
+	VERBOSE_ASSERT(CTR(HIT), == 1, "%"PRIu64);
+
+	printf("- other cell\n");
+	req.cell_id.id.lac_and_ci.ci = 43;
+	OSMO_ASSERT(!smlc_subscr_last_location_get(s1, &req));
+	req.cell_id = cell;
+
+	printf("- delay tolerant\n");
+	req.lcs_qos_present = true;
+	req.lcs_qos.rt = 2;
+	OSMO_ASSERT(!smlc_subscr_last_location_get(s1, &req));
+
+	printf("- low delay\n");
+	req.lcs_qos.rt = 1;
+	OSMO_ASSERT(smlc_subscr_last_location_get(s1, &req));
+
+	printf("- more accurate than the last location\n");
+	req.lcs_qos.ha_ind = 1;
+	req.lcs_qos.ha_val = 0;
+	OSMO_ASSERT(!smlc_subscr_last_location_get(s1, &req));
+
+	printf("- less accurate than the last location\n");
+	req.lcs_qos.ha_val = 10;
+	OSMO_ASSERT(smlc_subscr_last_location_get(s1, &req));
+	VERBOSE_ASSERT(CTR(HIT), == 3, "%"PRIu64);
+	VERBOSE_ASSERT(CTR(QOS_MISMATCH), == 3, "%"PRIu64);
+
+	printf("- too old\n");
+	osmo_clock_override_add(CLOCK_MONOTONIC, 9, 0);
+	OSMO_ASSERT(smlc_subscr_last_location_get(s1, &req));
+	osmo_clock_override_add(CLOCK_MONOTONIC, 1, 0);
+	OSMO_ASSERT(!smlc_subscr_last_location_get(s1, &req));
+	VERBOSE_ASSERT(CTR(EXPIRED), == 1, "%"PRIu64);
+	VERBOSE_ASSERT(CTR(MISS), == 2, "%"PRIu64);
+	VERBOSE_ASSERT(g_smlc->last_locations_count, == 0, "%u");
+
+	printf("- capacity\n");
+	s2 = smlc_subscr_find_or_create(&imsi2, USE_FOO);
+	s3 = smlc_subscr_find_or_create(&imsi3, USE_FOO);
+	smlc_subscr_last_location_set(s1, &cell, 1, &location, &location_estimate);
+	osmo_clock_override_add(CLOCK_MONOTONIC, 1, 0);
+	smlc_subscr_last_location_set(s2, &cell, 2, &location, &location_estimate);
+	osmo_clock_override_add(CLOCK_MONOTONIC, 1, 0);
+	smlc_subscr_last_location_set(s3, &cell, 3, &location, &location_estimate);
+	VERBOSE_ASSERT(g_smlc->last_locations_count, == 2, "%u");
+	OSMO_ASSERT(!s1->last_location.valid);
+	OSMO_ASSERT(s2->last_location.valid);
+	OSMO_ASSERT(s3->last_location.valid);
+
+	/* An updated location moves to the end of the list */
+	smlc_subscr_last_location_set(s2, &cell, 4, &location, &location_estimate);
+	smlc_subscr_last_location_set(s1, &cell, 5, &location, &location_estimate);
+	OSMO_ASSERT(s1->last_location.valid);
+	OSMO_ASSERT(s2->last_location.valid);
+	OSMO_ASSERT(!s3->last_location.valid);
+
+	printf("- a last known location keeps the subscriber\n");
+	smlc_subscr_put(s1, USE_FOO);
+	smlc_subscr_put(s2, USE_FOO);
+	smlc_subscr_put(s3, USE_FOO);
+	VERBOSE_ASSERT(llist_count(&g_smlc->subscribers), == 2, "%u");
+
+	printf("- disable\n");
+	g_smlc->last_location_max_age = 0;
+	smlc_subscr_last_location_expire();
+	VERBOSE_ASSERT(g_smlc->last_locations_count, == 0, "%u");
+	VERBOSE_ASSERT(llist_count(&g_smlc->subscribers), == 0, "%u");
+
+	osmo_clock_override_enable(CLOCK_MONOTONIC, false);
+}
+
+static double now_s(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Print the time per smlc_subscr_find() for growing numbers of subscribers. Timing varies per host, hence only run on
+ * request. */
+static void bench_smlc_subscr_find(void)
+{
+	static const unsigned int sizes[] = { 100, 1000, 10000, 50000, 100000 };
+	const unsigned int lookups = 1000000;
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	log_set_category_filter(osmo_stderr_target, DREF, 1, LOGL_ERROR);
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		unsigned int n = sizes[i];
+		struct smlc_subscr **subscrs = talloc_zero_array(g_smlc, struct smlc_subscr *, n);
+		unsigned int j;
+		double t;
+
+		lcg_state = 23;
+		for (j = 0; j < n; j++) {
+			struct osmo_mobile_identity imsi = rand_imsi();
+			subscrs[j] = smlc_subscr_find_or_create(&imsi, USE_FOO);
+		}
+
+		t = now_s();
+		for (j = 0; j < lookups; j++) {
+			struct smlc_subscr *found = smlc_subscr_find(&subscrs[lcg_rand() % n]->imsi, USE_BAR);
+			OSMO_ASSERT(found);
+			smlc_subscr_put(found, USE_BAR);
+		}
+		t = now_s() - t;
+
+		printf("- %6u subscribers: %.1f ns per lookup\n", n, t * 1e9 / lookups);
+
+		for (j = 0; j < n; j++)
+			smlc_subscr_put(subscrs[j], USE_FOO);
+		talloc_free(subscrs);
+	}
+}
+
 static const struct log_info_cat log_categories[] = {
 	[DREF] = {
 		.name = "DREF",
@@ -135,7 +377,7 @@ static const struct log_info log_info = {
 	.num_cat = ARRAY_SIZE(log_categories),
 };
 
-int main()
+int main(int argc, char **argv)
 {
 	void *ctx = talloc_named_const(NULL, 0, "smlc_subscr_test");
 
@@ -152,6 +394,14 @@ int main()
 
 	test_smlc_subscr();
 
+	/* Only log errors from here on, the .err file would grow huge otherwise */
+	log_set_category_filter(osmo_stderr_target, DREF, 1, LOGL_NOTICE);
+	test_smlc_subscr_index();
+	test_last_location();
+
+	if (argc > 1 && !strcmp(argv[1], "bench"))
+		bench_smlc_subscr_find();
+
 	printf("Done\n");
 	return 0;
 }
@@ -0,0 +1,119 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+
+#include <osmocom/core/utils.h>
+
+#include <osmocom/smlc/ta_rtt.h>
+
+#define INITIAL_MS 5000
+#define MIN_MS 200
+#define MAX_MS 10000
+
+static void print_rtt(const char *label, const struct ta_rtt *rtt)
+{
+	printf("%-24s samples=%u srtt=%u us rttvar=%u us backoff=%u -> timeout %lu ms\n",
+	       label, rtt->samples, rtt->srtt_us, rtt->rttvar_us, rtt->backoff,
+	       ta_rtt_timeout_ms(rtt, INITIAL_MS, MIN_MS, MAX_MS));
+}
+
+static void test_no_samples(void)
+{
+	struct ta_rtt rtt = {};
+
+	printf("\n%s()\n", __func__);
+	print_rtt("initial", &rtt);
+	printf("initial below min: %lu ms\n", ta_rtt_timeout_ms(&rtt, 100, MIN_MS, MAX_MS));
+	printf("initial above max: %lu ms\n", ta_rtt_timeout_ms(&rtt, 20000, MIN_MS, MAX_MS));
+	ta_rtt_timed_out(&rtt);
+	print_rtt("after timeout", &rtt);
+}
+
+static void test_fast_peer(void)
+{
+	struct ta_rtt rtt = {};
+	int i;
+
+	printf("\n%s()\n", __func__);
+	/* A BSC that steadily answers in 40 ms converges to the lower bound */
+	ta_rtt_sample(&rtt, 40000);
+	print_rtt("first sample 40 ms", &rtt);
+	for (i = 0; i < 20; i++)
+		ta_rtt_sample(&rtt, 40000);
+	print_rtt("21 samples of 40 ms", &rtt);
+}
+
+static void test_slow_jittery_peer(void)
+{
+	struct ta_rtt rtt = {};
+	char label[32];
+	int i;
+
+	printf("\n%s()\n", __func__);
+	/* A congested BSC answering between 1.5 s and 2.5 s keeps a timeout well above its average round trip */
+	for (i = 0; i < 8; i++) {
+		ta_rtt_sample(&rtt, (i & 1) ? 2500000 : 1500000);
+		snprintf(label, sizeof(label), "sample %d: %u ms", i, (i & 1) ? 2500 : 1500);
+		print_rtt(label, &rtt);
+	}
+}
+
+static void test_backoff(void)
+{
+	struct ta_rtt rtt = {};
+	char label[32];
+	int i;
+
+	printf("\n%s()\n", __func__);
+	ta_rtt_sample(&rtt, 100000);
+	print_rtt("sample 100 ms", &rtt);
+	/* Each timeout doubles the timeout, up to the upper bound */
+	for (i = 0; i < TA_RTT_MAX_BACKOFF + 2; i++) {
+		ta_rtt_timed_out(&rtt);
+		snprintf(label, sizeof(label), "timeout %d", i + 1);
+		print_rtt(label, &rtt);
+	}
+	/* The next measured round trip ends the backoff */
+	ta_rtt_sample(&rtt, 100000);
+	print_rtt("sample 100 ms", &rtt);
+}
+
+static void test_overflow(void)
+{
+	struct ta_rtt rtt = {};
+
+	printf("\n%s()\n", __func__);
+	ta_rtt_sample(&rtt, UINT64_MAX);
+	print_rtt("huge sample", &rtt);
+	ta_rtt_sample(&rtt, UINT64_MAX);
+	print_rtt("huge sample", &rtt);
+}
+
+int main(int argc, char **argv)
+{
+	test_no_samples();
+	test_fast_peer();
+	test_slow_jittery_peer();
+	test_backoff();
+	test_overflow();
+	printf("\nDone\n");
+	return 0;
+}
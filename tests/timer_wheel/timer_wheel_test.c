@@ -0,0 +1,206 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/timer.h>
+
+#include <osmocom/smlc/timer_wheel.h>
+
+static void *ctx;
+
+/* Deterministic pseudo random numbers, so that the output is stable */
+static uint32_t rnd_state = 1;
+static uint32_t rnd(void)
+{
+	rnd_state = rnd_state * 1103515245 + 12345;
+	return (rnd_state >> 8) & 0xffffff;
+}
+
+static uint64_t now_ms(void)
+{
+	struct timespec now;
+	osmo_clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static uint64_t start_ms;
+/* The longest time that any timer fired after its deadline */
+static unsigned int max_late;
+
+static void clock_step(unsigned int ms)
+{
+	osmo_clock_override_add(CLOCK_MONOTONIC, ms / 1000, (ms % 1000) * 1000000);
+	osmo_timers_prepare();
+	osmo_timers_update();
+}
+
+struct test_timer {
+	struct timer_wheel_timer t;
+	const char *name;
+	uint64_t deadline;
+	uint64_t fired;
+	unsigned int fired_count;
+	/* Schedule again from the callback with this timeout */
+	unsigned long reschedule_ms;
+};
+
+static void test_timer_cb(void *data)
+{
+	struct test_timer *tt = data;
+	tt->fired = now_ms();
+	tt->fired_count++;
+	OSMO_ASSERT(tt->fired >= tt->deadline);
+	max_late = OSMO_MAX(max_late, tt->fired - tt->deadline);
+	if (tt->name)
+		printf("%5" PRIu64 " ms: %s fired\n", tt->fired - start_ms, tt->name);
+	if (tt->reschedule_ms) {
+		tt->deadline = tt->fired + tt->reschedule_ms;
+		timer_wheel_schedule(tt->t.wheel, &tt->t, tt->reschedule_ms);
+		tt->reschedule_ms = 0;
+	}
+}
+
+static void test_timer_schedule(struct timer_wheel *w, struct test_timer *tt, unsigned long timeout_ms)
+{
+	tt->deadline = now_ms() + timeout_ms;
+	timer_wheel_schedule(w, &tt->t, timeout_ms);
+}
+
+static void test_timer_wheel(void)
+{
+	struct timer_wheel *w;
+	struct test_timer tt[] = {
+		{ .name = "A (250 ms)" },
+		{ .name = "B (100 ms)" },
+		{ .name = "C (7 s, level 1)" },
+		{ .name = "D (300 ms, removed at 200 ms)" },
+		{ .name = "E (0 ms)" },
+		{ .name = "F (400 ms, then 1 s)", .reschedule_ms = 1000 },
+	};
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	w = timer_wheel_alloc(ctx, 100);
+	start_ms = now_ms();
+	max_late = 0;
+	/* Not aligned to a tick */
+	clock_step(30);
+
+	for (i = 0; i < ARRAY_SIZE(tt); i++)
+		timer_wheel_timer_setup(&tt[i].t, test_timer_cb, &tt[i]);
+	test_timer_schedule(w, &tt[0], 250);
+	test_timer_schedule(w, &tt[1], 100);
+	test_timer_schedule(w, &tt[2], 7000);
+	test_timer_schedule(w, &tt[3], 300);
+	test_timer_schedule(w, &tt[4], 0);
+	test_timer_schedule(w, &tt[5], 400);
+	printf("%u timers pending\n", w->count);
+
+	while (w->count) {
+		clock_step(10);
+		if (now_ms() - start_ms == 200) {
+			timer_wheel_del(&tt[3].t);
+			printf("%5" PRIu64 " ms: removed D, %u timers pending\n", now_ms() - start_ms, w->count);
+		}
+	}
+
+	OSMO_ASSERT(max_late < w->tick_ms);
+	OSMO_ASSERT(!tt[3].fired_count);
+	OSMO_ASSERT(!osmo_timer_pending(&w->timer));
+	talloc_free(w);
+}
+
+#define SOAK_TIMERS 100000
+#define SOAK_TICK_MS 100
+#define SOAK_STEP_MS 20
+
+/* Many concurrent timeouts across all levels, as with a mass location event; a share of them is removed before
+ * expiry, as when the BSC responds in time. No timer may fire early, and all within one tick and one clock step after
+ * their deadline. */
+static void test_soak(void)
+{
+	struct timer_wheel *w;
+	struct test_timer *tt = talloc_zero_array(ctx, struct test_timer, SOAK_TIMERS);
+	unsigned int removed = 0;
+	unsigned int fired = 0;
+	unsigned int max_pending = 0;
+	unsigned int steps = 0;
+	int i;
+
+	printf("\n%s()\n", __func__);
+
+	w = timer_wheel_alloc(ctx, SOAK_TICK_MS);
+	start_ms = now_ms();
+	max_late = 0;
+
+	/* Start the timers spread over the first 10 seconds, with timeouts of up to 15 minutes */
+	for (i = 0; i < SOAK_TIMERS; i++) {
+		timer_wheel_timer_setup(&tt[i].t, test_timer_cb, &tt[i]);
+		if (!(rnd() % 10))
+			tt[i].reschedule_ms = rnd() % 10000;
+		if ((i % 200) == 0)
+			clock_step(SOAK_STEP_MS);
+		test_timer_schedule(w, &tt[i], rnd() % (15 * 60 * 1000));
+	}
+	max_pending = w->count;
+
+	while (w->count) {
+		clock_step(SOAK_STEP_MS);
+		steps++;
+		/* Remove a random timer on every other step */
+		if (steps & 1) {
+			struct test_timer *t = &tt[rnd() % SOAK_TIMERS];
+			if (timer_wheel_pending(&t->t)) {
+				timer_wheel_del(&t->t);
+				removed++;
+			}
+		}
+	}
+
+	for (i = 0; i < SOAK_TIMERS; i++)
+		fired += tt[i].fired_count;
+	OSMO_ASSERT(max_late < SOAK_TICK_MS + SOAK_STEP_MS);
+
+	printf("%u timers, %u pending after starting all, %u removed, %u expired timers and reschedules\n",
+	       SOAK_TIMERS, max_pending, removed, fired);
+	printf("all expired within %u ms after their deadline, in %u steps of %u ms\n",
+	       SOAK_TICK_MS + SOAK_STEP_MS, steps, SOAK_STEP_MS);
+	talloc_free(w);
+	talloc_free(tt);
+}
+
+int main(int argc, char **argv)
+{
+	ctx = talloc_named_const(NULL, 0, "timer_wheel_test");
+
+	osmo_clock_override_enable(CLOCK_MONOTONIC, true);
+
+	test_timer_wheel();
+	test_soak();
+
+	printf("\nDone\n");
+	return 0;
+}
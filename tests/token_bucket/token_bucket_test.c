@@ -0,0 +1,108 @@
+/*
+ * (C) 2026 by sysmocom s.f.m.c. GmbH <info@sysmocom.de>
+ *
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/timer.h>
+
+#include <osmocom/smlc/token_bucket.h>
+
+static void clock_step(unsigned int ms)
+{
+	osmo_clock_override_add(CLOCK_MONOTONIC, ms / 1000, (ms % 1000) * 1000000);
+}
+
+/* Try to take n tokens, and print how many were taken */
+static void take(struct token_bucket *tb, const struct token_bucket_cfg *cfg, unsigned int n)
+{
+	unsigned int taken = 0;
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		if (token_bucket_take(tb, cfg))
+			taken++;
+	}
+	printf("  take %u: %u taken, %u tokens left\n", n, taken, token_bucket_tokens(tb, cfg));
+}
+
+static void test_no_limit(void)
+{
+	struct token_bucket tb = {};
+	struct token_bucket_cfg cfg = { .rate = 0, .burst = 10 };
+
+	printf("\n%s()\n", __func__);
+	take(&tb, &cfg, 1000);
+}
+
+static void test_burst_and_rate(void)
+{
+	struct token_bucket tb = {};
+	struct token_bucket_cfg cfg = { .rate = 100, .burst = 20 };
+	unsigned int taken = 0;
+	int i;
+
+	printf("\n%s()\n", __func__);
+	/* A full bucket allows a burst, then nothing */
+	take(&tb, &cfg, 30);
+	/* 100 per second refill one token per 10 ms */
+	clock_step(10);
+	take(&tb, &cfg, 5);
+	clock_step(55);
+	take(&tb, &cfg, 10);
+	/* A long quiet period refills no more than the burst */
+	clock_step(60000);
+	take(&tb, &cfg, 30);
+
+	/* A steady storm at 1000 per second gets through at the configured rate */
+	for (i = 0; i < 1000; i++) {
+		clock_step(1);
+		if (token_bucket_take(&tb, &cfg))
+			taken++;
+	}
+	printf("  storm of 1000 per second for 1 s: %u taken\n", taken);
+}
+
+static void test_slow_rate(void)
+{
+	struct token_bucket tb = {};
+	struct token_bucket_cfg cfg = { .rate = 3, .burst = 1 };
+	int i;
+
+	printf("\n%s()\n", __func__);
+	take(&tb, &cfg, 2);
+	/* Frequent attempts don't lose the fractions of a token that accumulate in between */
+	for (i = 0; i < 10; i++) {
+		clock_step(50);
+		take(&tb, &cfg, 1);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	osmo_clock_override_enable(CLOCK_MONOTONIC, true);
+
+	test_no_limit();
+	test_burst_and_rate();
+	test_slow_rate();
+
+	printf("\nDone\n");
+	return 0;
+}